@@ -226,8 +226,7 @@ engine_communicator_make_move_two_acn(PyObject* self, PyObject* args)
     python_engine->gamePGN.addMe(found_move, *python_engine);
 
 
-    python_engine->move_history = stack<ShumiChess::Move>();
-    //python_engine->move_history.push(found_move);
+    python_engine->clear_move_history();
 
     if (found_move.piece_type == ShumiChess::Piece::NONE) {   // Error
         sout << "\x1b[1;31m" << " You are full of it " << "\x1b[0m" << endl;
@@ -606,6 +605,7 @@ PyInit_engine_communicator(void) {
     if (PyModule_AddIntConstant(m, "SLUG",        (int)ShumiChess::SLUG)        < 0) return NULL;
     if (PyModule_AddIntConstant(m, "CRAZY_IVAN",  (int)ShumiChess::CRAZY_IVAN)  < 0) return NULL;
     if (PyModule_AddIntConstant(m, "UNCLE_SHUMI", (int)ShumiChess::UNCLE_SHUMI) < 0) return NULL;
+    if (PyModule_AddIntConstant(m, "NNUE",        (int)ShumiChess::NNUE)        < 0) return NULL;
 
 
     return m;
@@ -0,0 +1,88 @@
+
+#include <cstdio>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "globals.hpp"
+#include "move_tables.hpp"
+#include "status_output.hpp"
+
+using namespace std;
+using namespace ShumiChess;
+using namespace std::chrono;
+
+/////////////////////////////////////////////////////////////////////////////////
+//
+// Per call latency of the slider attack lookups, magic vs PEXT backends.
+// Each call's occupancy depends on the last result, so the calls can not overlap (latency, not throughput).
+//
+
+static ull next_random(ull& state) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+static double ns_per_call(bool b_pext, const vector<ull>& occupancies, int n_rounds, ull& checksum) {
+
+    tables::movegen::set_use_pext(b_pext);
+
+    const size_t n = occupancies.size();
+    ull chain = 0;
+    auto start = high_resolution_clock::now();
+    for (int r = 0; r < n_rounds; r++) {
+        for (size_t i = 0; i < n; i++) {
+            const int square = (int)((i + chain) & 63);
+            chain = get_straight_attacks_mbb(occupancies[i] ^ (chain & 1), square);
+            chain ^= get_diagonal_attacks_mbb(occupancies[i] ^ (chain & 1), square);
+        }
+    }
+    auto stop = high_resolution_clock::now();
+
+    checksum = chain;
+    const double n_calls = 2.0 * n_rounds * n;
+    return duration_cast<nanoseconds>(stop - start).count() / n_calls;
+}
+
+int main() {
+
+    const bool b_can_pext = tables::movegen::cpu_has_fast_pext();
+
+    // Verify the backends agree first
+    ull state = 0x9E3779B97F4A7C15ULL;
+    vector<ull> occupancies(4096);
+    for (ull& occ : occupancies) occ = next_random(state) & next_random(state);
+
+    if (b_can_pext) {
+        for (ull occ : occupancies) {
+            for (int square = 0; square < 64; square++) {
+                tables::movegen::set_use_pext(false);
+                const ull straight_magic = get_straight_attacks_mbb(occ, square);
+                const ull diagonal_magic = get_diagonal_attacks_mbb(occ, square);
+                tables::movegen::set_use_pext(true);
+                if (get_straight_attacks_mbb(occ, square) != straight_magic
+                    || get_diagonal_attacks_mbb(occ, square) != diagonal_magic) {
+                    sout << "PEXT and magic attacks differ on square " << square << endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    const int n_rounds = 2000;
+    ull checksum = 0;
+
+    const double magic_ns = ns_per_call(false, occupancies, n_rounds, checksum);
+    sout << "magic: " << magic_ns << " ns per call  (" << (checksum & 0xFF) << ")" << endl;
+
+    if (b_can_pext) {
+        const double pext_ns = ns_per_call(true, occupancies, n_rounds, checksum);
+        sout << "pext:  " << pext_ns << " ns per call  (" << (checksum & 0xFF) << ")" << endl;
+    } else {
+        sout << "pext:  not available on this CPU" << endl;
+    }
+
+    return 0;
+}
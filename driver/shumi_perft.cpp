@@ -0,0 +1,121 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "globals.hpp"
+#include "engine.hpp"
+#include "perft.hpp"
+#include "utility.hpp"
+#include "status_output.hpp"
+
+using namespace std;
+using namespace ShumiChess;
+using namespace std::chrono;
+
+#ifdef SHUMI_FORCE_ASSERTS  // Operated by the -asserts" and "-no-asserts" args to run_gui.py. By default on.
+#undef NDEBUG
+#endif
+#include <assert.h>
+
+//
+// Perft: counts the legal move tree of a position to a depth.
+//
+//      shumi_perft -d5 -j8 -h64 -divide -f<fen>
+//
+//  -d<n>       depth (default 5)
+//  -j<n>       threads, splitting the root moves (default 1)
+//  -h<mb>      use a hash table of that many megabytes (default none)
+//  -divide     print the count under each root move
+//  -f<fen>     the position (default the starting position)
+//
+
+static string move_to_uci(const Move& move)
+{
+    string move_uci = utility::representation::bitboard_to_acn_conversion(utility::bit::square_to_bitboard(move.fromSQ))
+                    + utility::representation::bitboard_to_acn_conversion(utility::bit::square_to_bitboard(move.toSQ));
+    if (move.promotion != Piece::NONE) {
+        move_uci += utility::representation::piece_to_charactor(move.promotion);
+    }
+    return move_uci;
+}
+
+int main(int argc, char** argv)
+{
+    // defaults
+    int depth = 5;
+    int n_threads = 1;
+    size_t hash_mb = 0;
+    bool b_divide = false;
+    string fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    // parse only attached forms: -d5  -j8  -h64  -f<fen>
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-divide") == 0)
+        {
+            b_divide = true;
+        }
+        else if (std::strncmp(argv[i], "-d", 2) == 0 && argv[i][2] != '\0')
+        {
+            depth = std::atoi(argv[i] + 2);
+        }
+        else if (std::strncmp(argv[i], "-j", 2) == 0 && argv[i][2] != '\0')
+        {
+            n_threads = std::max(1, std::atoi(argv[i] + 2));
+        }
+        else if (std::strncmp(argv[i], "-h", 2) == 0 && argv[i][2] != '\0')
+        {
+            hash_mb = (size_t)std::max(0, std::atoi(argv[i] + 2));
+        }
+        else if (std::strncmp(argv[i], "-f", 2) == 0 && argv[i][2] != '\0')
+        {
+            fen = argv[i] + 2;
+        }
+        else
+        {
+            sout << "Unrecognized arg: " << argv[i] << "\n";
+        }
+    }
+
+    if (depth < 1) {
+        sout << "Depth must be at least 1\n";
+        return 1;
+    }
+
+    Engine engine(fen);
+
+    PerftHashTable hash;
+    if (hash_mb > 0) hash.resize(hash_mb);
+
+    sout << endl;
+    sout << "depth = " << depth << "\n";
+    sout << "threads = " << n_threads << "\n";
+    sout << "hash = " << hash_mb << " MB\n";
+    sout << "fen = " << fen << "\n";
+    sout << endl;
+
+    vector<PerftDivideEntry> divide;
+    auto start = high_resolution_clock::now();
+    const uint64_t nodes = perft_divide(engine, depth, divide, n_threads, (hash_mb > 0) ? &hash : nullptr);
+    auto stop = high_resolution_clock::now();
+
+    if (b_divide) {
+        for (const PerftDivideEntry& e : divide) {
+            sout << move_to_uci(e.move) << ": " << e.nodes << "\n";
+        }
+        sout << endl;
+    }
+
+    const double seconds_passed = duration_cast<microseconds>(stop - start).count() / 1000000.0;
+    sout << "Nodes searched: " << nodes << "\n";
+    sout << "Time: " << seconds_passed << " s\n";
+    if (seconds_passed > 0.0) {
+        sout << "NPS: " << (uint64_t)(nodes / seconds_passed) << "\n";
+    }
+
+    return 0;
+}
@@ -36,6 +36,7 @@
 #include <fstream>
 
 #include "minimax.hpp"
+#include "perft.hpp"
 #include "status_output.hpp"
 
 
@@ -57,7 +58,11 @@ static bool create_position(const string& base,
                             const vector<string>& moves,
                             Engine*& engine,
                             MinimaxAI*& minimax_ai);
+static bool replay_position(const string& base,
+                            const vector<string>& moves,
+                            Engine& engine);
 static bool try_read_uci_line(std::string& line, bool& input_closed);
+static bool parse_setoption_command(const string& line, string& name, string& value);
 
 struct UciSearchState {
     std::atomic<bool> running{false};
@@ -65,6 +70,14 @@ struct UciSearchState {
     std::thread thread;
     Move move;
     ull go_id = 0;
+    bool is_ponder = false;         // Started by "go ponder"
+};
+
+// Thinking on the opponent's time, over one game
+struct PonderStats {
+    int n_ponders = 0;
+    int n_hits = 0;
+    ull free_ms = 0;                // Searched before the ponder hits. Extra time, off our clock.
 };
 
 static void start_searching_for_move(MinimaxAI& minimax_ai,
@@ -80,7 +93,9 @@ static void found_move(Engine& engine,
                        MinimaxAI& minimax_ai,
                        UciSearchState& search_thread,
                        vector<string>& moves_so_far,
-                       int& iMovesInGame);
+                       int& iMovesInGame,
+                       PonderStats& ponder_stats);
+static void report_ponder_stats(PonderStats& ponder_stats);
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -95,12 +110,16 @@ int main()
     // open assert debug file
     FILE* assertion_log = nullptr;
 
-    freopen_s(
-        &assertion_log,
-        "C:\\programming\\shumi-chess\\uci_assert.txt",
-        "a",
-        stderr
-    );
+    #ifdef _WIN32
+        freopen_s(
+            &assertion_log,
+            "C:\\programming\\shumi-chess\\uci_assert.txt",
+            "a",
+            stderr
+        );
+    #else
+        assertion_log = freopen("/tmp/shumi_uci_assert.txt", "a", stderr);
+    #endif
 
     if (assertion_log != nullptr) {
         // Make assertion diagnostics appear immediately.
@@ -115,8 +134,13 @@ int main()
 
 
     // open debug file
+    #ifdef _WIN32
+        const char* uci_debug_path = "C:\\programming\\shumi-chess\\uci_debug.txt";
+    #else
+        const char* uci_debug_path = "/tmp/shumi_uci_debug.txt";
+    #endif
     sout_file.open(
-        "C:\\programming\\shumi-chess\\uci_debug.txt",
+        uci_debug_path,
         std::ios::out | std::ios::trunc
     );
 
@@ -150,10 +174,14 @@ int main()
     int flags = 0;
     flags = flags | _FEATURE_KILLER | _FEATURE_UNQUIET_SORT;
     flags = flags | _FEATURE_TT2;
+    flags = flags | _FEATURE_LAZY_EVAL;
 
     int iRandomMoves = 0;
     if (iMovesInGame < 3) iRandomMoves = 1;     // Just one random move.
 
+    int n_threads = 1;              // Lazy SMP search threads ("setoption name Threads value N")
+    size_t hash_mb = TranspositionTable::DEFAULT_SIZE_MB;  // TT2 size ("setoption name Hash value N")
+
 
 
     constexpr int MAX_FENS = 10;
@@ -174,6 +202,7 @@ int main()
     //std::deque<std::string> pending_lines;
     bool input_closed = false;
     UciSearchState search_thread;
+    PonderStats ponder_stats;
 
     ull current_go_id = 0;
 
@@ -189,9 +218,10 @@ int main()
             break;  // exit the forever loop
         }
 
+        // A ponder search that ends by itself (a mate, say) holds its move until "ponderhit" or "stop".
         const bool search_thread_is_done = search_thread.done.load(std::memory_order_acquire);
-        if (search_thread_is_done) {
-            found_move(*engine, *minimax_ai, search_thread, moves_so_far, iMovesInGame);
+        if (search_thread_is_done && !minimax_ai->pondering) {
+            found_move(*engine, *minimax_ai, search_thread, moves_so_far, iMovesInGame, ponder_stats);
         }
 
         if (!try_read_uci_line(line, input_closed)) {
@@ -204,15 +234,10 @@ int main()
         // Echo the recieved UCI line to debug log
         sout << line << endl;
 
-        //
-        // other commands?
-        // stop
-        // quit
-        // ponderhit
-
        if (search_thread.running.load(std::memory_order_acquire)
             && line != "isready"
             && line != "stop"
+            && line != "ponderhit"
             && line != "quit") {
 
             sout << "UCI ERROR: unexpected command received while searching: "
@@ -228,6 +253,12 @@ int main()
         //************************************************************************************** */
             std::cout << "id name ShumiChess\n";
             std::cout << "id author Paul Duerig\n";
+            std::cout << "option name Threads type spin default 1 min 1 max " << MinimaxAI::MAX_SEARCH_THREADS << "\n";
+            std::cout << "option name Hash type spin default " << TranspositionTable::DEFAULT_SIZE_MB
+                      << " min 1 max " << TranspositionTable::MAX_SIZE_MB << "\n";
+            std::cout << "option name EvalFile type string default <empty>\n";
+            std::cout << "option name SyzygyPath type string default <empty>\n";
+            std::cout << "option name Ponder type check default false\n";
             std::cout << "uciok\n";
             std::cout.flush();
 
@@ -236,6 +267,45 @@ int main()
             std::cout << "readyok\n";
             std::cout.flush();
 
+        } else if (line.rfind("setoption ", 0) == 0) {
+        //************************************************************************************** */
+            // setoption name <id> [value <x>]
+            string name;
+            string value;
+            if (!parse_setoption_command(line, name, value)) {
+                sout << "Invalid setoption command: " << line << endl;
+                continue;
+            }
+
+            if (name == "Threads") {
+                const int requested = atoi(value.c_str());
+                n_threads = std::clamp(requested, 1, MinimaxAI::MAX_SEARCH_THREADS);
+                if (minimax_ai != nullptr) minimax_ai->n_threads = n_threads;
+                sout << "Threads = " << n_threads << endl;
+            } else if (name == "Hash") {
+                const long long requested = atoll(value.c_str());
+                hash_mb = (size_t)std::clamp<long long>(requested, 1, (long long)TranspositionTable::MAX_SIZE_MB);
+                if (minimax_ai != nullptr) minimax_ai->set_hash_size_mb(hash_mb);
+                sout << "Hash = " << hash_mb << " MB" << endl;
+            } else if (name == "EvalFile") {
+                // A Stockfish 12 (halfkp_256x2-32-32) .nnue network. Empty, or a bad file, goes back to UNCLE_SHUMI.
+                const bool loaded = (value != "<empty>") && nnue::load(value);
+                player_id = loaded ? NNUE : UNCLE_SHUMI;
+                sout << "EvalFile = " << value << (loaded ? " (loaded)" : " (not loaded)") << endl;
+            } else if (name == "SyzygyPath") {
+                // Directories of Syzygy .rtbw/.rtbz files. Empty unloads the tables.
+                bool loaded = false;
+                if (value == "<empty>") syzygy::unload();
+                else loaded = syzygy::init(value);
+                if (loaded && (engine != nullptr)) engine->syzygy_path = value;
+                sout << "SyzygyPath = " << value << (loaded ? " (" + std::to_string(syzygy::largest()) + " men)" : " (not loaded)") << endl;
+            } else if (name == "Ponder") {
+                // Nothing to set. The GUI decides when to send "go ponder".
+                sout << "Ponder = " << value << endl;
+            } else {
+                sout << "Unknown option: " << name << endl;
+            }
+
         } else if (line == "ucinewgame") {
         //************************************************************************************** */
             // clear TT, repetition table, history, etc.
@@ -247,6 +317,8 @@ int main()
             previous_moves_to_go[0] = 0;
             previous_moves_to_go[1] = 0;
 
+            report_ponder_stats(ponder_stats);
+
         } else if (line.rfind("position ", 0) == 0) {
         //************************************************************************************** */
             // set board from "startpos" or "fen"
@@ -283,6 +355,15 @@ int main()
                     }
                 }
 
+                if (!position_updated) {
+                    iMovesInGame = 0;
+                    position_updated = create_position(new_base, new_moves, engine, minimax_ai);
+                }
+            } else if (new_base == current_base) {
+                // Same game, other moves (the ponder move was not played). Replayed in place, so the 
+                // search keeps its warm TT2.
+                position_updated = replay_position(new_base, new_moves, *engine);
+
                 if (!position_updated) {
                     iMovesInGame = 0;
                     position_updated = create_position(new_base, new_moves, engine, minimax_ai);
@@ -302,6 +383,31 @@ int main()
             have_position = true;
 
 
+        } else if (line.rfind("perft ", 0) == 0) {
+        //************************************************************************************** */
+            // perft <depth>   (not UCI). Divide output for the current position, on the Threads threads.
+            const int depth = atoi(line.c_str() + 6);
+            if (depth < 1) {
+                sout << "Invalid perft command: " << line << endl;
+                continue;
+            }
+
+            if (!have_position || engine == nullptr || minimax_ai == nullptr) {
+                vector<string> no_moves;
+                if (!create_position("startpos", no_moves, engine, minimax_ai)) continue;
+                current_base = "startpos";
+                moves_so_far.clear();
+                have_position = true;
+            }
+
+            vector<PerftDivideEntry> divide;
+            const uint64_t nodes = perft_divide(*engine, depth, divide, n_threads);
+            for (const PerftDivideEntry& e : divide) {
+                std::cout << move_to_uci(e.move) << ": " << e.nodes << "\n";
+            }
+            std::cout << "\nNodes searched: " << nodes << "\n\n";
+            std::cout.flush();
+
         } else if (line == "go" || line.rfind("go ", 0) == 0) {
 
             ull this_go_id = current_go_id;
@@ -329,6 +435,7 @@ int main()
             long long black_time = -1;
             long long move_time = -1;
             int moves_to_go = 0;
+            bool is_ponder = false;
 
             // parse the "go" line
             istringstream go_command(line);
@@ -339,6 +446,7 @@ int main()
                 else if (go_token == "btime") go_command >> black_time;
                 else if (go_token == "movetime") go_command >> move_time;
                 else if (go_token == "movestogo") go_command >> moves_to_go;
+                else if (go_token == "ponder") is_ponder = true;
             }
 
 
@@ -438,19 +546,37 @@ int main()
                 continue;       // skip this go command (in release build)
             }
 
+            minimax_ai->n_threads = n_threads;
+            if (minimax_ai->TTable2.size_mb() != hash_mb) minimax_ai->set_hash_size_mb(hash_mb);
+
             // set the hard abort time. This is the time before the end of the game,
             // that the hard_abort logic kicks in. Zero means no hard abort.
             time_control.hard_abort_threshold_ms = 10'000;
    
+            // "go ponder": the position has the opponent's expected move made, and the clocks are as they 
+            // will be if it is played. The budget is for after the ponder hit.
+            search_thread.is_ponder = is_ponder;
+            if (is_ponder) {
+                minimax_ai->ponder_start();
+                ponder_stats.n_ponders++;
+            }
+
             //
             // Start thread to "Get "best move" from Shumi"
             start_searching_for_move(*minimax_ai, search_thread, this_go_id, search_time_to_use, depth_to_use,
                                       player_id, iRandomMoves, flags, time_control);
 
 
+        } else if (line == "ponderhit") {
+            // The opponent played the expected move. The search goes on, now on our clock.
+            if (search_thread.running.load(std::memory_order_acquire) && minimax_ai != nullptr) {
+                minimax_ai->ponder_hit();
+            }
+
         } else if (line == "stop") {
-            // Note: test me
+            // Ends a ponder too (a ponder miss). The bestmove is still sent, and the TT2 is kept.
             if (search_thread.running.load(std::memory_order_acquire) && minimax_ai != nullptr) {
+                minimax_ai->pondering = false;
                 minimax_ai->stop_calculation = true;
             }
             // std::cout << "stop ok" << endl;
@@ -459,6 +585,7 @@ int main()
 
         } else if (line == "quit") {
             sout << "quit received" << endl;
+            report_ponder_stats(ponder_stats);
             sout.flush();
             if (search_thread.running.load(std::memory_order_acquire) && minimax_ai != nullptr) {
                 minimax_ai->stop_calculation = true;
@@ -593,7 +720,8 @@ static void found_move(Engine& engine,
                        MinimaxAI& minimax_ai,
                        UciSearchState& search_thread,
                        vector<string>& moves_so_far,
-                       int& iMovesInGame)
+                       int& iMovesInGame,
+                       PonderStats& ponder_stats)
 {
     if (search_thread.thread.joinable()) {
         // Blocking call, but only after done is true, so this should return immediately.
@@ -605,6 +733,14 @@ static void found_move(Engine& engine,
 
     Move move = search_thread.move;
 
+    if (search_thread.is_ponder && minimax_ai.ponder_was_hit()) {
+        const ull free_ms = minimax_ai.ponder_free_ms();
+        ponder_stats.n_hits++;
+        ponder_stats.free_ms += free_ms;
+        sout << "Ponder hit. Searched " << free_ms << " ms on the opponent's time" << endl;
+    }
+    search_thread.is_ponder = false;
+
     if (move.piece_type == Piece::NONE) {
         sout << "No legal move returned at ply " << endl;
         std::cout << "bestmove 0000\n";
@@ -628,7 +764,7 @@ static void found_move(Engine& engine,
     moves_so_far.push_back(move_str);
 
 
-    int nodesSeen = minimax_ai.nodes_visited;
+    int nodesSeen = (int)(minimax_ai.nodes_visited + minimax_ai.smp_helper_nodes);     // all search threads
 
     //
     // Show move info
@@ -667,12 +803,18 @@ static void found_move(Engine& engine,
             << " score cp " << centiPawnsRel
             << " nodes " << nodesSeen
             << " nps " << nps
+            << " hashfull " << minimax_ai.TTable2.hashfull()
+            << " tbhits " << (minimax_ai.n_tb_hits + minimax_ai.smp_helper_tb_hits)     // all search threads
             << "\n";
 
 
     // Show move
     iMovesInGame++;
 
+    // The reply we expect, for the GUI to ponder on
+    const Move reply = minimax_ai.expected_reply();
+    if (reply.piece_type != Piece::NONE) move_str += " ponder " + move_to_uci(reply);
+
     sout << move_str_alebriac << " SENDING bestmove " << move_str << " go_id=" << search_thread.go_id << endl;
 
     std::cout << "bestmove " << move_str << "\n";
@@ -684,6 +826,20 @@ static void found_move(Engine& engine,
     std::cout.flush();
 }
 
+//
+// At the end of a game (the next "ucinewgame", or "quit"). Then starts over.
+static void report_ponder_stats(PonderStats& ponder_stats)
+{
+    if (ponder_stats.n_ponders > 0) {
+        std::cout << "info string ponder hits " << ponder_stats.n_hits << "/" << ponder_stats.n_ponders
+                  << " extra search time " << ponder_stats.free_ms << " ms\n";
+        std::cout.flush();
+        sout << "Game pondering: hits " << ponder_stats.n_hits << "/" << ponder_stats.n_ponders
+             << " extra search time " << ponder_stats.free_ms << " ms" << endl;
+    }
+    ponder_stats = PonderStats{};
+}
+
 static bool extract_pending_line(string& pending_input, string& line)
 {
     size_t newline = pending_input.find('\n');
@@ -791,7 +947,7 @@ static void make_engine_move(Engine& engine, Move move)
 
     engine.gamePGN.addMe(move, engine);
 
-    engine.move_history = stack<Move>();
+    engine.clear_move_history();
 
     if (move.piece_type == Piece::NONE) {
         sout << "\x1b[1;31mNo move to make\x1b[0m" << endl;
@@ -904,6 +1060,55 @@ static bool parse_position_command(const string& line, string& new_base, vector<
     return true;
 }
 
+// "setoption name <id> [value <x>]". Both the name and the value may contain spaces.
+static bool parse_setoption_command(const string& line, string& name, string& value)
+{
+    istringstream input(line);
+    string token;
+
+    input >> token;     // "setoption"
+    if (!(input >> token) || token != "name") {
+        return false;
+    }
+
+    name.clear();
+    value.clear();
+    bool in_value = false;
+
+    while (input >> token) {
+        if (!in_value && token == "value") {
+            in_value = true;
+            continue;
+        }
+        string& target = in_value ? value : name;
+        if (!target.empty()) target += " ";
+        target += token;
+    }
+
+    return !name.empty();
+}
+
+//
+// Sets up base + moves on the engine we have, keeping its MinimaxAI (and the TT2 and other hashes). It is
+// still the same game to the search, so nothing is cleared as for a new game.
+static bool replay_position(const string& base,
+                            const vector<string>& moves,
+                            Engine& engine)
+{
+    static const string STARTPOS_FEN =
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    const int computer_ply_so_far = engine.computer_ply_so_far;
+    engine.reset_engine(base == "startpos" ? STARTPOS_FEN : base);
+
+    for (const string& move_uci : moves) {
+        if (!make_uci_move(engine, move_uci)) return false;
+    }
+
+    engine.computer_ply_so_far = computer_ply_so_far;
+    return true;
+}
+
 static bool create_position(const string& base,
                             const vector<string>& moves,
                             Engine*& engine,
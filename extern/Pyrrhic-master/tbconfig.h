@@ -60,61 +60,47 @@
 #include <stdint.h>
 
 /*
- * Minimal, engine-agnostic configuration for Pyrrhic.
- * We define simple popcount/lsb/poplsb helpers here so Pyrrhic
- * does not depend on any external engine headers.
- *
- * NOTE: These are intentionally simple and not super-optimized.
- * For KQK / KRK endgames, this is perfectly fine.
+ * ShumiChess configuration. Pyrrhic squares are A1 = 0, H8 = 63, with White = 1.
+ * The attack functions are in ShumiChess's src/endgameTables.cpp, which turns
+ * the squares (and bitboards) around to its own H1 = 0 layout.
  */
 
-static inline int pyrrhic_popcount_u64(uint64_t x)
+#ifdef _MSC_VER
+#include <intrin.h>
+static inline int pyrrhic_lsb_u64(uint64_t x)
 {
-    int c = 0;
-    while (x)
-    {
-        x &= (x - 1);
-        ++c;
-    }
-    return c;
+    unsigned long idx;
+    _BitScanForward64(&idx, x);
+    return (int)idx;
 }
-
+#define PYRRHIC_POPCOUNT(x)              ((int)__popcnt64((uint64_t)(x)))
+#else
 static inline int pyrrhic_lsb_u64(uint64_t x)
 {
-    if (!x) return -1;  // convention: -1 if empty
-    int idx = 0;
-    while ((x & 1ull) == 0ull)
-    {
-        x >>= 1;
-        ++idx;
-    }
-    return idx;
+    return __builtin_ctzll(x);
 }
+#define PYRRHIC_POPCOUNT(x)              __builtin_popcountll((uint64_t)(x))
+#endif
 
-static inline uint64_t pyrrhic_poplsb_u64(uint64_t *x)
+static inline int pyrrhic_poplsb_u64(uint64_t *x)
 {
-    uint64_t bb = *x;
-    if (!bb) return 0ull;
-    uint64_t lsb = bb & (~bb + 1ull); // bb & -bb
-    *x = bb ^ lsb;
-    return lsb;
+    const int sq = pyrrhic_lsb_u64(*x);
+    *x &= *x - 1;
+    return sq;
 }
 
-#define PYRRHIC_POPCOUNT(x)              pyrrhic_popcount_u64((uint64_t)(x))
 #define PYRRHIC_LSB(x)                   pyrrhic_lsb_u64((uint64_t)(x))
-#define PYRRHIC_POPLSB(x)                pyrrhic_poplsb_u64((uint64_t *)&(x))
-
-/*
- * Attack macros:
- * For now, we do NOT use Pyrrhic’s internal move-generation,
- * so these can be left as stubs. If Pyrrhic later complains or
- * we want to enable its internal checks, we can wire these up
- * properly to ShumiChess’s bitboard attack routines.
- */
-
-#define PYRRHIC_PAWN_ATTACKS(sq, c)      (0ull)
-#define PYRRHIC_KNIGHT_ATTACKS(sq)       (0ull)
-#define PYRRHIC_BISHOP_ATTACKS(sq, occ)  (0ull)
-#define PYRRHIC_ROOK_ATTACKS(sq, occ)    (0ull)
-#define PYRRHIC_QUEEN_ATTACKS(sq, occ)   (0ull)
-#define PYRRHIC_KING_ATTACKS(sq)         (0ull)
+#define PYRRHIC_POPLSB(x)                pyrrhic_poplsb_u64(x)
+
+uint64_t shumi_tb_pawn_attacks(unsigned sq, unsigned color);
+uint64_t shumi_tb_knight_attacks(unsigned sq);
+uint64_t shumi_tb_bishop_attacks(unsigned sq, uint64_t occ);
+uint64_t shumi_tb_rook_attacks(unsigned sq, uint64_t occ);
+uint64_t shumi_tb_king_attacks(unsigned sq);
+
+#define PYRRHIC_PAWN_ATTACKS(sq, c)      shumi_tb_pawn_attacks((sq), (c))
+#define PYRRHIC_KNIGHT_ATTACKS(sq)       shumi_tb_knight_attacks((sq))
+#define PYRRHIC_BISHOP_ATTACKS(sq, occ)  shumi_tb_bishop_attacks((sq), (occ))
+#define PYRRHIC_ROOK_ATTACKS(sq, occ)    shumi_tb_rook_attacks((sq), (occ))
+#define PYRRHIC_QUEEN_ATTACKS(sq, occ)   (shumi_tb_bishop_attacks((sq), (occ)) | shumi_tb_rook_attacks((sq), (occ)))
+#define PYRRHIC_KING_ATTACKS(sq)         shumi_tb_king_attacks((sq))
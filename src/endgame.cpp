@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "endgame.hpp"
+#include "gameboard.hpp"
+#include "utility.hpp"
+
+namespace ShumiChess::endgame {
+
+namespace {
+
+std::vector<Entry> registry;
+std::once_flag init_flag;
+
+inline int file_of(int sq) { return sq & 7; }
+inline int rank_of(int sq) { return sq >> 3; }
+inline int distance(int sq1, int sq2) {
+    return std::max(std::abs(file_of(sq1) - file_of(sq2)), std::abs(rank_of(sq1) - rank_of(sq2)));
+}
+
+inline Square king_square(const GameBoard& b, Color c) {
+    return (Square)utility::bit::bitboard_to_lowest_square_fast((c == Color::WHITE) ? b.white_king : b.black_king);
+}
+inline Square piece_square(const GameBoard& b, Color c, Piece p) {
+    return (Square)utility::bit::bitboard_to_lowest_square_fast(b.get_pieces(c, p));
+}
+
+// Manhattan distance from the d4,e4,d5,e5 box (0..6), as in the king piece-square table
+inline int push_to_edge(int sq) {
+    const int f = file_of(sq);
+    const int r = rank_of(sq);
+    const int dx = (f < 3) ? (3 - f) : (f > 4 ? f - 4 : 0);
+    const int dy = (r < 3) ? (3 - r) : (r > 4 ? r - 4 : 0);
+    return 25 * (dx + dy);
+}
+
+// Kings are never closer than 2
+inline int push_close(int sq1, int sq2) {
+    return 140 - 20 * distance(sq1, sq2);
+}
+
+Piece piece_of_letter(char ch) {
+    switch (ch) {
+        case 'P': return Piece::PAWN;
+        case 'N': return Piece::KNIGHT;
+        case 'B': return Piece::BISHOP;
+        case 'R': return Piece::ROOK;
+        case 'Q': return Piece::QUEEN;
+        default:  return Piece::NONE;
+    }
+}
+
+void add(const char* signature, EndgameEvalFn fn, bool is_exact) {
+    for (const Color strong : {Color::WHITE, Color::BLACK}) {
+        registry.push_back(Entry{material_key_of(signature, strong), fn, strong, is_exact});
+    }
+}
+
+void build() {
+    kpk::init();
+
+    add("KPK",  kpk::score_cp, true);
+    add("KQK",  kxk_cp,  false);
+    add("KRK",  kxk_cp,  false);
+    add("KBNK", kbnk_cp, false);
+    add("KQKR", kqkr_cp, false);
+    add("KRKP", krkp_cp, false);
+    add("KRKB", krkb_cp, false);
+    add("KRKN", krkn_cp, false);
+}
+
+}
+
+void init() {
+    std::call_once(init_flag, build);
+}
+
+const Entry* find(std::uint64_t material_key) {
+    for (const Entry& e : registry) {
+        if (e.material_key == material_key) return &e;
+    }
+    return nullptr;
+}
+
+std::uint64_t material_key_of(const char* signature, Color strong_side) {
+
+    int counts[2][NUM_PIECES] = {};
+    counts[Color::WHITE][Piece::KING] = counts[Color::BLACK][Piece::KING] = 1;
+    Color side = strong_side;
+    const char* second_king = std::strchr(signature + 1, 'K');
+
+    for (const char* p = signature + 1; *p; p++) {
+        if (p == second_king) {
+            side = utility::representation::opposite_color(strong_side);
+            continue;
+        }
+        const Piece piece = piece_of_letter(*p);
+        if (piece != Piece::NONE) counts[side][piece]++;
+    }
+
+    std::uint64_t key = 0;
+    for (int c = 0; c < 2; c++) {
+        for (int p = 0; p < NUM_PIECES; p++) {
+            for (int n = 0; n < counts[c][p]; n++) key ^= zobrist_material[p + c * 6][n];
+        }
+    }
+    return key;
+}
+
+//
+// Mating material against a bare king. Drive the king to the edge and follow it with ours.
+int kxk_cp(const GameBoard& b, Color strong_side) {
+    const Color weak_side = utility::representation::opposite_color(strong_side);
+    const Square strong_king = king_square(b, strong_side);
+    const Square weak_king = king_square(b, weak_side);
+
+    return KNOWN_WIN_CP + b.material_cp[strong_side] + push_to_edge(weak_king) + push_close(strong_king, weak_king);
+}
+
+//
+// Bishop and knight. The mate is only in a corner of the bishop's color.
+int kbnk_cp(const GameBoard& b, Color strong_side) {
+    const Color weak_side = utility::representation::opposite_color(strong_side);
+    const Square strong_king = king_square(b, strong_side);
+    const Square weak_king = king_square(b, weak_side);
+    const Square bishop = piece_square(b, strong_side, Piece::BISHOP);
+
+    // h1 (0) and a8 (63) are one color, a1 (7) and h8 (56) the other. Distance from the long diagonal
+    // of the other color is 7 in the two right corners, 0 in the wrong ones. It outweighs push_close().
+    const bool on_h1_color = (((file_of(bishop) + rank_of(bishop)) & 1) == 0);
+    const int f = file_of(weak_king);
+    const int r = rank_of(weak_king);
+    const int to_corner = on_h1_color ? std::abs(7 - f - r) : std::abs(f - r);
+
+    return KNOWN_WIN_CP + b.material_cp[strong_side] + 60 * to_corner + push_to_edge(weak_king)
+         + push_close(strong_king, weak_king);
+}
+
+//
+// Queen against rook. Wins, but the rook holds out a long time. Same driving as KXK.
+int kqkr_cp(const GameBoard& b, Color strong_side) {
+    const Color weak_side = utility::representation::opposite_color(strong_side);
+    const Square strong_king = king_square(b, strong_side);
+    const Square weak_king = king_square(b, weak_side);
+
+    return b.centipawn_score_of(Piece::QUEEN) - b.centipawn_score_of(Piece::ROOK)
+         + push_to_edge(weak_king) + push_close(strong_king, weak_king);
+}
+
+//
+// Rook against pawn. Wins if the rook side's king gets in front of the pawn, or the pawn is left alone.
+// Otherwise it is a race to the queening square. Turned so the strong side plays up the board.
+int krkp_cp(const GameBoard& b, Color strong_side) {
+    const Color weak_side = utility::representation::opposite_color(strong_side);
+    const int flip = (strong_side == Color::WHITE) ? 0 : 56;
+
+    const int strong_king = king_square(b, strong_side) ^ flip;
+    const int weak_king = king_square(b, weak_side) ^ flip;
+    const int rook = piece_square(b, strong_side, Piece::ROOK) ^ flip;
+    const int pawn = piece_square(b, weak_side, Piece::PAWN) ^ flip;
+    const int queening_sq = file_of(pawn);          // The pawn goes down the board
+
+    const int weak_to_move = (b.turn == weak_side) ? 1 : 0;
+    const int rook_cp = b.centipawn_score_of(Piece::ROOK);
+
+    if ((file_of(strong_king) == file_of(pawn)) && (rank_of(strong_king) < rank_of(pawn))) {
+        return rook_cp - distance(strong_king, pawn);
+    }
+    if ((distance(weak_king, pawn) >= 3 + weak_to_move) && (distance(weak_king, rook) >= 3)) {
+        return rook_cp - distance(strong_king, pawn);
+    }
+    if ((rank_of(weak_king) <= 2) && (distance(weak_king, pawn) == 1) && (rank_of(strong_king) >= 3)
+            && (distance(strong_king, pawn) > 2 + (1 - weak_to_move))) {
+        return 80 - 8 * distance(strong_king, pawn);
+    }
+    return 200 - 8 * (distance(strong_king, queening_sq) - distance(weak_king, queening_sq) - distance(pawn, queening_sq));
+}
+
+//
+// Rook against bishop. A draw, unless the weak king gets stuck on the edge.
+int krkb_cp(const GameBoard& b, Color strong_side) {
+    const Color weak_side = utility::representation::opposite_color(strong_side);
+    return push_to_edge(king_square(b, weak_side)) / 2;
+}
+
+//
+// Rook against knight. A draw, but a knight cut off from its king can get lost.
+int krkn_cp(const GameBoard& b, Color strong_side) {
+    const Color weak_side = utility::representation::opposite_color(strong_side);
+    const Square weak_king = king_square(b, weak_side);
+    const Square knight = piece_square(b, weak_side, Piece::KNIGHT);
+    return push_to_edge(weak_king) / 2 + 10 * distance(weak_king, knight);
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+
+#include "globals.hpp"
+#include "endgameTables.hpp"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Specialized endgame evaluators, selected by material signature (GameBoard::material_key).
+//
+// The general eval plays basic mates badly. It has no idea which corner the KBNK king belongs in,
+// and a queen up scores about the same wherever the kings are. Each evaluator here knows its ending:
+//
+//      KPK                 exact, from the bitbase (endgameTables.hpp)
+//      KQK, KRK, KBNK      KNOWN_WIN_CP, plus driving the weak king to the edge (the right corner
+//                          for KBNK) and bringing the strong king close
+//      KQKR                a queen against a rook wins, but slowly. Same driving terms.
+//      KRKP                who gets to the pawn first
+//      KRKB, KRKN          mostly draws. Only a little for the weak king on the edge.
+//
+// A known win is far above any material count, so the search heads for these endings and then
+// converges. It stays well under TB_WIN_CP and the mate scores.
+//
+// find() is looked up once per material signature (MinimaxAI::build_material_info()), not per eval.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace ShumiChess::endgame {
+
+constexpr int KNOWN_WIN_CP = 10000;
+
+struct Entry {
+    std::uint64_t material_key;
+    EndgameEvalFn fn;
+    Color strong_side;
+    bool is_exact;                      // The value is known, not guessed. The search can stop there.
+};
+
+void init();                            // Builds the registry (and the KPK bitbase) once. Later calls do nothing.
+
+const Entry* find(std::uint64_t material_key);      // nullptr if no evaluator knows this material
+
+// The material key of a signature like "KRKP": the strong side's pieces, then the weak side's.
+std::uint64_t material_key_of(const char* signature, Color strong_side);
+
+// The evaluators. Centipawns for strong_side.
+int kxk_cp(const GameBoard& board, Color strong_side);     // KQK, KRK
+int kbnk_cp(const GameBoard& board, Color strong_side);
+int kqkr_cp(const GameBoard& board, Color strong_side);
+int krkp_cp(const GameBoard& board, Color strong_side);
+int krkb_cp(const GameBoard& board, Color strong_side);
+int krkn_cp(const GameBoard& board, Color strong_side);
+
+}
@@ -1 +1,282 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
 
+#include "endgameTables.hpp"
+#include "gameboard.hpp"
+#include "move_tables.hpp"
+#include "tbprobe.h"
+
+//
+// Pyrrhic's squares are A1 = 0 (H8 = 63). Ours are H1 = 0, so a square is sq^7, and a bitboard has the
+// files of every rank turned around.
+//
+static inline ull mirror_files(ull b) {
+    constexpr ull k1 = 0x5555555555555555ULL;
+    constexpr ull k2 = 0x3333333333333333ULL;
+    constexpr ull k4 = 0x0f0f0f0f0f0f0f0fULL;
+    b = ((b >> 1) & k1) | ((b & k1) << 1);
+    b = ((b >> 2) & k2) | ((b & k2) << 2);
+    b = ((b >> 4) & k4) | ((b & k4) << 4);
+    return b;
+}
+
+// Attacks for Pyrrhic's own move generation (see extern/Pyrrhic-master/tbconfig.h). Pyrrhic's White is 1.
+uint64_t shumi_tb_pawn_attacks(unsigned sq, unsigned color) {
+    const auto& table = (color == PYRRHIC_WHITE) ? tables::movegen::white_pawn_attack_table
+                                                 : tables::movegen::black_pawn_attack_table;
+    return mirror_files(table[sq ^ 7]);
+}
+uint64_t shumi_tb_knight_attacks(unsigned sq) {
+    return mirror_files(tables::movegen::knight_attack_table[sq ^ 7]);
+}
+uint64_t shumi_tb_king_attacks(unsigned sq) {
+    return mirror_files(tables::movegen::king_attack_table[sq ^ 7]);
+}
+uint64_t shumi_tb_bishop_attacks(unsigned sq, uint64_t occ) {
+    return mirror_files(ShumiChess::get_diagonal_attacks_mbb(mirror_files(occ), (int)(sq ^ 7)));
+}
+uint64_t shumi_tb_rook_attacks(unsigned sq, uint64_t occ) {
+    return mirror_files(ShumiChess::get_straight_attacks_mbb(mirror_files(occ), (int)(sq ^ 7)));
+}
+
+namespace ShumiChess::syzygy {
+
+namespace {
+
+std::mutex init_mutex;
+
+// The board, as Pyrrhic wants it
+struct TbPosition {
+    ull white, black, kings, queens, rooks, bishops, knights, pawns;
+    unsigned ep;
+    bool turn;
+
+    explicit TbPosition(const GameBoard& b)
+        : white(mirror_files(b.get_pieces(Color::WHITE)))
+        , black(mirror_files(b.get_pieces(Color::BLACK)))
+        , kings(mirror_files(b.white_king | b.black_king))
+        , queens(mirror_files(b.white_queens | b.black_queens))
+        , rooks(mirror_files(b.white_rooks | b.black_rooks))
+        , bishops(mirror_files(b.white_bishops | b.black_bishops))
+        , knights(mirror_files(b.white_knights | b.black_knights))
+        , pawns(mirror_files(b.white_pawns | b.black_pawns))
+        , ep(b.en_passant_landing_bb ? (unsigned)(utility::bit::bitboard_to_lowest_square_fast(b.en_passant_landing_bb) ^ 7) : 0)
+        , turn(b.turn == Color::WHITE) {}
+};
+
+Piece promotion_of(PyrrhicMove m) {
+    if (PYRRHIC_MOVE_IS_QPROMO(m)) return Piece::QUEEN;
+    if (PYRRHIC_MOVE_IS_RPROMO(m)) return Piece::ROOK;
+    if (PYRRHIC_MOVE_IS_BPROMO(m)) return Piece::BISHOP;
+    if (PYRRHIC_MOVE_IS_NPROMO(m)) return Piece::KNIGHT;
+    return Piece::NONE;
+}
+
+}
+
+bool init(const std::string& path) {
+    std::lock_guard<std::mutex> lock(init_mutex);
+    return tb_init(path.c_str()) && (TB_LARGEST > 0);
+}
+
+void unload() {
+    std::lock_guard<std::mutex> lock(init_mutex);
+    tb_free();
+}
+
+int largest() {
+    return TB_LARGEST;
+}
+
+bool can_probe(const GameBoard& board) {
+    return (TB_LARGEST > 0)
+        && (board.castle_rights == FLAGS_CASTLE_NONE)
+        && (board.bits_in(board.get_pieces()) <= TB_LARGEST);
+}
+
+Wdl probe_wdl(const GameBoard& board) {
+    const TbPosition p(board);
+    const unsigned result = tb_probe_wdl(p.white, p.black, p.kings, p.queens, p.rooks, p.bishops, p.knights, p.pawns,
+                                         p.ep, p.turn);
+    if (result == TB_RESULT_FAILED) return FAILED;
+    return (Wdl)result;
+}
+
+int probe_root(const GameBoard& board, bool has_repeated, RootMove* out) {
+    const TbPosition p(board);
+    TbRootMoves results;
+    results.size = 0;
+
+    int ok = tb_probe_root_dtz(p.white, p.black, p.kings, p.queens, p.rooks, p.bishops, p.knights, p.pawns,
+                               board.halfmove, p.ep, p.turn, has_repeated, &results);
+    if (!ok) {      // No DTZ table. The WDL ones still tell wins from draws and losses.
+        results.size = 0;
+        ok = tb_probe_root_wdl(p.white, p.black, p.kings, p.queens, p.rooks, p.bishops, p.knights, p.pawns,
+                               board.halfmove, p.ep, p.turn, true, &results);
+    }
+    if (!ok) return 0;
+
+    const int n = std::min((int)results.size, MAX_MOVES);
+    for (int i = 0; i < n; i++) {
+        const PyrrhicMove m = results.moves[i].move;
+        out[i].fromSQ = (Square)(PYRRHIC_MOVE_FROM(m) ^ 7);
+        out[i].toSQ = (Square)(PYRRHIC_MOVE_TO(m) ^ 7);
+        out[i].promotion = promotion_of(m);
+        out[i].rank = results.moves[i].tbRank;
+    }
+    return n;
+}
+
+}
+
+namespace ShumiChess::kpk {
+
+namespace {
+
+//
+// The strong side is White, pushing its pawn up the board. The pawn is kept on files h-e (file index 0-3,
+// the other files are mirrored) and ranks 2-7, so 24 pawn squares. With the two kings and the side to
+// move, 2*24*64*64 = 196,608 positions, 24 KB of bits.
+//
+constexpr int N_POSITIONS = 2 * 24 * 64 * 64;
+
+uint32_t bitbase[N_POSITIONS / 32];
+std::once_flag init_flag;
+
+inline int file_of(int sq) { return sq & 7; }
+inline int rank_of(int sq) { return sq >> 3; }
+inline int distance(int sq1, int sq2) {
+    return std::max(std::abs(file_of(sq1) - file_of(sq2)), std::abs(rank_of(sq1) - rank_of(sq2)));
+}
+
+//  bits 0-5: white king, 6-11: black king, 12: side to move (1 = black), 13-14: pawn file, 15-17: 6 - pawn rank
+inline int index(int stm, int bksq, int wksq, int psq) {
+    return wksq | (bksq << 6) | (stm << 12) | (file_of(psq) << 13) | ((6 - rank_of(psq)) << 15);
+}
+
+// Combined with | over the moves, so the order matters
+enum Result : uint8_t { INVALID = 0, UNKNOWN = 1, DRAW = 2, WIN = 4 };
+
+struct KpkPosition {
+    int stm;                // 0 white, 1 black
+    int wksq, bksq, psq;
+    Result result;
+
+    explicit KpkPosition(int idx) {
+        wksq = idx & 0x3f;
+        bksq = (idx >> 6) & 0x3f;
+        stm = (idx >> 12) & 1;
+        psq = ((6 - ((idx >> 15) & 0x7)) << 3) | ((idx >> 13) & 0x3);
+
+        const ull king_w = tables::movegen::king_attack_table[wksq];
+        const ull king_b = tables::movegen::king_attack_table[bksq];
+        const ull pawn_att = tables::movegen::white_pawn_attack_table[psq];
+        const int promo_sq = psq + 8;
+
+        if ((distance(wksq, bksq) <= 1) || (wksq == psq) || (bksq == psq)
+                || ((stm == 0) && (pawn_att & (1ULL << bksq)))) {
+            result = INVALID;
+        } else if ((stm == 0) && (rank_of(psq) == 6) && (wksq != promo_sq)
+                && ((distance(bksq, promo_sq) > 1) || (distance(wksq, promo_sq) == 1))) {
+            result = WIN;       // Promotes, and the queen cannot be taken
+        } else if ((stm == 1) && (((king_b & ~(king_w | pawn_att)) == 0)
+                || (king_b & ~king_w & (1ULL << psq)))) {
+            result = DRAW;      // Stalemate, or the pawn is taken
+        } else {
+            result = UNKNOWN;
+        }
+    }
+
+    // White wants a move to a WIN, Black a move to a DRAW. Unknown until one is found, or all are known.
+    Result classify(const std::vector<KpkPosition>& db) const {
+        Result r = INVALID;
+        ull b = tables::movegen::king_attack_table[(stm == 0) ? wksq : bksq];
+        while (b) {
+            const int to = utility::bit::bitboard_to_lowest_square_fast(b);
+            b &= b - 1;
+            r = (Result)(r | ((stm == 0) ? db[index(1, bksq, to, psq)].result : db[index(0, to, wksq, psq)].result));
+        }
+
+        if (stm == 0) {
+            if (rank_of(psq) < 6) r = (Result)(r | db[index(1, bksq, wksq, psq + 8)].result);
+            if ((rank_of(psq) == 1) && (psq + 8 != wksq) && (psq + 8 != bksq))
+                r = (Result)(r | db[index(1, bksq, wksq, psq + 16)].result);
+            return (r & WIN) ? WIN : (r & UNKNOWN) ? UNKNOWN : DRAW;
+        }
+        return (r & DRAW) ? DRAW : (r & UNKNOWN) ? UNKNOWN : WIN;
+    }
+};
+
+void build() {
+    std::vector<KpkPosition> db;
+    db.reserve(N_POSITIONS);
+    for (int idx = 0; idx < N_POSITIONS; idx++) db.emplace_back(idx);
+
+    // Retrograde: keep sweeping until a sweep settles nothing new
+    bool repeat = true;
+    while (repeat) {
+        repeat = false;
+        for (KpkPosition& pos : db) {
+            if (pos.result != UNKNOWN) continue;
+            const Result r = pos.classify(db);
+            if (r != UNKNOWN) {
+                pos.result = r;
+                repeat = true;
+            }
+        }
+    }
+
+    // Anything still unknown cannot be forced. It is a draw.
+    for (int idx = 0; idx < N_POSITIONS; idx++) {
+        if (db[idx].result == WIN) bitbase[idx / 32] |= (1u << (idx & 31));
+    }
+}
+
+}
+
+void init() {
+    std::call_once(init_flag, build);
+}
+
+bool probe(Color strong_side, Square strong_king, Square pawn, Square weak_king, Color to_move) {
+
+    int wksq = strong_king;
+    int bksq = weak_king;
+    int psq = pawn;
+    int stm = (to_move == strong_side) ? 0 : 1;
+
+    if (strong_side == Color::BLACK) {      // Turn the board over, so the pawn goes up
+        wksq ^= 56;
+        bksq ^= 56;
+        psq ^= 56;
+    }
+    if (file_of(psq) > 3) {                 // Mirror it onto files h-e
+        wksq ^= 7;
+        bksq ^= 7;
+        psq ^= 7;
+    }
+
+    const int idx = index(stm, bksq, wksq, psq);
+    return (bitbase[idx / 32] >> (idx & 31)) & 1u;
+}
+
+int score_cp(const GameBoard& b, Color strong_side) {
+
+    const Color weak_side = utility::representation::opposite_color(strong_side);
+    const ull pawn_bb = (strong_side == Color::WHITE) ? b.white_pawns : b.black_pawns;
+    const Square pawn = (Square)utility::bit::bitboard_to_lowest_square_fast(pawn_bb);
+    const Square strong_king = (Square)utility::bit::bitboard_to_lowest_square_fast((strong_side == Color::WHITE) ? b.white_king : b.black_king);
+    const Square weak_king = (Square)utility::bit::bitboard_to_lowest_square_fast((weak_side == Color::WHITE) ? b.white_king : b.black_king);
+
+    if (!probe(strong_side, strong_king, pawn, weak_king, b.turn)) return 0;
+
+    const int rank = (strong_side == Color::WHITE) ? rank_of(pawn) : (7 - rank_of(pawn));
+    const int queening_sq = (strong_side == Color::WHITE) ? (56 + file_of(pawn)) : file_of(pawn);
+
+    return b.centipawn_score_of(Piece::PAWN) + WIN_CP + 20 * rank - 5 * distance(strong_king, queening_sq);
+}
+
+}
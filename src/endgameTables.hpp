@@ -1,9 +1,69 @@
+#pragma once
 
+#include <string>
 
+#include "globals.hpp"
 
-#pragma once
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Syzygy endgame tablebases, probed with the bundled Pyrrhic library (extern/Pyrrhic-master).
+//
+// The table files are memory mapped by Pyrrhic when a table is first needed. One set of tables for the
+// whole program. Search threads only read them.
+//
+//      probe_wdl()   win/draw/loss for the side to move. Used inside the search (right after a capture
+//                    or pawn move, where the halfmove clock is 0, so the 50 move rule is not a question).
+//      probe_root()  ranks the root moves by distance to zeroing (DTZ), or by WDL without DTZ files.
+//
+// No castling rights may be left, or the tables do not apply (can_probe()).
+//
+// Also the built in KPK (king and pawn against king) bitbase. One bit per position, win or draw for the
+// side with the pawn, built by retrograde analysis at startup. It needs no files.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace ShumiChess {
+
+class GameBoard;
+
+namespace syzygy {
+
+bool init(const std::string& path);     // ":" (";" on Windows) separated directories. false if no tables found.
+void unload();
+int largest();                          // Most pieces in a loaded table. 0 if none are loaded.
+
+bool can_probe(const GameBoard& board); // Few enough pieces, no castling rights
+
+enum Wdl { LOSS = 0, BLESSED_LOSS, DRAW, CURSED_WIN, WIN, FAILED };
+Wdl probe_wdl(const GameBoard& board);
+
+struct RootMove {
+    Square fromSQ;
+    Square toSQ;
+    Piece promotion;                    // NONE if not a promotion
+    int rank;                           // Higher is better. Only moves of the best rank keep the result.
+};
+// Fills out[MAX_MOVES], returns how many. 0 if the probe failed.
+constexpr int MAX_MOVES = 256;
+int probe_root(const GameBoard& board, bool has_repeated, RootMove* out);
+
+}
+
+// A specialized evaluator for one material signature (see MaterialInfo). Centipawns for strong_side.
+using EndgameEvalFn = int (*)(const GameBoard& board, Color strong_side);
+
+namespace kpk {
+
+void init();                            // Builds the bitbase once (a few msec). Later calls do nothing.
 
+// true if the side with the pawn wins, false if it is a draw. Squares are ours (H1 = 0). init() first.
+bool probe(Color strong_side, Square strong_king, Square pawn, Square weak_king, Color to_move);
 
-// #include "engine.hpp"
-// #include "gameboard.hpp"
+// King and pawn against king. A win is WIN_CP, more as the pawn goes up and the king gets near its
+// queening square, so the search sees progress even where the tree below is cut off. A draw is zero.
+// A win stays under a queen's worth, so promoting still looks better.
+constexpr int WIN_CP = 400;
+int score_cp(const GameBoard& board, Color strong_side);
 
+}
+}
@@ -92,8 +92,6 @@ Engine::Engine() {
 
     reset_engine();
 
-    ShumiChess::initialize_rays();
-
     // Seed randomization, for engine. (using microseconds since ?)
     using namespace std::chrono;
     auto now = high_resolution_clock::now().time_since_epoch();
@@ -112,8 +110,6 @@ Engine::Engine(const string& fen_notation) : game_board(fen_notation) {
 
     reset_all_but_FEN();
 
-    ShumiChess::initialize_rays();
-
    // Seed randomization, for engine. (using microseconds since ?)
     using namespace std::chrono;
     auto now = high_resolution_clock::now().time_since_epoch();
@@ -239,35 +235,30 @@ void Engine::reset_engine(const string& fen) {      // New game (with fen)
 }
 
 
-void Engine::reset_all_but_FEN()
+//
+// Initialize storage buffers (they are here to avoid extra allocation later). A copied Engine 
+// (as in a Lazy SMP helper) does not inherit the capacities, so it must call me too.
+void Engine::reserve_storage_buffers()
 {
-    d_bestScore_at_root = 0;      // In "abs" score, in centpawns..
-
-    // Initialize storage buffers (they are here to avoid extra allocation later)
     move_string.reserve(_MAX_MOVE_PLUS_SCORE_SIZE);
 
-    psuedo_legal_moves.reserve(MAX_MOVES); 
+    // The move lists have fixed storage (MoveList). Only the per ply lists need allocating.
+    all_legal_moves.resize(MAX_PLY0);
+    all_unquiet_moves.resize(MAX_PLY0);
 
-    for (int iMove=0;iMove<MAX_PLY0;iMove++) {
-        all_legal_moves[iMove].reserve(MAX_MOVES);
-        all_unquiet_moves[iMove].reserve(MAX_MOVES);
-    }
+    if ((int)undo_stack.size() < MAX_UNDO) undo_stack.resize(MAX_UNDO);
+}
 
-    move_history = stack<Move>();
+void Engine::reset_all_but_FEN()
+{
+    d_bestScore_at_root = 0;      // In "abs" score, in centpawns..
 
-    halfway_move_state = stack<int>();
-    halfway_move_state.push(0);
+    reserve_storage_buffers();
 
-    en_passant_history = stack<ull>();
-    en_passant_history.push(0);
+    clear_move_history();
 
     white_king_square = static_cast<Square>(utility::bit::bitboard_to_lowest_square_fast(game_board.white_king));
     black_king_square = static_cast<Square>(utility::bit::bitboard_to_lowest_square_fast(game_board.black_king));
-    white_king_square_history = stack<Square>();
-    black_king_square_history = stack<Square>();
-
-    castle_opportunity_history = stack<uint8_t>();
-    castle_opportunity_history.push(0b1111);
 
 
     computer_ply_so_far = 0;       // real moves in whole game
@@ -351,6 +342,37 @@ bool Engine::in_check_after_move_fast_t(const Move& move)
 
     const ull from_bb = utility::bit::square_to_bitboard(move.fromSQ);
     const ull to_bb = utility::bit::square_to_bitboard(move.toSQ);
+
+    // Does the move check the enemy? For a plain move (not en passant, not castling) that is the moved piece
+    // (direct), or a slider behind the from square (discovered). A discovery needs the from square on a line
+    // with the king, and the to square off that line. Without one, answer from the landing piece alone.
+    if constexpr (!isMyKing) {
+        if (!(move.flags & (FLAGS_IS_EP_CAPTURE | FLAGS_IS_CASTLE_MOVE))) {
+            ull kingBB;
+            const int kingSq = get_king_square_t<enemy>(kingBB);
+            const bool b_no_discovery = !tables::movegen::line_bb[kingSq][move.fromSQ]
+                                     || tables::movegen::aligned(kingSq, move.fromSQ, move.toSQ);
+            if (b_no_discovery) {
+                const ull occ_after = (game_board.get_pieces() & ~from_bb) | to_bb;
+                const Piece lands_as = (move.promotion != Piece::NONE) ? move.promotion : move.piece_type;
+                switch (lands_as) {
+                    case Piece::PAWN:
+                        if constexpr (c == Color::WHITE) return tables::movegen::white_pawn_attack_table[move.toSQ] & kingBB;
+                        else                             return tables::movegen::black_pawn_attack_table[move.toSQ] & kingBB;
+                    case Piece::KNIGHT:
+                        return tables::movegen::knight_attack_table[move.toSQ] & kingBB;
+                    case Piece::BISHOP:
+                        return get_diagonal_attacks_mbb(occ_after, move.toSQ) & kingBB;
+                    case Piece::ROOK:
+                        return get_straight_attacks_mbb(occ_after, move.toSQ) & kingBB;
+                    case Piece::QUEEN:
+                        return (get_straight_attacks_mbb(occ_after, move.toSQ) | get_diagonal_attacks_mbb(occ_after, move.toSQ)) & kingBB;
+                    default:
+                        return false;       // A king never checks directly
+                }
+            }
+        }
+    }
   
     // 1) Moving piece leaves `from`
     pSrc   = &access_pieces_of_color_tp<c>(move.piece_type);
@@ -468,68 +490,13 @@ bool Engine::assert_same_moves(const std::vector<Move>& a,
 }
 
 
-// Put these helpers ABOVE Engine::compute_pins(...) in engine.cpp (file-scope helpers, not lambdas).
-
-static inline int nearest_blocker_sq(ull masked_blockers, bool use_lowest)
-{
-    if (!masked_blockers) return -1;
-    return use_lowest
-        ? utility::bit::bitboard_to_lowest_square_fast(masked_blockers)
-        : utility::bit::bitboard_to_highest_square_fast(masked_blockers);
-}
-
-static inline void process_pin_ray(
-    const ShumiChess::Engine* e,
-    ShumiChess::Engine::PinnedInfo& info,    // I am the output
-    const int kingSq,
-    const ull occ,
-    const ull myPieces,
-    const ull enemyStraight,
-    const ull enemyDiag,
-    const ull* ray_from_sq,
-    const bool use_lowest_for_nearest,
-    const bool is_straight
-)
-{
-    // First piece from king along this ray
-    ull blockers1 = occ & ray_from_sq[kingSq];
-    const int firstSq = nearest_blocker_sq(blockers1, use_lowest_for_nearest);
-    if (firstSq < 0) return;
-
-    const ull firstBB = (1ULL << firstSq);
-
-    // Must be my piece to be pinned
-    if ((myPieces & firstBB) == 0ULL) return;
-
-    // Next piece beyond that candidate, same direction
-    ull blockers2 = occ & ray_from_sq[firstSq];
-    const int pinnerSq = nearest_blocker_sq(blockers2, use_lowest_for_nearest);
-    if (pinnerSq < 0) return;
-
-    const ull pinnerBB = (1ULL << pinnerSq);
-
-    // Must be an enemy slider that attacks along this line
-    if (is_straight) {
-        if ((pinnerBB & enemyStraight) == 0ULL) return;
-    } else {
-        if ((pinnerBB & enemyDiag) == 0ULL) return;
-    }
-
-    // It's a real pin.
-    info.pinnedMask |= firstBB;
-
-    // Allowed squares: ONLY on the king<->pinner line, including capture of pinner.
-    // NOTE: If squares_between_exclusive is not a member, replace e-> with just the function name.
-    info.allowedMask[firstSq] = e->squares_between_exclusive(kingSq, pinnerSq) | pinnerBB;
-}
-
-
 ////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // I am called only from python, when the game is over. I am very wasteful. as get_legal_moves() is very 
 // expensive
 GameState Engine::is_game_over() {
-    int moves_found = get_legal_moves_fast(game_board.turn, false, false, psuedo_legal_moves);
+    MoveList moves;
+    int moves_found = get_legal_moves_fast(game_board.turn, false, false, moves);
     return is_game_over(moves_found);
 }
 
@@ -606,7 +573,9 @@ template<Color c> void Engine::pushMove_t(const Move& move) {
 
     assert(move.piece_type != NONE);
 
-    move_history.push(move);
+    // Save what popMove_t() needs
+    UndoState& undo = push_undo_state();
+    undo.move = move;
 
     // Switch color
     game_board.turn = enemy;
@@ -619,9 +588,6 @@ template<Color c> void Engine::pushMove_t(const Move& move) {
         ++game_board.fullmove;
     }
 
-    // Push full move "clock"
-    halfway_move_state.push(game_board.halfmove);
-
     // Update half move status (used only to apply the "fifty-move draw")
     ++game_board.halfmove;
     if(move.piece_type == ShumiChess::Piece::PAWN) {
@@ -637,10 +603,8 @@ template<Color c> void Engine::pushMove_t(const Move& move) {
     // Store king squares (there is only one king and the eval is faster with this)
     if (move.piece_type == Piece::KING) {
         if constexpr (c == Color::WHITE) {
-            white_king_square_history.push(move.fromSQ);
             white_king_square = move.toSQ;
         } else {
-            black_king_square_history.push(move.fromSQ);
             black_king_square = move.toSQ;
         }
     }
@@ -660,6 +624,7 @@ template<Color c> void Engine::pushMove_t(const Move& move) {
     // Put the piece where it will go.
     if (move.promotion == Piece::NONE) {
         moving_piece |= moveto;
+        game_board.eval_move_piece(c, move.piece_type, square_from, square_to);
         game_board.zobrist_key ^= zobrist_piece_square_get(move.piece_type + c * 6, square_to);
 
         if (move.piece_type == Piece::PAWN) {
@@ -670,6 +635,8 @@ template<Color c> void Engine::pushMove_t(const Move& move) {
         // Promote the piece
         ull& promoted_piece = access_pieces_of_color_tp<c>(move.promotion);
         promoted_piece |= moveto;
+        game_board.eval_remove_piece(c, move.piece_type, square_from);
+        game_board.eval_add_piece(c, move.promotion, square_to);
         game_board.zobrist_key ^= zobrist_piece_square_get(move.promotion + c * 6, square_to);
     }
 
@@ -683,6 +650,7 @@ template<Color c> void Engine::pushMove_t(const Move& move) {
 
             int target_pawn_square = utility::bit::bitboard_to_lowest_square_safe(target_pawn_bitboard);
             access_pieces_of_color(move.capture, enemy) &= ~target_pawn_bitboard;
+            game_board.eval_remove_piece(enemy, move.capture, target_pawn_square);
 
             game_board.zobrist_key ^= zobrist_piece_square_get(move.capture + enemy * 6, target_pawn_square);
 
@@ -692,6 +660,7 @@ template<Color c> void Engine::pushMove_t(const Move& move) {
             // Regular capture
             ull& where_I_was = access_pieces_of_color(move.capture, enemy);
             where_I_was &= ~moveto;
+            game_board.eval_remove_piece(enemy, move.capture, square_to);
 
             game_board.zobrist_key ^= zobrist_piece_square_get(move.capture + enemy * 6, square_to);
 
@@ -739,12 +708,11 @@ template<Color c> void Engine::pushMove_t(const Move& move) {
 
         // Zobrist update for the rook hop in castling
         assert(rook_from_sq >= 0 && rook_to_sq >= 0);
+        game_board.eval_move_piece(c, Piece::ROOK, rook_from_sq, rook_to_sq);
         game_board.zobrist_key ^= zobrist_piece_square_get(ShumiChess::Piece::ROOK + c * 6, rook_from_sq);
         game_board.zobrist_key ^= zobrist_piece_square_get(ShumiChess::Piece::ROOK + c * 6, rook_to_sq);
     }
 
-    en_passant_history.push(game_board.en_passant_landing_bb);
-
     // Zobrist: remove old en passant (if any)
     if (game_board.en_passant_landing_bb) {
         int old_ep_sq   = utility::bit::bitboard_to_lowest_square_safe(game_board.en_passant_landing_bb);
@@ -765,7 +733,6 @@ template<Color c> void Engine::pushMove_t(const Move& move) {
 
     // Manage castling rights
     uint8_t castle_rights = game_board.castle_rights;
-    castle_opportunity_history.push(castle_rights);
 
     // This line transfers the castling rights in the move to the board castling rights.
     // Its not clear this does anything more than transfer the castling rights from the FEN to the gameboard.
@@ -836,170 +803,264 @@ template<Color c> void Engine::popMove_t() {
 
     constexpr Color enemy = utility::representation::opposite_color_t<c>;
 
-    // Pop move history
-    bool have_last = !move_history.empty();
-    assert(have_last);
-    const Move move = move_history.top();
-    move_history.pop();
+    // Pop the undo record. Everything but the pieces comes straight back from it (the zobrist keys too).
+    assert(n_undo > 0);
+    const UndoState& undo = undo_stack[--n_undo];
+    const Move& move = undo.move;
+    assert(move.piece_type != Piece::NONE);   // A null move must be undone by popNullMove_t()
 
-    // --- undo zobrist for en_passant_landing_bb ---
-    if (game_board.en_passant_landing_bb) {
-        int cur_ep_sq   = utility::bit::bitboard_to_lowest_square_safe(game_board.en_passant_landing_bb);
-        int cur_ep_file = cur_ep_sq & 7;
-        game_board.zobrist_key ^= zobrist_enpassant[cur_ep_file];
-    }
-
-    ull prev_ep_bb = en_passant_history.top();
-    if (prev_ep_bb) {
-        int prev_ep_sq   = utility::bit::bitboard_to_lowest_square_safe(prev_ep_bb);
-        int prev_ep_file = prev_ep_sq & 7;
-        game_board.zobrist_key ^= zobrist_enpassant[prev_ep_file];
-    }
-
-    // pop the enpassent history from the stack
-    game_board.en_passant_landing_bb = en_passant_history.top();
-    en_passant_history.pop();
-
-    // Zobrist undo for castling rights
-    uint8_t castle_current = game_board.castle_rights;
-    uint8_t castle_prev = castle_opportunity_history.top();
-
-    if (castle_current != castle_prev) {
-        game_board.zobrist_key ^= zobrist_castling[castle_current];
-        game_board.zobrist_key ^= zobrist_castling[castle_prev];
-    }
-
-    game_board.castle_rights = castle_opportunity_history.top();
-
-    // Pop the castle opportunity.
-    castle_opportunity_history.pop();
-
-    game_board.zobrist_key ^= zobrist_side;
+    game_board.en_passant_landing_bb = undo.en_passant_landing_bb;
+    game_board.castle_rights = undo.castle_rights;
+    game_board.halfmove = undo.halfmove;
+    game_board.zobrist_key = undo.zobrist_key;
+    game_board.pawn_zobrist_key = undo.pawn_zobrist_key;
+    white_king_square = undo.white_king_square;
+    black_king_square = undo.black_king_square;
 
     game_board.turn = c;
 
     if constexpr (c == Color::BLACK) {
         --game_board.fullmove;
     }
-    // pop move states
-    game_board.halfmove = halfway_move_state.top();
-    halfway_move_state.pop();
 
-    // const ull frm = move.from;
-    // const ull to = move.to;
     const ull movefrom = utility::bit::square_to_bitboard(move.fromSQ);
     const ull moveto = utility::bit::square_to_bitboard(move.toSQ);
 
-    const int square_from = move.fromSQ;
-    const int square_to = move.toSQ;
-
-    if (move.piece_type == Piece::KING) {
-        if constexpr (c == Color::WHITE) {
-            white_king_square = white_king_square_history.top();
-            white_king_square_history.pop();
-        } else {
-            black_king_square = black_king_square_history.top();
-            black_king_square_history.pop();
-        }
-    }
-
     // pop the "actual move"
     ull& moving_piece = access_pieces_of_color_tp<c>(move.piece_type);
     moving_piece &= ~moveto;
     moving_piece |= movefrom;
 
-    assert((move.piece_type + c * 6) < 12);
-    game_board.zobrist_key ^= zobrist_piece_square_get(move.piece_type + c * 6, square_from);
-
-    if (move.piece_type == Piece::PAWN) {
-        game_board.pawn_zobrist_key ^= zobrist_piece_square_get(move.piece_type + c * 6, square_from);
-    }
-
     // pop pawn promotions
-    if (move.promotion == Piece::NONE) {
-        assert((move.piece_type + c * 6) < 12);
-        game_board.zobrist_key ^= zobrist_piece_square_get(move.piece_type + c * 6, square_to);
-
-        if (move.piece_type == Piece::PAWN) {
-            game_board.pawn_zobrist_key ^= zobrist_piece_square_get(move.piece_type + c * 6, square_to);
-        }
-    }
-    else {
+    if (move.promotion != Piece::NONE) {
         ull& promoted_piece = access_pieces_of_color_tp<c>(move.promotion);
         promoted_piece &= ~moveto;
-
-        assert((move.piece_type + c * 6) < 12);
-        game_board.zobrist_key ^= zobrist_piece_square_get(move.promotion + c * 6, square_to);
+        game_board.eval_remove_piece(c, move.promotion, move.toSQ);
+        game_board.eval_add_piece(c, move.piece_type, move.fromSQ);
+    } else {
+        game_board.eval_move_piece(c, move.piece_type, move.toSQ, move.fromSQ);
     }
 
     if (move.capture != Piece::NONE) {
 
-        //ull move_to_bb = moveto;
         if (move.flags & FLAGS_IS_EP_CAPTURE) {
             ull target_pawn_bb = (c == Color::WHITE) ? (moveto >> 8) : (moveto << 8);
-
-            int target_pawn_square = utility::bit::bitboard_to_lowest_square_safe(target_pawn_bb);
-
             access_pieces_of_color(move.capture, enemy) |= target_pawn_bb;
-            game_board.zobrist_key ^= zobrist_piece_square_get(move.capture + enemy * 6, target_pawn_square);
-
-            game_board.pawn_zobrist_key ^= zobrist_piece_square_get(move.capture + enemy * 6, target_pawn_square);
-
+            game_board.eval_add_piece(enemy, move.capture, utility::bit::bitboard_to_lowest_square_fast(target_pawn_bb));
         } else {
             access_pieces_of_color(move.capture, enemy) |= moveto;
-            game_board.zobrist_key ^= zobrist_piece_square_get(move.capture + enemy * 6, square_to);
-
-            if (move.capture == Piece::PAWN) {
-                game_board.pawn_zobrist_key ^= zobrist_piece_square_get(move.capture + enemy * 6, square_to);
-            }
+            game_board.eval_add_piece(enemy, move.capture, move.toSQ);
         }
 
     } else if (move.flags & FLAGS_IS_CASTLE_MOVE) {
 
-        int rook_from_sq;
-        int rook_to_sq;
-
         ull& friendly_rooks = access_pieces_of_color_tp<ShumiChess::Piece::ROOK>(c);
 
         ull move_to_bb = moveto;
         if (move_to_bb & 0b00100000'00000000'00000000'00000000'00000000'00000000'00000000'00100000) {
             // Popping a Queenside Castle
             if constexpr (c == Color::WHITE) {
-                rook_from_sq = game_board.square_d1;
-                rook_to_sq = game_board.square_a1;
                 friendly_rooks &= ~(1ULL << game_board.square_d1);
                 friendly_rooks |= (1ULL << game_board.square_a1);
+                game_board.eval_move_piece(c, Piece::ROOK, game_board.square_d1, game_board.square_a1);
             } else {
-                rook_from_sq = game_board.square_d8;
-                rook_to_sq = game_board.square_a8;
                 friendly_rooks &= ~(1ULL << game_board.square_d8);
                 friendly_rooks |= (1ULL << game_board.square_a8);
+                game_board.eval_move_piece(c, Piece::ROOK, game_board.square_d8, game_board.square_a8);
             }
         } else if (move_to_bb & 0b00000010'00000000'00000000'00000000'00000000'00000000'00000000'00000010) {
             // Popping a Kingside Castle
             if constexpr (c == Color::WHITE) {
-                rook_from_sq = game_board.square_f1;
-                rook_to_sq = game_board.square_h1;
                 friendly_rooks &= ~(1ULL << game_board.square_f1);
                 friendly_rooks |= (1ULL << game_board.square_h1);
+                game_board.eval_move_piece(c, Piece::ROOK, game_board.square_f1, game_board.square_h1);
             } else {
-                rook_from_sq = game_board.square_f8;
-                rook_to_sq = game_board.square_h8;
                 friendly_rooks &= ~(1ULL << game_board.square_f8);
                 friendly_rooks |= (1ULL << game_board.square_h8);
+                game_board.eval_move_piece(c, Piece::ROOK, game_board.square_f8, game_board.square_h8);
             }
         } else {
             assert(0);
         }
-
-        game_board.zobrist_key ^= zobrist_piece_square_get(ShumiChess::Piece::ROOK + c * 6, rook_from_sq);
-        game_board.zobrist_key ^= zobrist_piece_square_get(ShumiChess::Piece::ROOK + c * 6, rook_to_sq);
     }
 
     //game_board.pop_move_to_pieces_on_square(move);
 
 }
 
+
+/////////////////////////////////////////////////////////////////////////////////////////
+//
+// "Null move": color c passes. Only the turn, the en passant square and the half move clock change.
+// Used only by null move pruning in the search. The undo record has an empty move (last_move() skips
+// it), so it must be undone with popNullMove_t() (not popMove_t()).
+//
+template<Color c> void Engine::pushNullMove_t() {
+
+    constexpr Color enemy = utility::representation::opposite_color_t<c>;
+    assert(game_board.turn == c);
+
+    UndoState& undo = push_undo_state();
+    undo.move = Move();
+
+    // Switch color
+    game_board.turn = enemy;
+    game_board.zobrist_key ^= zobrist_side;
+
+    if constexpr (c == Color::BLACK) {
+        ++game_board.fullmove;
+    }
+
+    ++game_board.halfmove;
+
+    // A pass gives up any en passant capture
+    if (game_board.en_passant_landing_bb) {
+        int old_ep_sq   = utility::bit::bitboard_to_lowest_square_safe(game_board.en_passant_landing_bb);
+        int old_ep_file = old_ep_sq & 7;
+        game_board.zobrist_key ^= zobrist_enpassant[old_ep_file];
+    }
+    game_board.en_passant_landing_bb = 0ULL;
+}
+
+//
+// undoes pushNullMove_t<c>()
+template<Color c> void Engine::popNullMove_t() {
+
+    constexpr Color enemy = utility::representation::opposite_color_t<c>;
+    assert(game_board.turn == enemy);
+    assert(game_board.en_passant_landing_bb == 0ULL);
+
+    assert(n_undo > 0);
+    const UndoState& undo = undo_stack[--n_undo];
+    assert(undo.move.piece_type == Piece::NONE);
+
+    game_board.en_passant_landing_bb = undo.en_passant_landing_bb;
+    game_board.halfmove = undo.halfmove;
+    game_board.zobrist_key = undo.zobrist_key;
+
+    if constexpr (c == Color::BLACK) {
+        --game_board.fullmove;
+    }
+
+    game_board.turn = c;
+}
+
+
+//
+// Saves the board state that pushMove_t() and pushNullMove_t() change, on the undo stack. The caller
+// fills in the move. The stack only grows if a game gets longer than it.
+UndoState& Engine::push_undo_state() {
+
+    if (n_undo == (int)undo_stack.size()) {
+        undo_stack.resize(undo_stack.size() + MAX_UNDO);
+    }
+
+    UndoState& undo = undo_stack[n_undo++];
+    undo.castle_rights = game_board.castle_rights;
+    undo.white_king_square = white_king_square;
+    undo.black_king_square = black_king_square;
+    undo.halfmove = game_board.halfmove;
+    undo.en_passant_landing_bb = game_board.en_passant_landing_bb;
+    undo.zobrist_key = game_board.zobrist_key;
+    undo.pawn_zobrist_key = game_board.pawn_zobrist_key;
+    return undo;
+}
+
+const Move* Engine::last_move() const {
+    for (int i = n_undo - 1; i >= 0; i--) {
+        if (undo_stack[i].move.piece_type != Piece::NONE) return &undo_stack[i].move;
+    }
+    return nullptr;
+}
+
+std::vector<Move> Engine::move_history_to_vector() const {
+    std::vector<Move> seq;
+    seq.reserve(n_undo);
+    for (int i = 0; i < n_undo; i++) {
+        if (undo_stack[i].move.piece_type != Piece::NONE) seq.push_back(undo_stack[i].move);
+    }
+    return seq;
+}
+
+
+//
+// The NNUE features one move adds and removes, seen from perspective's side (whose king must not have moved).
+static void nnue_move_features(const Move& m, Color perspective, int king_sq
+                                , int* added, int& n_added, int* removed, int& n_removed) {
+    n_added = 0;
+    n_removed = 0;
+    if (m.piece_type == Piece::NONE) return;       // null move
+
+    const Color them = utility::representation::opposite_color(m.color);
+
+    if (m.piece_type != Piece::KING) {
+        const Piece landed = (m.promotion != Piece::NONE) ? m.promotion : m.piece_type;
+        removed[n_removed++] = nnue::feature_index(perspective, m.piece_type, m.color, m.fromSQ, king_sq);
+        added[n_added++] = nnue::feature_index(perspective, landed, m.color, m.toSQ, king_sq);
+    }
+
+    if (m.capture != Piece::NONE) {
+        int capture_sq = m.toSQ;
+        if (m.flags & FLAGS_IS_EP_CAPTURE) capture_sq = (m.color == Color::WHITE) ? (m.toSQ - 8) : (m.toSQ + 8);
+        removed[n_removed++] = nnue::feature_index(perspective, m.capture, them, capture_sq, king_sq);
+    } else if (m.flags & FLAGS_IS_CASTLE_MOVE) {
+        // The king lands on g1/g8 (kingside, rook h to f) or c1/c8 (queenside, rook a to d)
+        const int rank_base = (m.color == Color::WHITE) ? 0 : 56;
+        const bool kingside = (m.toSQ == rank_base + GameBoard::square_g1);
+        removed[n_removed++] = nnue::feature_index(perspective, Piece::ROOK, m.color,
+                                    rank_base + (kingside ? GameBoard::square_h1 : GameBoard::square_a1), king_sq);
+        added[n_added++] = nnue::feature_index(perspective, Piece::ROOK, m.color,
+                                    rank_base + (kingside ? GameBoard::square_f1 : GameBoard::square_d1), king_sq);
+    }
+}
+
+//
+// NNUE eval, in centipawns for the side to move. Each half of the accumulator is brought forward from the
+// nearest ply below that has it, by replaying the moves on the undo stack. If there is none close enough,
+// or that side's king moved on the way, the half is rebuilt from the board.
+int Engine::nnue_evaluate() {
+
+    constexpr int MAX_REPLAY = 12;      // Plies. A refresh costs about as much as this many one-move updates.
+
+    if (nnue_stack.size() <= undo_stack.size()) nnue_stack.resize(undo_stack.size() + 1);
+
+    nnue::Accumulator& top = nnue_stack[n_undo];
+
+    for (const Color p : {Color::WHITE, Color::BLACK}) {
+        if (top.key[p] == game_board.zobrist_key) continue;
+
+        const int king_sq = (p == Color::WHITE) ? white_king_square : black_king_square;
+
+        int base = n_undo;
+        bool found = false;
+        while (base > 0 && (n_undo - base) < MAX_REPLAY) {
+            const Move& m = undo_stack[base - 1].move;
+            if (m.piece_type == Piece::KING && m.color == p) break;
+            base--;
+            if (nnue_stack[base].key[p] == undo_stack[base].zobrist_key) {
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) {
+            nnue::refresh(game_board, p, king_sq, top.v[p]);
+            top.key[p] = game_board.zobrist_key;
+            continue;
+        }
+
+        int added[3], removed[3];
+        int n_added, n_removed;
+        for (int i = base + 1; i <= n_undo; i++) {
+            nnue_move_features(undo_stack[i - 1].move, p, king_sq, added, n_added, removed, n_removed);
+            nnue::update(nnue_stack[i - 1].v[p], nnue_stack[i].v[p], added, n_added, removed, n_removed);
+            nnue_stack[i].key[p] = (i == n_undo) ? game_board.zobrist_key : undo_stack[i].zobrist_key;
+        }
+    }
+
+    return nnue::output(top, game_board.turn);
+}
+
 ull& Engine::access_pieces_of_color(Piece piece, Color color) {
     switch (piece)  {
         case Piece::PAWN:
@@ -1159,7 +1220,7 @@ template <Piece P, Color c> ull& Engine::access_pieces_of_color_tp()
 // Fills in a Move data structure based on a single "from" square, and multiple "to" squares.
 //
 template<Color c, bool capture, bool promotion, bool is_en_passent_cap, bool is_castle>
-void Engine::add_psuedo_move_to_vector(vector<Move>& moves,        // output
+void Engine::add_psuedo_move_to_vector(MoveList& moves,        // output
                                 Square fromSQ,
                                 ull bitboard_to,            // I can be multiple squares in one bitboard. 
                                 Piece piece,
@@ -1277,7 +1338,7 @@ void Engine::bitboards_to_algebraic(ShumiChess::Color color_that_moved
                             , GameState state 
                             , bool isCheck
                             , bool bPadTrailing
-                            , const vector<ShumiChess::Move>* p_legal_moves   // from this position. This is only used for disambigouation
+                            , const MoveList* p_legal_moves   // from this position. This is only used for disambigouation
                             , std::string& MoveText) const           // output
 {
     char thisChar;
@@ -1671,19 +1732,19 @@ void Engine::move_and_score_to_string(const Move best_move, Score d_best_move_va
 // Notes: O(U^2) sort due to linear insertion; U is usually small. (<5)
 //
 void Engine::sort_unquiet_moves_qsearch_L(
-                const vector<ShumiChess::Move>& moves,  // input
-                vector<ShumiChess::Move>& MovesOut      // output
+                const MoveList& moves,  // input
+                MoveList& MovesOut      // output
             )
 {
 
     MovesOut.clear();
-    MovesOut.reserve(moves.size()); 
     
     // Recapture bias: if a capture lands on opponent's last-to square, try it earliest
-    bool have_last = !move_history.empty();
+    const Move* p_last = last_move();
+    bool have_last = (p_last != nullptr);
     Square last_toSQ = NO_SQUARE;
     if (have_last) {
-        last_toSQ = move_history.top().toSQ;
+        last_toSQ = p_last->toSQ;
     }
 
     for (const ShumiChess::Move& mv : moves) {
@@ -1695,15 +1756,11 @@ void Engine::sort_unquiet_moves_qsearch_L(
             int key = mvv_lva_key(mv);  // (call me on captures only)
             if (mv.toSQ == last_toSQ) key += 800;  // small recapture bump for opponent's last-to square,
 
-            std::vector<ShumiChess::Move>::iterator it;
+            MoveList::iterator it;
             for (it = MovesOut.begin(); it != MovesOut.end(); ++it) {
                 // Only compare against other captures; promos-without-capture stay after captures
                 if (it->capture != ShumiChess::Piece::NONE) {
-                    int key0 = mvv_lva_key(*it);
-
-                    if ( (have_last) && (it->toSQ == last_toSQ) ) {
-                        key0 += 800;  // small recapture bump for opponent's last-to square
-                    }
+                    const int key0 = MovesOut.score_of(it);    // its key, kept when it was inserted
 
                     if (key > key0) {
                         break;
@@ -1711,7 +1768,7 @@ void Engine::sort_unquiet_moves_qsearch_L(
                 }
             }
 
-            MovesOut.insert(it, mv);    // Put this move into the output array
+            MovesOut.insert(it, mv, key);    // Put this move (and its key) into the output array
         
 
         } else {    // Not a capture
@@ -1736,18 +1793,19 @@ void Engine::sort_unquiet_moves_qsearch_L(
 
 
 void Engine::sort_unquiet_moves_qsearch_H(
-                const vector<ShumiChess::Move>& moves,  // input
-                vector<ShumiChess::Move>& MovesOut      // output
+                const MoveList& moves,  // input
+                MoveList& MovesOut      // output
             )
 {
 
     MovesOut.clear();
     
     // Recapture bias: if a capture lands on opponent's last-to square, try it earlest
-    bool have_last = !move_history.empty();
+    const Move* p_last = last_move();
+    bool have_last = (p_last != nullptr);
     Square last_toSQ = NO_SQUARE;
     if (have_last) {
-        last_toSQ = move_history.top().toSQ;
+        last_toSQ = p_last->toSQ;
     }
 
     for (const ShumiChess::Move& mv : moves) {
@@ -1761,9 +1819,7 @@ void Engine::sort_unquiet_moves_qsearch_H(
             if (attacker > victim) {  // p x Q like captures need no SEE analysis. Do not prune these.
 
                 // Very late in analysis! So discard negative SEE captures below one pawn.
-                int testValue = game_board.SEE_for_capture_new(game_board.turn, mv, nullptr);
-
-                if (testValue <= -74) {     // centipawns
+                if (!game_board.see_ge(mv, -73)) {     // centipawns
                   
                     // Dont sort up this capture, prune it.
                     continue;
@@ -1775,15 +1831,11 @@ void Engine::sort_unquiet_moves_qsearch_H(
             int key = mvv_lva_key(mv);  // (call me on captures only)
             if (mv.toSQ == last_toSQ) key += 800;  // small recapture bump for opponent's last-to square,
 
-            std::vector<ShumiChess::Move>::iterator it;
+            MoveList::iterator it;
             for (it = MovesOut.begin(); it != MovesOut.end(); ++it) {
                 // Only compare against other captures; promos-without-capture stay after captures
                 if (it->capture != ShumiChess::Piece::NONE) {
-                    int key0 = mvv_lva_key(*it);
-
-                    if ( (have_last) && (it->toSQ == last_toSQ) ) {
-                        key0 += 800;  // small recapture bump for opponent's last-to square
-                    }
+                    const int key0 = MovesOut.score_of(it);    // its key, kept when it was inserted
 
                     if (key > key0) {
                         break;
@@ -1791,7 +1843,7 @@ void Engine::sort_unquiet_moves_qsearch_H(
                 }
             }
 
-            MovesOut.insert(it, mv);    // Put this move into the output array
+            MovesOut.insert(it, mv, key);    // Put this move (and its key) into the output array
         
 
         } else {    // Not a capture
@@ -1814,18 +1866,18 @@ void Engine::sort_unquiet_moves_qsearch_H(
 }
 
 void Engine::sort_check_evasions_qsearch(
-                const vector<ShumiChess::Move>& moves,  // input: all legal check evasions
-                vector<ShumiChess::Move>& MovesOut      // output
+                const MoveList& moves,  // input: all legal check evasions
+                MoveList& MovesOut      // output
             )
 {
     MovesOut.clear();
-    MovesOut.reserve(moves.size());
 
     // Recapture bias: often, a capture on the opponent's last-to square captures the checker.
-    bool have_last = !move_history.empty();
+    const Move* p_last = last_move();
+    bool have_last = (p_last != nullptr);
     Square last_toSQ = NO_SQUARE;
     if (have_last) {
-        last_toSQ = move_history.top().toSQ;
+        last_toSQ = p_last->toSQ;
     }
 
     for (const ShumiChess::Move& mv : moves) {
@@ -1850,32 +1902,17 @@ void Engine::sort_check_evasions_qsearch(
         }
 
         // Insert this evasion before the first already-output evasion with a lower key.
-        std::vector<ShumiChess::Move>::iterator it;
+        MoveList::iterator it;
         for (it = MovesOut.begin(); it != MovesOut.end(); ++it) {
 
-            int key0 = 0;
-
-            if (it->capture != ShumiChess::Piece::NONE) {
-                key0 = 10000 + mvv_lva_key(*it);
-
-                if ((have_last) && (it->toSQ == last_toSQ)) {
-                    key0 += 800;
-                }
-
-            } else if (it->promotion != ShumiChess::Piece::NONE) {
-                key0 = 5000;
-
-                if (it->promotion == ShumiChess::Piece::QUEEN) {
-                    key0 += 800;
-                }
-            }
+            const int key0 = MovesOut.score_of(it);     // its key, kept when it was inserted
 
             if (key > key0) {
                 break;
             }
         }
 
-        MovesOut.insert(it, mv);
+        MovesOut.insert(it, mv, key);
     }
 
     return;
@@ -1928,7 +1965,7 @@ string Engine::moves_into_string(const std::vector<Move>& mvs)
 // Warning: this function is expensive. Should be called only for making formal PGN or move files.
 void Engine::move_into_string_full(ShumiChess::Move m) {
 
-    vector<Move> moves;
+    MoveList moves;
     moves.clear();
     int iLegalMoves;    // I am not used
 
@@ -2000,29 +2037,19 @@ void Engine::print_move_history_to_buffer(char *out, size_t out_size)
 void Engine::print_move_history_to_file(FILE* fp, const char* psz) {
 
     //int ierr = fputs("\nhistory: ", fp);
-    int ierr = fprintf(fp, " (%03ld) %s:", (long)move_history.size(), psz);
-    assert (ierr!=EOF);
+    const std::vector<ShumiChess::Move> seq = move_history_to_vector();
 
-    // copy stack so we don't mutate Engine's history
-    std::stack<ShumiChess::Move> tmp = move_history;
+    int ierr = fprintf(fp, " (%03ld) %s:", (long)seq.size(), psz);
+    assert (ierr!=EOF);
 
-    print_move_history_to_file0(fp, tmp);
+    print_move_history_to_file0(fp, seq);
 }
 
 
-void Engine::print_move_history_to_file0(FILE* fp, std::stack<ShumiChess::Move> tmp) {
+void Engine::print_move_history_to_file0(FILE* fp, const std::vector<ShumiChess::Move>& seq) {
     bool bFlipColor = false;
 
-    // collect in a vector (top = newest), then reverse to oldest → newest
-    std::vector<ShumiChess::Move> seq;
-    seq.reserve(tmp.size());
-    while (!tmp.empty()) {
-        seq.push_back(tmp.top());
-        tmp.pop();
-    }
-    std::reverse(seq.begin(), seq.end());
-
-    // print each move
+    // print each move (oldest → newest)
     for (const ShumiChess::Move& m : seq) {
         bFlipColor = !bFlipColor;
         print_move_to_file(m, -2, (GameState::INPROGRESS), false, false, bFlipColor, fp);
@@ -2155,7 +2182,7 @@ void Engine::print_move_to_file_from_string(const char* p_move_text, Color turn,
 void Engine::debug_SEE_for_all_captures(FILE* fp)
 {
     // All legal moves for the current side to move
-    vector<Move> moves;
+    MoveList moves;
     get_legal_moves_fast(Color::BLACK, false, false, moves);
 
     fprintf(fp, "ddebug_SEE_for_all_captures: %d\n", (int)moves.size());
@@ -2182,7 +2209,7 @@ void Engine::debug_SEE_for_all_captures(FILE* fp)
 
 
         // SEE for this *specific* capture from the mover's point of view
-        int see_value = game_board.SEE_for_capture(mv.color, mv, fp);
+        int see_value = game_board.see(mv);
         //assert(see_value>=0);
 
         // Flag clearly losing captures
@@ -2220,8 +2247,8 @@ void Engine::debug_SEE_for_all_captures(FILE* fp)
 
 // --- Phase 2: Move generation templates ---
 
-template<Color c, bool caps_only>
-void Engine::add_pawn_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
+template<Color c, bool caps_only, bool quiets_only>
+void Engine::add_pawn_moves_to_vector_t(MoveList& all_psuedo_legal_moves) {
     ull pawns = game_board.get_pieces_template<Piece::PAWN, c>();
     if (!pawns) return;
 
@@ -2275,7 +2302,7 @@ void Engine::add_pawn_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
         //assert(potential_promotion == potential_promotion2);
         
         ull promo_unblocked = potential_promotion & ~all_pieces;
-        if (promo_unblocked) {
+        if (!quiets_only && promo_unblocked) {
             add_psuedo_move_to_vector<c, false, true, false, false>(all_psuedo_legal_moves
                 , square, promo_unblocked, Piece::PAWN
                 , NO_SQUARE);
@@ -2300,7 +2327,7 @@ void Engine::add_pawn_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
         //assert (attacks == (attack_fleft | attack_fright));
         //assert(normal_attacks2 == normal_attacks);
 
-        if (normal_attacks) {
+        if (!quiets_only && normal_attacks) {
             const ull promo_mask = enemy_starting_rank_mask;
             const bool has_promo = (normal_attacks & promo_mask) != 0ULL;
             if (has_promo) {
@@ -2315,7 +2342,7 @@ void Engine::add_pawn_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
         // enpassant (Part C of the process: read the gameboard element, and make a move)
         #ifndef DEBUG_NO_ENPASSANT
             ull enpassant_end_loc = (attacks) & game_board.en_passant_landing_bb;
-            if (enpassant_end_loc) {
+            if (!quiets_only && enpassant_end_loc) {
                 if (enpassant_end_loc) {
                     // Add the enpassant move
                     add_psuedo_move_to_vector<c, true, false, true, false>(all_psuedo_legal_moves
@@ -2379,8 +2406,8 @@ void Engine::add_pawn_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
     }
 }
 
-template<Color c, bool caps_only>
-void Engine::add_knight_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
+template<Color c, bool caps_only, bool quiets_only>
+void Engine::add_knight_moves_to_vector_t(MoveList& all_psuedo_legal_moves) {
     ull knights = game_board.get_pieces_template<Piece::KNIGHT, c>();
 
     while (knights) {
@@ -2395,8 +2422,10 @@ void Engine::add_knight_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves)
         ull enemy_piece_attacks = avail_attacks & all_enemy_pieces;
 
         // capture moves
-        add_psuedo_move_to_vector<c, true, false, false, false>(all_psuedo_legal_moves, square, enemy_piece_attacks, Piece::KNIGHT
-            , NO_SQUARE);
+        if constexpr (!quiets_only) {
+            add_psuedo_move_to_vector<c, true, false, false, false>(all_psuedo_legal_moves, square, enemy_piece_attacks, Piece::KNIGHT
+                , NO_SQUARE);
+        }
 
         // quiet moves
         if constexpr (!caps_only) {
@@ -2407,8 +2436,8 @@ void Engine::add_knight_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves)
     }
 }
 
-template<Color c, bool caps_only>
-void Engine::add_rook_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
+template<Color c, bool caps_only, bool quiets_only>
+void Engine::add_rook_moves_to_vector_t(MoveList& all_psuedo_legal_moves) {
     ull rooks = game_board.get_pieces_template<Piece::ROOK, c>();
 
     while (rooks) {
@@ -2426,8 +2455,10 @@ void Engine::add_rook_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
         ull enemy_piece_attacks = avail_attacks & all_enemy_pieces;
 
         // capture moves
-        add_psuedo_move_to_vector<c, true, false, false, false>(all_psuedo_legal_moves, square, enemy_piece_attacks, Piece::ROOK
-            , NO_SQUARE);
+        if constexpr (!quiets_only) {
+            add_psuedo_move_to_vector<c, true, false, false, false>(all_psuedo_legal_moves, square, enemy_piece_attacks, Piece::ROOK
+                , NO_SQUARE);
+        }
 
         // quiet moves
         if constexpr (!caps_only) {
@@ -2438,8 +2469,8 @@ void Engine::add_rook_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
     }
 }
 
-template<Color c, bool caps_only>
-void Engine::add_bishop_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
+template<Color c, bool caps_only, bool quiets_only>
+void Engine::add_bishop_moves_to_vector_t(MoveList& all_psuedo_legal_moves) {
     ull bishops = game_board.get_pieces_template<Piece::BISHOP, c>();
 
     while (bishops) {
@@ -2457,8 +2488,10 @@ void Engine::add_bishop_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves)
         ull enemy_piece_attacks = avail_attacks & all_enemy_pieces;
 
         // capture moves        
-        add_psuedo_move_to_vector<c, true, false, false, false>(all_psuedo_legal_moves, square, enemy_piece_attacks, Piece::BISHOP
-            , NO_SQUARE);
+        if constexpr (!quiets_only) {
+            add_psuedo_move_to_vector<c, true, false, false, false>(all_psuedo_legal_moves, square, enemy_piece_attacks, Piece::BISHOP
+                , NO_SQUARE);
+        }
 
         // quiet moves
         if constexpr (!caps_only) {
@@ -2469,8 +2502,8 @@ void Engine::add_bishop_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves)
     }
 }
 
-template<Color c, bool caps_only>
-void Engine::add_queen_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
+template<Color c, bool caps_only, bool quiets_only>
+void Engine::add_queen_moves_to_vector_t(MoveList& all_psuedo_legal_moves) {
     ull queens = game_board.get_pieces_template<Piece::QUEEN, c>();
 
     while (queens) {
@@ -2493,8 +2526,10 @@ void Engine::add_queen_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
         ull enemy_piece_attacks = avail_attacks & all_enemy_pieces;
 
         // capture moves
-        add_psuedo_move_to_vector<c, true, false, false, false>(all_psuedo_legal_moves, square, enemy_piece_attacks, Piece::QUEEN
-            , NO_SQUARE);
+        if constexpr (!quiets_only) {
+            add_psuedo_move_to_vector<c, true, false, false, false>(all_psuedo_legal_moves, square, enemy_piece_attacks, Piece::QUEEN
+                , NO_SQUARE);
+        }
 
         // quiet moves
         if constexpr (!caps_only) {
@@ -2505,8 +2540,8 @@ void Engine::add_queen_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
     }
 }
 
-template<Color c, bool caps_only>
-void Engine::add_king_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
+template<Color c, bool caps_only, bool quiets_only>
+void Engine::add_king_moves_to_vector_t(MoveList& all_psuedo_legal_moves) {
    
     ull single_king = game_board.get_pieces_template<Piece::KING, c>();
     assert (single_king);                              // Has to be kings
@@ -2518,8 +2553,10 @@ void Engine::add_king_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
 
     // capture moves
     ull enemy_piece_attacks = avail_attacks & all_enemy_pieces;
-    add_psuedo_move_to_vector<c, true, false, false, false>(all_psuedo_legal_moves, square, enemy_piece_attacks, Piece::KING
-        , NO_SQUARE);
+    if constexpr (!quiets_only) {
+        add_psuedo_move_to_vector<c, true, false, false, false>(all_psuedo_legal_moves, square, enemy_piece_attacks, Piece::KING
+            , NO_SQUARE);
+    }
 
     // quiet moves
     if constexpr (!caps_only) {
@@ -2621,8 +2658,9 @@ void Engine::add_king_moves_to_vector_t(vector<Move>& all_psuedo_legal_moves) {
     }
 }
 
-template<Color c, bool caps_only>
-int Engine::get_psuedo_legal_moves_t(vector<Move>& all_psuedo_legal_moves) {
+template<Color c, bool caps_only, bool quiets_only>
+int Engine::get_psuedo_legal_moves_t(MoveList& all_psuedo_legal_moves) {
+    static_assert(!(caps_only && quiets_only), "one or the other, or neither");
     constexpr Color enemy = utility::representation::opposite_color_t<c>;
 
     // Intialize some class variables that are used in all the children called by this function
@@ -2631,12 +2669,12 @@ int Engine::get_psuedo_legal_moves_t(vector<Move>& all_psuedo_legal_moves) {
     all_pieces = (all_own_pieces | all_enemy_pieces);
 
     // Get all the psuedo legal moves.
-    add_knight_moves_to_vector_t<c, caps_only>(all_psuedo_legal_moves);
-    add_bishop_moves_to_vector_t<c, caps_only>(all_psuedo_legal_moves);
-    add_pawn_moves_to_vector_t<c, caps_only>(all_psuedo_legal_moves);
-    add_queen_moves_to_vector_t<c, caps_only>(all_psuedo_legal_moves);
-    add_king_moves_to_vector_t<c, caps_only>(all_psuedo_legal_moves);
-    add_rook_moves_to_vector_t<c, caps_only>(all_psuedo_legal_moves);
+    add_knight_moves_to_vector_t<c, caps_only, quiets_only>(all_psuedo_legal_moves);
+    add_bishop_moves_to_vector_t<c, caps_only, quiets_only>(all_psuedo_legal_moves);
+    add_pawn_moves_to_vector_t<c, caps_only, quiets_only>(all_psuedo_legal_moves);
+    add_queen_moves_to_vector_t<c, caps_only, quiets_only>(all_psuedo_legal_moves);
+    add_king_moves_to_vector_t<c, caps_only, quiets_only>(all_psuedo_legal_moves);
+    add_rook_moves_to_vector_t<c, caps_only, quiets_only>(all_psuedo_legal_moves);
 
     assert(all_psuedo_legal_moves.size() <= INT_MAX);
     return static_cast<int>(all_psuedo_legal_moves.size());
@@ -2752,23 +2790,19 @@ Engine::PinnedInfo Engine::compute_pins_t() {
     const ull enemyStraight = themQueens | themRooks;
     const ull enemyDiag     = themQueens | themBishops;
 
-    process_pin_ray(this, info, kingSq, occ, myPieces, enemyStraight, enemyDiag,
-                    north_square_ray.data(), true,  true);
-    process_pin_ray(this, info, kingSq, occ, myPieces, enemyStraight, enemyDiag,
-                    south_square_ray.data(), false, true);
-    process_pin_ray(this, info, kingSq, occ, myPieces, enemyStraight, enemyDiag,
-                    west_square_ray.data(),  true,  true);
-    process_pin_ray(this, info, kingSq, occ, myPieces, enemyStraight, enemyDiag,
-                    east_square_ray.data(),  false, true);
-
-    process_pin_ray(this, info, kingSq, occ, myPieces, enemyStraight, enemyDiag,
-                    north_east_square_ray.data(), true,  false);
-    process_pin_ray(this, info, kingSq, occ, myPieces, enemyStraight, enemyDiag,
-                    north_west_square_ray.data(), true,  false);
-    process_pin_ray(this, info, kingSq, occ, myPieces, enemyStraight, enemyDiag,
-                    south_east_square_ray.data(), false, false);
-    process_pin_ray(this, info, kingSq, occ, myPieces, enemyStraight, enemyDiag,
-                    south_west_square_ray.data(), false, false);
+    info.kingSq = kingSq;
+
+    // Enemy sliders that would see the king on an empty board. With exactly one piece
+    // between, and that piece mine, it is pinned.
+    ull snipers = (get_straight_attacks_mbb(0ULL, kingSq) & enemyStraight)
+                | (get_diagonal_attacks_mbb(0ULL, kingSq) & enemyDiag);
+    while (snipers) {
+        const int sniperSq = utility::bit::lsb_and_pop_to_square(snipers);
+        const ull between = tables::movegen::between_bb[kingSq][sniperSq] & occ;
+        if (between && !(between & (between - 1)) && (between & myPieces)) {
+            info.pinnedMask |= between;
+        }
+    }
 
     return info;
 }
@@ -2880,8 +2914,11 @@ Engine::CheckInfo Engine::find_checkers_and_blockmask_t() {
 
     info.captureMask = info.checkerBB;
     const int checkerSq = utility::bit::bitboard_to_lowest_square_fast(info.checkerBB);
-    info.blockMask = squares_between_exclusive(kingSq, checkerSq);
+    info.blockMask = tables::movegen::between_bb[kingSq][checkerSq];
     info.toHelpMask = info.captureMask | info.blockMask;
+    if (info.checkerBB & (deadly_straights | deadly_diags)) {
+        info.kingLineMask = tables::movegen::line_bb[kingSq][checkerSq] & ~info.checkerBB;
+    }
     return info;
 }
 
@@ -2945,7 +2982,7 @@ bool Engine::in_check_after_king_move_t(const Move& move) {
 }
 
 // I am called only from python, through engine_communicator_get_legal_moves, when the game is over. I am wasteful.
-int Engine::get_legal_moves_fast(Color c, bool caps_only, bool b_check_mode, vector<Move>& MovesOut)
+int Engine::get_legal_moves_fast(Color c, bool caps_only, bool b_check_mode, MoveList& MovesOut)
 {
     if (c == Color::WHITE) {
         if (caps_only) return get_legal_moves_fast_t<Color::WHITE, true>(b_check_mode, MovesOut);
@@ -2956,14 +2993,23 @@ int Engine::get_legal_moves_fast(Color c, bool caps_only, bool b_check_mode, vec
     }
 }
 
+// Same, into a vector. For the Python module, the drivers and the tests (not the search).
+int Engine::get_legal_moves_fast(Color c, bool caps_only, bool b_check_mode, vector<Move>& MovesOut)
+{
+    MoveList moves;
+    const int n_leg_moves_found = get_legal_moves_fast(c, caps_only, b_check_mode, moves);
+    MovesOut.assign(moves.begin(), moves.end());
+    return n_leg_moves_found;
+}
+
 // I am the main one called.
 // in "check mode" it is only trying to decide wether its REALLY 0 moves or not. 
 // So it returns if it finds just one move.
-template<Color c, bool caps_only>
-int Engine::get_legal_moves_fast_t(bool b_check_mode, vector<Move>& MovesOut) {
+template<Color c, bool caps_only, bool quiets_only>
+int Engine::get_legal_moves_fast_t(bool b_check_mode, MoveList& MovesOut) {
 
+    assert(&MovesOut != &psuedo_legal_moves);
     psuedo_legal_moves.clear();
-    assert(psuedo_legal_moves.capacity() == MAX_MOVES);
 
     MovesOut.clear();           // Clear the output
 
@@ -2989,7 +3035,7 @@ int Engine::get_legal_moves_fast_t(bool b_check_mode, vector<Move>& MovesOut) {
 
     ///////////////////////////////////////////////////////////
 
-    n_psuedo_legal_moves_found = get_psuedo_legal_moves_t<c, caps_only>(psuedo_legal_moves);
+    n_psuedo_legal_moves_found = get_psuedo_legal_moves_t<c, caps_only, quiets_only>(psuedo_legal_moves);
 
     if (!in_check_before_move) {
         for (const Move& move : psuedo_legal_moves) {
@@ -3040,7 +3086,10 @@ int Engine::get_legal_moves_fast_t(bool b_check_mode, vector<Move>& MovesOut) {
                 }
             } else {
                 if (move.piece_type == Piece::KING) {
-                    legal = !in_check_after_king_move_t<c>(move);
+                    // Backing away along the checking line is never legal
+                    if (!(checkInfo.kingLineMask & utility::bit::square_to_bitboard(move.toSQ))) {
+                        legal = !in_check_after_king_move_t<c>(move);
+                    }
                 } else {
 
                     const int fromSq = move.fromSQ;
@@ -3102,7 +3151,7 @@ int Engine::get_legal_moves_fast_t(bool b_check_mode, vector<Move>& MovesOut) {
 
 bool Engine::is_legal_move(const Move& mv) {
 
-    vector<Move> moves;
+    MoveList moves;
     int iLegalMoves;
     if (game_board.turn == Color::WHITE) iLegalMoves = get_legal_moves_fast_t<Color::WHITE, false>(false, moves);
     else                                 iLegalMoves = get_legal_moves_fast_t<Color::BLACK, false>(false, moves);
@@ -3115,52 +3164,236 @@ bool Engine::is_legal_move(const Move& mv) {
 }
 
 
+//
+// The TT keeps only from/to/promotion of a move. Rebuilds the rest of the Move (piece, capture, flags,
+// en passant landing square) from the board, as the generator would. Returns an empty move (piece_type NONE)
+// if the side to move has no piece on fromSQ. The move may still be nonsense: check it with is_pseudo_legal().
+Move Engine::complete_move(Square fromSQ, Square toSQ, Piece promotion) {
+
+    Move m = {};
+    if ((fromSQ >= NO_SQUARE) || (toSQ >= NO_SQUARE)) return m;
+
+    const Color c = game_board.turn;
+    const ull from_bb = utility::bit::square_to_bitboard(fromSQ);
+    const ull to_bb   = utility::bit::square_to_bitboard(toSQ);
+
+    const Piece piece = game_board.get_piece_type_on_bitboard(c, from_bb);
+    if (piece == Piece::NONE) return m;
+
+    m.fromSQ = fromSQ;
+    m.toSQ = toSQ;
+    m.color = c;
+    m.piece_type = piece;
+    m.promotion = promotion;
+    m.capture = game_board.get_piece_type_on_bitboard(utility::representation::opposite_color(c), to_bb);
+    m.flags = (game_board.black_castle_touch[fromSQ] & game_board.black_castle_touch[toSQ]) << 2
+            | (game_board.white_castle_touch[fromSQ] & game_board.white_castle_touch[toSQ]);
+
+    const int distance = std::abs((int)toSQ - (int)fromSQ);
+    if (piece == Piece::PAWN) {
+        if ((m.capture == Piece::NONE) && (to_bb & game_board.en_passant_landing_bb) && (distance != 8)) {
+            m.capture = Piece::PAWN;
+            m.flags |= FLAGS_IS_EP_CAPTURE;
+        } else if (distance == 16) {
+            m.en_passant_landingSQ = (Square)((fromSQ + toSQ) / 2);
+        }
+    } else if ((piece == Piece::KING) && (distance == 2)) {
+        m.flags |= FLAGS_IS_CASTLE_MOVE;
+    }
+
+    return m;
+}
+
+
+bool Engine::is_pseudo_legal(const Move& m) {
+    if (game_board.turn == Color::WHITE) return is_pseudo_legal_t<Color::WHITE>(m);
+    else                                 return is_pseudo_legal_t<Color::BLACK>(m);
+}
+
+//
+// Is this the move the generator would make (get_psuedo_legal_moves_t()) in this position? Every field is
+// checked, not just from/to/promotion, so a killer or hash move from another position is safe to push if true.
+// Does not say whether the move leaves the king in check. See is_legal_move_fast().
+template<Color c>
+bool Engine::is_pseudo_legal_t(const Move& m) {
+
+    constexpr Color enemy = utility::representation::opposite_color_t<c>;
+
+    if ((m.color != c) || (m.piece_type == Piece::NONE)) return false;
+    if ((m.fromSQ >= NO_SQUARE) || (m.toSQ >= NO_SQUARE)) return false;
+
+    const ull from_bb = utility::bit::square_to_bitboard(m.fromSQ);
+    const ull to_bb   = utility::bit::square_to_bitboard(m.toSQ);
+
+    const ull own_pieces   = game_board.get_pieces_template<c>();
+    const ull enemy_pieces = game_board.get_pieces_template<enemy>();
+    const ull occ          = own_pieces | enemy_pieces;
+
+    if (!(access_pieces_of_color_tp<c>(m.piece_type) & from_bb)) return false;
+    if (to_bb & own_pieces) return false;
+
+    // The castling bits of the flags depend only on the two squares.
+    const uint8_t castle_bits = (game_board.black_castle_touch[m.fromSQ] & game_board.black_castle_touch[m.toSQ]) << 2
+                              | (game_board.white_castle_touch[m.fromSQ] & game_board.white_castle_touch[m.toSQ]);
+    if ((m.flags & FLAGS_CASTLE_ALL_BITS) != castle_bits) return false;
+
+    // The capture must be what is really there
+    const bool is_ep = (m.flags & FLAGS_IS_EP_CAPTURE);
+    if (is_ep) {
+        if ((m.piece_type != Piece::PAWN) || (m.capture != Piece::PAWN)) return false;
+        if (to_bb != game_board.en_passant_landing_bb) return false;
+    } else {
+        if (game_board.get_piece_type_on_bitboard_template<enemy>(to_bb) != m.capture) return false;
+        if (m.capture == Piece::KING) return false;
+    }
+
+    // Castling is rare. Let the generator decide (rights, empty squares, squares not attacked).
+    if (m.flags & FLAGS_IS_CASTLE_MOVE) {
+        if (m.piece_type != Piece::KING) return false;
+
+        all_enemy_pieces = enemy_pieces;        // the generators use these
+        all_own_pieces = own_pieces;
+        all_pieces = occ;
+
+        psuedo_legal_moves.clear();
+        add_king_moves_to_vector_t<c, false, true>(psuedo_legal_moves);
+        for (const Move& mv : psuedo_legal_moves) {
+            if ((mv == m) && (mv.flags & FLAGS_IS_CASTLE_MOVE)) return true;
+        }
+        return false;
+    }
+
+    // A promotion exactly when a pawn reaches the last rank
+    const ull last_rank = (c == Color::WHITE) ? row_masks[Row::ROW_8] : row_masks[Row::ROW_1];
+    const bool reaches_last_rank = (m.piece_type == Piece::PAWN) && (to_bb & last_rank);
+    if (reaches_last_rank) {
+        if ((m.promotion == Piece::NONE) || (m.promotion == Piece::PAWN) || (m.promotion == Piece::KING)) return false;
+    } else {
+        if (m.promotion != Piece::NONE) return false;
+    }
+
+    ull reachable = 0ULL;
+    switch (m.piece_type) {
+        case Piece::KNIGHT:
+            reachable = tables::movegen::knight_attack_table[m.fromSQ];
+            break;
+        case Piece::KING:
+            reachable = tables::movegen::king_attack_table[m.fromSQ];
+            break;
+        case Piece::BISHOP:
+            reachable = get_diagonal_attacks_mbb(occ & ~from_bb, m.fromSQ);
+            break;
+        case Piece::ROOK:
+            reachable = get_straight_attacks_mbb(occ & ~from_bb, m.fromSQ);
+            break;
+        case Piece::QUEEN:
+            reachable = get_diagonal_attacks_mbb(occ & ~from_bb, m.fromSQ)
+                      | get_straight_attacks_mbb(occ & ~from_bb, m.fromSQ);
+            break;
+        case Piece::PAWN: {
+            ull attacks, one_forward, two_forward, start_rank;
+            if constexpr (c == Color::WHITE) {
+                attacks     = tables::movegen::white_pawn_attack_table[m.fromSQ];
+                one_forward = tables::movegen::white_pawn_adv_table[m.fromSQ];
+                two_forward = tables::movegen::white_pawn_double_adv_table[m.fromSQ];
+                start_rank  = row_masks[Row::ROW_2];
+            } else {
+                attacks     = tables::movegen::black_pawn_attack_table[m.fromSQ];
+                one_forward = tables::movegen::black_pawn_adv_table[m.fromSQ];
+                two_forward = tables::movegen::black_pawn_double_adv_table[m.fromSQ];
+                start_rank  = row_masks[Row::ROW_7];
+            }
+
+            if (m.capture != Piece::NONE) {
+                return (attacks & to_bb) && (m.en_passant_landingSQ == NO_SQUARE);
+            }
+            if (to_bb & occ) return false;
+            if (one_forward == to_bb) {
+                return (m.en_passant_landingSQ == NO_SQUARE);
+            }
+            if ((from_bb & start_rank) && (two_forward == to_bb) && !(one_forward & occ)) {
+                return (m.en_passant_landingSQ == utility::bit::bitboard_to_lowest_square(one_forward));
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+
+    return (reachable & to_bb) && (m.en_passant_landingSQ == NO_SQUARE);
+}
+
+//
+// Legal, without generating the moves.
+bool Engine::is_legal_move_fast(const Move& m) {
+    if (game_board.turn == Color::WHITE) {
+        return is_pseudo_legal_t<Color::WHITE>(m) && !in_check_after_move_fast_t<Color::WHITE, true>(m);
+    } else {
+        return is_pseudo_legal_t<Color::BLACK>(m) && !in_check_after_move_fast_t<Color::BLACK, true>(m);
+    }
+}
+
+
 
 
 
 
 // Explicit template instantiations
-template void Engine::add_psuedo_move_to_vector<Color::WHITE, false, false, false, false>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::WHITE, false, false, false, true>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::WHITE, false, true, false, false>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::WHITE, true, false, false, false>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::WHITE, true, false, true, false>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::WHITE, true, true, false, false>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::BLACK, false, false, false, false>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::BLACK, false, false, false, true>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::BLACK, false, true, false, false>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::BLACK, true, false, false, false>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::BLACK, true, false, true, false>(vector<Move>&, Square, ull, Piece, Square);
-template void Engine::add_psuedo_move_to_vector<Color::BLACK, true, true, false, false>(vector<Move>&, Square, ull, Piece, Square);
-
-template void Engine::add_pawn_moves_to_vector_t<Color::WHITE, false>(vector<Move>&);
-template void Engine::add_pawn_moves_to_vector_t<Color::WHITE, true>(vector<Move>&);
-template void Engine::add_pawn_moves_to_vector_t<Color::BLACK, false>(vector<Move>&);
-template void Engine::add_pawn_moves_to_vector_t<Color::BLACK, true>(vector<Move>&);
-template void Engine::add_knight_moves_to_vector_t<Color::WHITE, false>(vector<Move>&);
-template void Engine::add_knight_moves_to_vector_t<Color::WHITE, true>(vector<Move>&);
-template void Engine::add_knight_moves_to_vector_t<Color::BLACK, false>(vector<Move>&);
-template void Engine::add_knight_moves_to_vector_t<Color::BLACK, true>(vector<Move>&);
-template void Engine::add_bishop_moves_to_vector_t<Color::WHITE, false>(vector<Move>&);
-template void Engine::add_bishop_moves_to_vector_t<Color::WHITE, true>(vector<Move>&);
-template void Engine::add_bishop_moves_to_vector_t<Color::BLACK, false>(vector<Move>&);
-template void Engine::add_bishop_moves_to_vector_t<Color::BLACK, true>(vector<Move>&);
-template void Engine::add_rook_moves_to_vector_t<Color::WHITE, false>(vector<Move>&);
-template void Engine::add_rook_moves_to_vector_t<Color::WHITE, true>(vector<Move>&);
-template void Engine::add_rook_moves_to_vector_t<Color::BLACK, false>(vector<Move>&);
-template void Engine::add_rook_moves_to_vector_t<Color::BLACK, true>(vector<Move>&);
-template void Engine::add_queen_moves_to_vector_t<Color::WHITE, false>(vector<Move>&);
-template void Engine::add_queen_moves_to_vector_t<Color::WHITE, true>(vector<Move>&);
-template void Engine::add_queen_moves_to_vector_t<Color::BLACK, false>(vector<Move>&);
-template void Engine::add_queen_moves_to_vector_t<Color::BLACK, true>(vector<Move>&);
-template void Engine::add_king_moves_to_vector_t<Color::WHITE, false>(vector<Move>&);
-template void Engine::add_king_moves_to_vector_t<Color::WHITE, true>(vector<Move>&);
-template void Engine::add_king_moves_to_vector_t<Color::BLACK, false>(vector<Move>&);
-template void Engine::add_king_moves_to_vector_t<Color::BLACK, true>(vector<Move>&);
-template int Engine::get_psuedo_legal_moves_t<Color::WHITE, false>(vector<Move>&);
-template int Engine::get_psuedo_legal_moves_t<Color::WHITE, true>(vector<Move>&);
-template int Engine::get_psuedo_legal_moves_t<Color::BLACK, false>(vector<Move>&);
-template int Engine::get_psuedo_legal_moves_t<Color::BLACK, true>(vector<Move>&);
+template void Engine::add_psuedo_move_to_vector<Color::WHITE, false, false, false, false>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::WHITE, false, false, false, true>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::WHITE, false, true, false, false>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::WHITE, true, false, false, false>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::WHITE, true, false, true, false>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::WHITE, true, true, false, false>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::BLACK, false, false, false, false>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::BLACK, false, false, false, true>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::BLACK, false, true, false, false>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::BLACK, true, false, false, false>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::BLACK, true, false, true, false>(MoveList&, Square, ull, Piece, Square);
+template void Engine::add_psuedo_move_to_vector<Color::BLACK, true, true, false, false>(MoveList&, Square, ull, Piece, Square);
+
+template void Engine::add_pawn_moves_to_vector_t<Color::WHITE, false>(MoveList&);
+template void Engine::add_pawn_moves_to_vector_t<Color::WHITE, true>(MoveList&);
+template void Engine::add_pawn_moves_to_vector_t<Color::WHITE, false, true>(MoveList&);
+template void Engine::add_pawn_moves_to_vector_t<Color::BLACK, false>(MoveList&);
+template void Engine::add_pawn_moves_to_vector_t<Color::BLACK, true>(MoveList&);
+template void Engine::add_pawn_moves_to_vector_t<Color::BLACK, false, true>(MoveList&);
+template void Engine::add_knight_moves_to_vector_t<Color::WHITE, false>(MoveList&);
+template void Engine::add_knight_moves_to_vector_t<Color::WHITE, true>(MoveList&);
+template void Engine::add_knight_moves_to_vector_t<Color::WHITE, false, true>(MoveList&);
+template void Engine::add_knight_moves_to_vector_t<Color::BLACK, false>(MoveList&);
+template void Engine::add_knight_moves_to_vector_t<Color::BLACK, true>(MoveList&);
+template void Engine::add_knight_moves_to_vector_t<Color::BLACK, false, true>(MoveList&);
+template void Engine::add_bishop_moves_to_vector_t<Color::WHITE, false>(MoveList&);
+template void Engine::add_bishop_moves_to_vector_t<Color::WHITE, true>(MoveList&);
+template void Engine::add_bishop_moves_to_vector_t<Color::WHITE, false, true>(MoveList&);
+template void Engine::add_bishop_moves_to_vector_t<Color::BLACK, false>(MoveList&);
+template void Engine::add_bishop_moves_to_vector_t<Color::BLACK, true>(MoveList&);
+template void Engine::add_bishop_moves_to_vector_t<Color::BLACK, false, true>(MoveList&);
+template void Engine::add_rook_moves_to_vector_t<Color::WHITE, false>(MoveList&);
+template void Engine::add_rook_moves_to_vector_t<Color::WHITE, true>(MoveList&);
+template void Engine::add_rook_moves_to_vector_t<Color::WHITE, false, true>(MoveList&);
+template void Engine::add_rook_moves_to_vector_t<Color::BLACK, false>(MoveList&);
+template void Engine::add_rook_moves_to_vector_t<Color::BLACK, true>(MoveList&);
+template void Engine::add_rook_moves_to_vector_t<Color::BLACK, false, true>(MoveList&);
+template void Engine::add_queen_moves_to_vector_t<Color::WHITE, false>(MoveList&);
+template void Engine::add_queen_moves_to_vector_t<Color::WHITE, true>(MoveList&);
+template void Engine::add_queen_moves_to_vector_t<Color::WHITE, false, true>(MoveList&);
+template void Engine::add_queen_moves_to_vector_t<Color::BLACK, false>(MoveList&);
+template void Engine::add_queen_moves_to_vector_t<Color::BLACK, true>(MoveList&);
+template void Engine::add_queen_moves_to_vector_t<Color::BLACK, false, true>(MoveList&);
+template void Engine::add_king_moves_to_vector_t<Color::WHITE, false>(MoveList&);
+template void Engine::add_king_moves_to_vector_t<Color::WHITE, true>(MoveList&);
+template void Engine::add_king_moves_to_vector_t<Color::WHITE, false, true>(MoveList&);
+template void Engine::add_king_moves_to_vector_t<Color::BLACK, false>(MoveList&);
+template void Engine::add_king_moves_to_vector_t<Color::BLACK, true>(MoveList&);
+template void Engine::add_king_moves_to_vector_t<Color::BLACK, false, true>(MoveList&);
+template int Engine::get_psuedo_legal_moves_t<Color::WHITE, false>(MoveList&);
+template int Engine::get_psuedo_legal_moves_t<Color::WHITE, true>(MoveList&);
+template int Engine::get_psuedo_legal_moves_t<Color::WHITE, false, true>(MoveList&);
+template int Engine::get_psuedo_legal_moves_t<Color::BLACK, false>(MoveList&);
+template int Engine::get_psuedo_legal_moves_t<Color::BLACK, true>(MoveList&);
+template int Engine::get_psuedo_legal_moves_t<Color::BLACK, false, true>(MoveList&);
 
 template bool Engine::is_king_in_check_t<Color::WHITE>();
 template bool Engine::is_king_in_check_t<Color::BLACK>();
@@ -3180,13 +3413,21 @@ template bool Engine::in_check_after_move_fast_t<Color::WHITE, false>(const Move
 template bool Engine::in_check_after_move_fast_t<Color::BLACK, false>(const Move&);
 template bool Engine::in_check_after_king_move_t<Color::WHITE>(const Move&);
 template bool Engine::in_check_after_king_move_t<Color::BLACK>(const Move&);
-template int Engine::get_legal_moves_fast_t<Color::WHITE, false>(bool b_check_mode, vector<Move>&);
-template int Engine::get_legal_moves_fast_t<Color::WHITE, true>(bool b_check_mode, vector<Move>&);
-template int Engine::get_legal_moves_fast_t<Color::BLACK, false>(bool b_check_mode, vector<Move>&);
-template int Engine::get_legal_moves_fast_t<Color::BLACK, true>(bool b_check_mode, vector<Move>&);
+template int Engine::get_legal_moves_fast_t<Color::WHITE, false>(bool b_check_mode, MoveList&);
+template int Engine::get_legal_moves_fast_t<Color::WHITE, true>(bool b_check_mode, MoveList&);
+template int Engine::get_legal_moves_fast_t<Color::WHITE, false, true>(bool b_check_mode, MoveList&);
+template int Engine::get_legal_moves_fast_t<Color::BLACK, false>(bool b_check_mode, MoveList&);
+template int Engine::get_legal_moves_fast_t<Color::BLACK, true>(bool b_check_mode, MoveList&);
+template int Engine::get_legal_moves_fast_t<Color::BLACK, false, true>(bool b_check_mode, MoveList&);
 template void Engine::pushMove_t<Color::WHITE>(const Move&);
 template void Engine::pushMove_t<Color::BLACK>(const Move&);
 template void Engine::popMove_t<Color::WHITE>();
 template void Engine::popMove_t<Color::BLACK>();  
+template void Engine::pushNullMove_t<Color::WHITE>();
+template void Engine::pushNullMove_t<Color::BLACK>();
+template void Engine::popNullMove_t<Color::WHITE>();
+template void Engine::popNullMove_t<Color::BLACK>();
+template bool Engine::is_pseudo_legal_t<Color::WHITE>(const Move&);
+template bool Engine::is_pseudo_legal_t<Color::BLACK>(const Move&);
 
 } // end namespace ShumiChess
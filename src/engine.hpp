@@ -4,16 +4,17 @@
 #include <climits>
 #include <cstring>
 #include <iostream>
-#include <stack>
 #include <vector>
 #include <chrono>
 
 #include "globals.hpp"
 #include "gameboard.hpp"
 #include "move_tables.hpp"
+#include "move_list.hpp"
 #include "utility.hpp"
 
 #include "endgameTables.hpp"
+#include "nnue.hpp"
 
 
 using namespace std;
@@ -29,8 +30,6 @@ using MoveAndScoreList = std::vector<MoveAndScore>;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
-inline constexpr int MAX_MOVES = 256;
-
 inline constexpr std::size_t _MAX_ALGEBRIAC_SIZE = 16;
 inline constexpr std::size_t _MAX_MOVE_PLUS_SCORE_SIZE = _MAX_ALGEBRIAC_SIZE + 32;
 
@@ -54,6 +53,23 @@ namespace ShumiChess {
 class Engine;
 
 
+//
+// Everything popMove_t() needs to undo one pushMove_t() (or popNullMove_t() one pushNullMove_t()).
+// One record per ply, in Engine::undo_stack.
+struct UndoState {
+    Move move;                      // piece_type is NONE for a null move
+    uint8_t castle_rights;
+    Square white_king_square;
+    Square black_king_square;
+    int halfmove;
+    ull en_passant_landing_bb;
+    ull zobrist_key;
+    ull pawn_zobrist_key;
+};
+
+inline constexpr int MAX_UNDO = 1024;      // Initial size of the undo stack (it grows, if a game gets longer)
+
+
 class PGN {
     public:
         PGN();
@@ -71,17 +87,24 @@ class Engine {
         // Members
         GameBoard game_board;
 
-        // Stacks
-        std::stack<Move> move_history;
-        std::stack<int> halfway_move_state;
-        std::stack<ull> en_passant_history;
         Square white_king_square = NO_SQUARE;
         Square black_king_square = NO_SQUARE;
-        std::stack<Square> white_king_square_history;
-        std::stack<Square> black_king_square_history;
 
-        //TODO This way of tracking is inconsistent with gameboard, think over. Requires splitting and merging of  castle_opportunity_
-        std::stack<uint8_t> castle_opportunity_history; // Bits right to left: white kingside, white queenside, black kingside, black queenside
+        // Undo stack. undo_stack[0 .. n_undo-1] are the pushed moves (oldest first). Sized by reserve_storage_buffers().
+        std::vector<UndoState> undo_stack;
+        int n_undo = 0;
+
+        void clear_move_history() { n_undo = 0; }
+        int move_history_size() const { return n_undo; }
+        const Move* last_move() const;                  // The last (non null) move pushed, or nullptr
+        std::vector<Move> move_history_to_vector() const;   // oldest first, null moves left out
+        UndoState& push_undo_state();
+
+        // NNUE accumulators, one per ply: nnue_stack[i] is for the position after undo_stack[0 .. i-1]. Only
+        // used (and sized) by nnue_evaluate(). pushMove_t()/popMove_t() leave it alone, the moves on the undo
+        // stack say what changed.
+        std::vector<nnue::Accumulator> nnue_stack;
+        int nnue_evaluate();                            // Centipawns, for the side to move
     
         // Constructors
         //? Should the engine be tied to a single boardstate
@@ -93,9 +116,12 @@ class Engine {
         // Member methods
         void reset_engine();                // New game
         void reset_engine(const string&);   // new game (with FEN)
+        void reserve_storage_buffers();     // Needed after copying an Engine
 
         template<Color c> void pushMove_t(const Move&);
         template<Color c> void popMove_t();
+        template<Color c> void pushNullMove_t();   // Passes the turn (null move pruning)
+        template<Color c> void popNullMove_t();
 
         GameState is_game_over();
         GameState is_game_over(int nLegMovesFound);
@@ -108,28 +134,37 @@ class Engine {
         template <Piece P, Color c> ull& access_pieces_of_color_tp();
 
         template<Color c, bool capture, bool promotion, bool is_en_passent_cap, bool is_castle> 
-        	void add_psuedo_move_to_vector(vector<Move>&, Square fromSQ, ull, Piece, Square en_passant_land_sq);
+        	void add_psuedo_move_to_vector(MoveList&, Square fromSQ, ull, Piece, Square en_passant_land_sq);
 
-        template<Color c, bool caps_only> int get_legal_moves_fast_t(bool b_check_mode, vector<Move>& MovesOut);
-        int get_legal_moves_fast(Color c, bool caps_only, bool b_check_mode, vector<Move>& MovesOut);       
+        // caps_only: only unquiet moves (captures and promotions). quiets_only: only the rest.
+        template<Color c, bool caps_only, bool quiets_only = false> int get_legal_moves_fast_t(bool b_check_mode, MoveList& MovesOut);
+        int get_legal_moves_fast(Color c, bool caps_only, bool b_check_mode, MoveList& MovesOut);       
+        int get_legal_moves_fast(Color c, bool caps_only, bool b_check_mode, vector<Move>& MovesOut);   // adapter (Python, drivers, tests)
        
         bool assert_same_moves(const std::vector<Move>& a,
                                 const std::vector<Move>& b);
 
-        template<Color c, bool caps_only> int get_psuedo_legal_moves_t(vector<Move>& all_psuedo_legal_moves);
+        template<Color c, bool caps_only, bool quiets_only = false> int get_psuedo_legal_moves_t(MoveList& all_psuedo_legal_moves);
 
 
         bool is_legal_move(const Move& m);
 
+        // Checking a single move, without generating the moves. (Killers and hash moves, from other positions)
+        Move complete_move(Square fromSQ, Square toSQ, Piece promotion);   // Fills in piece, capture and flags from the board
+        bool is_pseudo_legal(const Move& m);                                // Exactly as the generator would make it here
+        template<Color c> bool is_pseudo_legal_t(const Move& m);
+        bool is_legal_move_fast(const Move& m);                             // is_pseudo_legal(), and does not leave the king in check
+
         // int material_balanceW_cp;        // always positive
         // int material_balanceB_cp;        // always positive
 
         // Storage buffers (they live here to avoid extra allocation during the game)        
-        vector<Move> psuedo_legal_moves; 
+        MoveList psuedo_legal_moves; 
         
         #define MAX_PLY0 100            // Maximum ply the engine will ever see, ahead from this move
-        vector<Move> all_legal_moves[MAX_PLY0];
-        vector<Move> all_unquiet_moves[MAX_PLY0];   
+        // One list per ply. On the heap (MAX_PLY0 lists are too big for the stack), sized by reserve_storage_buffers().
+        vector<MoveList> all_legal_moves;
+        vector<MoveList> all_unquiet_moves;   
 
         template<Color c, bool isMyKing> bool in_check_after_move_fast_t(const Move& move);
         template<Color c> bool in_check_after_king_move_t(const Move& move);
@@ -170,58 +205,17 @@ class Engine {
             const ull themQueens, const ull themRooks, const ull themBishops);
 
 
-        template<Color c, bool caps_only> void add_pawn_moves_to_vector_t(vector<Move>&);
-        template<Color c, bool caps_only> void add_knight_moves_to_vector_t(vector<Move>&);
-        template<Color c, bool caps_only> void add_bishop_moves_to_vector_t(vector<Move>&);
-        template<Color c, bool caps_only> void add_rook_moves_to_vector_t(vector<Move>&);
-        template<Color c, bool caps_only> void add_queen_moves_to_vector_t(vector<Move>&);
-        template<Color c, bool caps_only> void add_king_moves_to_vector_t(vector<Move>&);
+        template<Color c, bool caps_only, bool quiets_only = false> void add_pawn_moves_to_vector_t(MoveList&);
+        template<Color c, bool caps_only, bool quiets_only = false> void add_knight_moves_to_vector_t(MoveList&);
+        template<Color c, bool caps_only, bool quiets_only = false> void add_bishop_moves_to_vector_t(MoveList&);
+        template<Color c, bool caps_only, bool quiets_only = false> void add_rook_moves_to_vector_t(MoveList&);
+        template<Color c, bool caps_only, bool quiets_only = false> void add_queen_moves_to_vector_t(MoveList&);
+        template<Color c, bool caps_only, bool quiets_only = false> void add_king_moves_to_vector_t(MoveList&);
 
         ull all_enemy_pieces;
         ull all_own_pieces;
         ull all_pieces; 
 
-        inline ull squares_between_exclusive(int kingSq, int checkerSq) const
-        {
-            // Returns squares strictly between kingSq and checkerSq if aligned (rank/file/diag),
-            // else returns 0.
-            // Uses your ray tables: north_square_ray[], etc.
-
-            const ull kingBB    = (1ULL << kingSq);
-            const ull checkerBB = (1ULL << checkerSq);
-
-            // Same file/rank:
-            if (north_square_ray[kingSq] & checkerBB) {
-                return north_square_ray[kingSq] & ~north_square_ray[checkerSq];
-            }
-            if (south_square_ray[kingSq] & checkerBB) {
-                return south_square_ray[kingSq] & ~south_square_ray[checkerSq];
-            }
-            if (east_square_ray[kingSq] & checkerBB) {
-                return east_square_ray[kingSq] & ~east_square_ray[checkerSq];
-            }
-            if (west_square_ray[kingSq] & checkerBB) {
-                return west_square_ray[kingSq] & ~west_square_ray[checkerSq];
-            }
-
-            // Diagonals:
-            if (north_east_square_ray[kingSq] & checkerBB) {
-                return north_east_square_ray[kingSq] & ~north_east_square_ray[checkerSq];
-            }
-            if (north_west_square_ray[kingSq] & checkerBB) {
-                return north_west_square_ray[kingSq] & ~north_west_square_ray[checkerSq];
-            }
-            if (south_east_square_ray[kingSq] & checkerBB) {
-                return south_east_square_ray[kingSq] & ~south_east_square_ray[checkerSq];
-            }
-            if (south_west_square_ray[kingSq] & checkerBB) {
-                return south_west_square_ray[kingSq] & ~south_west_square_ray[checkerSq];
-            }
-
-            (void)kingBB; // quiet unused warning if you remove some branches
-            return 0ULL;
-        }
-
         void move_into_string(ShumiChess::Move m);
         void move_into_string_full(ShumiChess::Move m);
         string moves_into_string(const std::vector<Move>& mvs);
@@ -233,7 +227,7 @@ class Engine {
                                     , GameState state 
                                     , bool isCheck
                                     , bool bPadTrailing
-                                    , const vector<ShumiChess::Move>* p_legal_moves   // from this position                                    
+                                    , const MoveList* p_legal_moves   // from this position                                    
                                     , std::string& MoveText) const;           // output
 
         char get_piece_char(Piece p) const;
@@ -253,7 +247,7 @@ class Engine {
       
         void print_bitboard_to_file(ull bb, FILE* fp);
 
-        inline bool has_unquiet_move(const vector<ShumiChess::Move>& moves) {
+        inline bool has_unquiet_move(const MoveList& moves) {
             bool bReturn = false;
             for (const ShumiChess::Move& mv : moves) {
                 if (is_unquiet_move(mv)) return true;
@@ -267,14 +261,14 @@ class Engine {
            return (mv.capture != ShumiChess::Piece::NONE || mv.promotion != ShumiChess::Piece::NONE); 
         }
 
-        void sort_unquiet_moves_qsearch_L(const vector<ShumiChess::Move>& moves,      // Input
-                                        vector<ShumiChess::Move>& MovesOut          // Output
+        void sort_unquiet_moves_qsearch_L(const MoveList& moves,      // Input
+                                        MoveList& MovesOut          // Output
                                         );
-        void sort_unquiet_moves_qsearch_H(const vector<ShumiChess::Move>& moves,      // Input
-                                        vector<ShumiChess::Move>& MovesOut          // Output
+        void sort_unquiet_moves_qsearch_H(const MoveList& moves,      // Input
+                                        MoveList& MovesOut          // Output
                                         );
-        void sort_check_evasions_qsearch(const vector<ShumiChess::Move>& moves,      // Input
-                                        vector<ShumiChess::Move>& MovesOut          // Output
+        void sort_check_evasions_qsearch(const MoveList& moves,      // Input
+                                        MoveList& MovesOut          // Output
                                         );
         Score d_bestScore_at_root = 0;       // in abs coordinates
         //
@@ -335,12 +329,11 @@ class Engine {
         struct PinnedInfo
         {
             ull pinnedMask;          // bit i = 1 => my piece on square i is pinned
-            ull allowedMask[64];     // for pinned square i: squares it may move to (including capture of pinner)
-                                     // for non-pinned squares: can be 0
+            int kingSq;              // A pinned piece may only move along the line through it and this king
+
             void clear() {
                 pinnedMask = 0ULL;
-                // for (int i = 0; i < 64; i++) allowedMask[i] = 0ULL;
-                memset(allowedMask, 0, sizeof(allowedMask));
+                kingSq = 0;
             }
 
             bool isPinned(int fromSq) const {
@@ -349,8 +342,8 @@ class Engine {
             }
 
             bool moveObeysPinLine(int fromSq, int toSq) const {
-                // Only valid if isPinned(fromSq) is true
-                return (allowedMask[fromSq] & (1ULL << toSq)) != 0ULL;
+                // Only valid if isPinned(fromSq) is true. The pinner and the king bound the moves along the line.
+                return tables::movegen::aligned(kingSq, fromSq, toSq);
             }
         };
 
@@ -361,6 +354,7 @@ class Engine {
             ull captureMask = 0ULL;   // squares that can capture checker (single check)
             ull blockMask   = 0ULL;   // squares that block slider check (single check)
             ull toHelpMask  = 0ULL;   // captureMask | blockMask
+            ull kingLineMask = 0ULL;  // the rest of a slider checker's line (single check). The king can't step onto it.
 
             bool toSquareHelps(int toSq) const
             {
@@ -385,7 +379,7 @@ class Engine {
 
         void print_move_history_to_buffer(char *out, size_t out_size);
         void print_move_history_to_file(FILE* fp, const char* psz);
-        void print_move_history_to_file0(FILE* fp, std::stack<ShumiChess::Move> tmp);
+        void print_move_history_to_file0(FILE* fp, const std::vector<ShumiChess::Move>& seq);
 
         void print_move_to_file(const ShumiChess::Move m, int nPly, ShumiChess::GameState gs
                             , bool isInCheck, bool bFormated, bool bFlipColor
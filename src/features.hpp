@@ -6,5 +6,10 @@
 #define _FEATURE_UNQUIET_SORT   0x8
 #define _FEATURE_TT             0x10
 #define _FEATURE_FUTILITY_PRUNE    0x20
+#define _FEATURE_NULL_MOVE      0x40
+#define _FEATURE_LMR            0x80
+#define _FEATURE_HISTORY        0x100  // history + countermove quiet ordering. Requires _FEATURE_UNQUIET_SORT.
+#define _FEATURE_STAGED_MOVEGEN 0x200  // MovePicker generates lazily (not at the root)
+#define _FEATURE_LAZY_EVAL      0x400  // qsearch stand-pat skips the positional terms when material is far outside the window
 
-#define _DEFAULT_FEATURES_MASK  (_FEATURE_TT2 | _FEATURE_KILLER | _FEATURE_UNQUIET_SORT)
\ No newline at end of file
+#define _DEFAULT_FEATURES_MASK  (_FEATURE_TT2 | _FEATURE_KILLER | _FEATURE_UNQUIET_SORT | _FEATURE_LAZY_EVAL)
\ No newline at end of file
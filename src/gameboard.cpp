@@ -182,8 +182,6 @@ GameBoard::GameBoard(const std::string& fen_notation) {
     auto us  = duration_cast<microseconds>(now).count();
     rng.seed(static_cast<unsigned>(us));
 
-    // !TODO doesn't belong here i don't think. I think it does.
-    ShumiChess::initialize_zobrist();
     set_zobrist();
     
     // Fills out the "chessboard" like view of the board
@@ -195,7 +193,8 @@ GameBoard::GameBoard(const std::string& fen_notation) {
 
     set_development_start_masks();      // Starting positions of knights and bishops
 
-    compute_bits_in();
+    init_psq_table();                   // Needs the weights
+    set_material_and_psq();
 
 }
 
@@ -227,6 +226,78 @@ void GameBoard::set_zobrist() {
         zobrist_key ^= zobrist_side;
     }
 }
+
+//
+// The piece-square terms. Each was a loop over the pieces in the eval, now one table entry per piece,
+// summed as the pieces move.
+//      Knight on the edge:  every phase, doubled in a corner.
+//      King to the center:  ENDGAME and later. By Manhattan distance from the d4,e4,d5,e5 box (0..6).
+void GameBoard::init_psq_table() {
+    for (int p = 0; p < NUM_PIECES; p++) {
+        for (int sq = 0; sq < 64; sq++) psq_table[p][sq] = PsqScore{};
+    }
+
+    for (int sq = 0; sq < 64; sq++) {
+        const int f = sq & 7;
+        const int r = sq >> 3;
+
+        int knight_cp = 0;
+        if ((f==0) || (f==7)) knight_cp += wghts.GetWeight(KNIGHT_ON_EDGE);
+        if ((r==0) || (r==7)) knight_cp += wghts.GetWeight(KNIGHT_ON_EDGE);
+        psq_table[Piece::KNIGHT][sq] = PsqScore{knight_cp, knight_cp};
+
+        const int dx = (f < 3) ? (3 - f) : (f > 4 ? f - 4 : 0);
+        const int dy = (r < 3) ? (3 - r) : (r > 4 ? r - 4 : 0);
+        psq_table[Piece::KING][sq].eg = (6 - (dx + dy)) * wghts.GetWeight(KING_CENTER_LATE);
+    }
+}
+
+void GameBoard::set_material_and_psq() {
+    material_key = 0;
+
+    for (int color_int = 0; color_int < 2; color_int++) {
+        Color color = static_cast<Color>(color_int);
+
+        material_cp[color] = 0;
+        psq[color] = PsqScore{};
+
+        for (int j = 0; j < 6; j++) {
+            Piece piece_type = static_cast<Piece>(j);
+            ull bitboard = get_pieces(color, piece_type);
+
+            Bits_In[color][piece_type] = (uint8_t)bits_in(bitboard);
+            material_cp[color] += Bits_In[color][piece_type] * centipawn_score_of(piece_type);
+            for (int n = 0; n < Bits_In[color][piece_type]; n++) {
+                material_key ^= zobrist_material[piece_type + color * 6][n];
+            }
+
+            while (bitboard) {
+                Square square = utility::bit::lsb_and_pop_to_square(bitboard);
+                psq[color] += psq_table[piece_type][square];
+            }
+        }
+    }
+}
+
+//
+// Debug. Compares the incrementally kept counts, material and piece-square score to set_material_and_psq().
+bool GameBoard::material_and_psq_are_valid() const {
+    GameBoard scratch = *this;
+    scratch.set_material_and_psq();
+
+    if (scratch.material_key != material_key) return false;
+
+    for (int color = 0; color < 2; color++) {
+        if (scratch.material_cp[color] != material_cp[color]) return false;
+        if (scratch.psq[color].mg != psq[color].mg) return false;
+        if (scratch.psq[color].eg != psq[color].eg) return false;
+        for (int j = 0; j < 6; j++) {
+            if (scratch.Bits_In[color][j] != Bits_In[color][j]) return false;
+        }
+    }
+    return true;
+}
+
 //
 // fields for fen are:
 // piece placement, current colors turn, castling avaliablity, enpassant, halfmove number (fifty move rule), total moves 
@@ -1143,31 +1214,6 @@ bool GameBoard::is_king_highest_piece() {
 
 
 
-//
-// Minimum Manhattan distance from the friendly king to the 2×2 center box
-// center squares: (3,3),(4,3),(3,4),(4,4)  (i.e., d4,e4,d5,e5 in normal coords)
-// Range: 0..6 (max occurs from corner squares like a1/h1/a8/h8).
-template<Color c> int GameBoard::king_center_manhattan_dist_t()
-{
-    int iReturn;
-    assert(white_king != 0ULL);
-    assert(black_king != 0ULL);
-
-    ull kbb = get_pieces_template<Piece::KING,c>();
-    Square ks = utility::bit::bitboard_to_lowest_square_fast(kbb);
-
-    int f = ks & 7;
-    int r = ks >> 3;
-
-    int dx = (f < 3) ? (3 - f) : (f > 4 ? f - 4 : 0);
-    int dy = (r < 3) ? (3 - r) : (r > 4 ? r - 4 : 0);
-
-    iReturn = dx + dy;
-    assert(iReturn <= 6);
-
-    return iReturn;
-}
-
 // Counts sliders+knights attacking the enemy's passed pawns.
 // passed_white_pwns / passed_black_pwns are bitboards of all passed pawns.
 int GameBoard::attackers_on_enemy_passed_pawns(Color attacker_color,
@@ -1467,863 +1513,175 @@ retry_all:
     return fen;
 }
 
-///////////////////////////////////////////////////////////////////////////////////
 //
-// Returns 0 if no piece on sq. IF piece on sq (not attacked) it returns the 
-//    value of the piece in centipawns. If piece on sq attacked, it "adds up" the attackers.  
-//    returns positive if the square is controller (attacked) by the passed side, negative otherwise.
-//    Returns in centipawns. 
-//
-int GameBoard::SEE_for_capture(Color side, const Move &mv, FILE* fpDebug)
+// Piece values for the exchange, indexed by Piece. As centipawn_score_of(), except the king: it can
+// capture last, but can never be captured.
+static constexpr int see_values[] = {
+    100,    // PAWN
+    500,    // ROOK
+    320,    // KNIGHT
+    330,    // BISHOP
+    900,    // QUEEN
+    20000,  // KING
+    0       // NONE
+};
+
+ull GameBoard::attackers_to(int sq, ull occ) const
 {
-    // from and to are BITBOARDS (ull) with exactly one bit set.
-
-    // const ull frm = mv.from;
-    // const ull to  = mv.to;
-    const ull from_bb = utility::bit::square_to_bitboard(mv.fromSQ);
-    const ull to_bb = utility::bit::square_to_bitboard(mv.toSQ);
-    // assert(frm == from_bb);
-    // assert(to == to_bb);
-
-    assert (bits_in(from_bb) == 1);
-    assert (bits_in(to_bb) == 1);
-    
-    if (from_bb == 0ULL || to_bb == 0ULL) {   
-        assert(0);      // NULL bitboards in the Move, should never happen.
-        return 0;
-    }
-
-    // Convert bitboards to 0..63 square indices (h1=0)
-    ull tmp = from_bb;
-    Square from_sq = utility::bit::lsb_and_pop_to_square(tmp);
-    tmp = to_bb;
-    Square to_sq   = utility::bit::lsb_and_pop_to_square(tmp);
-
-
-    // There must be an enemy victim on 'to_sq' for a normal capture
-    Piece victim = get_piece_type_on_bitboard(to_bb);
-
-    if (victim == Piece::NONE) {
-        //assert(0);
-        return 0;  // ignore en passant etc. for SEE for now. Note: what is this?
-    }
-
-    // Identify the victim on 'to_sq'
-    Color victim_color = get_color_on_bitboard(to_bb);
-    if (victim_color == side) {   
-        assert(0);     // Caller should prevent this. Cant take your own piece!
-        return 0;
-    }
-
-    // Identify the moving piece on 'from_sq'
-    Piece mover = get_piece_type_on_bitboard(from_bb);
-    if (mover == Piece::NONE) {
-        assert(0);      // Caller should prevent this. Cant take nothing!
-        return 0;
-    }
-
-    // Get local mutable copies of all piece bitboards
-    ull wp = white_pawns,   wn = white_knights, wb = white_bishops,
-        wr = white_rooks,   wq = white_queens,  wk = white_king;
-
-    ull bp = black_pawns,   bn = black_knights, bb = black_bishops,
-        br = black_rooks,   bq = black_queens,  bk = black_king;
-
-    ull occ = get_pieces();
-
-    const ull FILE_A = col_masks[ColHA::COL_A];
-    const ull FILE_H = col_masks[ColHA::COL_H];
-
- 
-
-    // Optional debug: dump initial attackers
-    if (fpDebug)
-    {
-        // Helper: attackers on 'to_sq' for color c, using local boards & occ
-        auto attackers_on_initial = [&](Color c, ull occ_now) -> ull
-        {
-            ull atk = 0ULL;
-            ull bit = (1ULL << to_sq);
-
-            // Pawns (origins that attack to_sq)
-            ull pawns = (c == Color::WHITE) ? wp : bp;
-            
-            ull origins;
-            if (c == Color::WHITE){
-                origins = ((bit & ~FILE_A) >> 7) | ((bit & ~FILE_H) >> 9);
-            } else {
-                origins = ((bit & ~FILE_H) << 7) | ((bit & ~FILE_A) << 9);
-            }
-            atk |= (origins & pawns);
-
-            // Knights
-            ull knights = (c == Color::WHITE) ? wn : bn;
-            atk |= tables::movegen::knight_attack_table[to_sq] & knights;
-
-            // Kings
-            ull kings = (c == Color::WHITE) ? wk : bk;
-            atk |= tables::movegen::king_attack_table[to_sq] & kings;
-
-            // Bishops / Queens on diagonals
-            ull bishops = (c == Color::WHITE) ? wb : bb;
-            ull queens  = (c == Color::WHITE) ? wq : bq;
-
-            int c0 = to_sq & 7;
-            int r0 = to_sq >> 3;
-
-            const int diag_dirs[4][2] = { {+1,+1}, {+1,-1}, {-1,+1}, {-1,-1} };
-            for (int k = 0; k < 4; ++k) {
-                int r = r0;
-                int f = c0;
-                while (true) {
-                    r += diag_dirs[k][0];
-                    f += diag_dirs[k][1];
-                    if (r < 0 || r > 7 || f < 0 || f > 7) break;
-                    int s2  = r * 8 + f;
-                    ull bb2 = 1ULL << s2;
-                    if (occ_now & bb2)
-                    {
-                        if ((bb2 & bishops) || (bb2 & queens))
-                            atk |= bb2;
-                        break;
-                    }
-                }
-            }
+    const ull diagonal_sliders = white_bishops | black_bishops | white_queens | black_queens;
+    const ull straight_sliders = white_rooks | black_rooks | white_queens | black_queens;
 
-            // Rooks / Queens on ranks/files
-            ull rooks = (c == Color::WHITE) ? wr : br;
-            const int ortho_dirs[4][2] = { {+1,0}, {-1,0}, {0,+1}, {0,-1} };
-            for (int k = 0; k < 4; ++k) {
-                int r = r0;
-                int f = c0;
-                while (true) {
-                    r += ortho_dirs[k][0];
-                    f += ortho_dirs[k][1];
-                    if (r < 0 || r > 7 || f < 0 || f > 7) break;
-                    int s2  = r * 8 + f;
-                    ull bb2 = 1ULL << s2;
-                    if (occ_now & bb2)
-                    {
-                        if ((bb2 & rooks) || (bb2 & queens))
-                            atk |= bb2;
-                        break;
-                    }
-                }
-            }
-
-            return atk;
-        };
-
-
-        ull att_w0 = attackers_on_initial(Color::WHITE, occ);
-        ull att_b0 = attackers_on_initial(Color::BLACK, occ);
-
-        fprintf(fpDebug,
-                "debug (before forced capture): side=%s from_bb=0x%016llx to_bb=0x%016llx "
-                "from_sq=%d to_sq=%d victim=%d mover=%d\n",
-                utility::representation::color_to_string(side).c_str(),
-                (unsigned long long)from_bb,
-                (unsigned long long)to_bb,
-                from_sq, to_sq,
-                (int)victim, (int)mover);
-
-        auto dump_attackers = [&](const char* label, ull mask)
-        {
-            fprintf(fpDebug, "    %s attackers on sq %d:", label, to_sq);
-            if (!mask)
-            {
-                fprintf(fpDebug, " [none]\n");
-                return;
-            }
-            ull tmp2 = mask;
-            while (tmp2)
-            {
-                Square s = utility::bit::lsb_and_pop_to_square(tmp2);
-                fprintf(fpDebug, " %d", s);
-            }
-            fprintf(fpDebug, "\n");
-        };
-
-        dump_attackers("white", att_w0);
-        dump_attackers("black", att_b0);
-
-    }   // END debug
-
-    // === Apply the FORCED first capture mv by 'side' ===
-
-    int balance = 0;
-    balance += centipawn_score_of(victim);   // side captures victim
-
-    ull to_mask = (1ULL << to_sq);
-
-    // Remove victim from its color's bitboard
-    if (victim_color == Color::WHITE) {
-        if (victim == Piece::PAWN)   wp &= ~to_mask;
-        else if (victim == Piece::KNIGHT) wn &= ~to_mask;
-        else if (victim == Piece::BISHOP) wb &= ~to_mask;
-        else if (victim == Piece::ROOK)   wr &= ~to_mask;
-        else if (victim == Piece::QUEEN)  wq &= ~to_mask;
-        else if (victim == Piece::KING)   wk &= ~to_mask;
-    } else {
-        if (victim == Piece::PAWN)   bp &= ~to_mask;
-        else if (victim == Piece::KNIGHT) bn &= ~to_mask;
-        else if (victim == Piece::BISHOP) bb &= ~to_mask;
-        else if (victim == Piece::ROOK)   br &= ~to_mask;
-        else if (victim == Piece::QUEEN)  bq &= ~to_mask;
-        else if (victim == Piece::KING)   bk &= ~to_mask;
-    }
-
-    // Remove mover from its original square
-    if (side == Color::WHITE) {
-        if (mover == Piece::PAWN)   wp &= ~from_bb;
-        else if (mover == Piece::KNIGHT) wn &= ~from_bb;
-        else if (mover == Piece::BISHOP) wb &= ~from_bb;
-        else if (mover == Piece::ROOK)   wr &= ~from_bb;
-        else if (mover == Piece::QUEEN)  wq &= ~from_bb;
-        else if (mover == Piece::KING)   wk &= ~from_bb;
-    } else {
-        if (mover == Piece::PAWN)   bp &= ~from_bb;
-        else if (mover == Piece::KNIGHT) bn &= ~from_bb;
-        else if (mover == Piece::BISHOP) bb &= ~from_bb;
-        else if (mover == Piece::ROOK)   br &= ~from_bb;
-        else if (mover == Piece::QUEEN)  bq &= ~from_bb;
-        else if (mover == Piece::KING)   bk &= ~from_bb;
-    }
-
-    // Place mover on to_sq
-    if (side == Color::WHITE) {
-        if (mover == Piece::PAWN)   wp |= to_mask;
-        else if (mover == Piece::KNIGHT) wn |= to_mask;
-        else if (mover == Piece::BISHOP) wb |= to_mask;
-        else if (mover == Piece::ROOK)   wr |= to_mask;
-        else if (mover == Piece::QUEEN)  wq |= to_mask;
-        else if (mover == Piece::KING)   wk |= to_mask;
-    } else {
-        if (mover == Piece::PAWN)   bp |= to_mask;
-        else if (mover == Piece::KNIGHT) bn |= to_mask;
-        else if (mover == Piece::BISHOP) bb |= to_mask;
-        else if (mover == Piece::ROOK)   br |= to_mask;
-        else if (mover == Piece::QUEEN)  bq |= to_mask;
-        else if (mover == Piece::KING)   bk |= to_mask;
-    }
-
-    // Update occupancy
-    occ &= ~from_bb;   // clear original square of mover
-    occ &= ~to_mask;   // clear victim
-    occ |=  to_mask;   // mover now on to_sq
-
-    // After the first forced capture, the target is now the mover on to_sq
-    Piece target_piece  = mover;
-    Color target_color  = side;
-    Color root_side     = side;
-    Color next_clr      = (side == Color::WHITE) ? Color::BLACK : Color::WHITE;
-
-    // === Recursive SEE on this square after the first forced capture ===
-    auto see_rec = [&](auto &&self,
-                       Color stm,
-                       Piece target_piece_local, Color target_color_local,
-                       ull occ_local,
-                       ull wp_local, ull wn_local, ull wb_local,
-                       ull wr_local, ull wq_local, ull wk_local,
-                       ull bp_local, ull bn_local, ull bb_local,
-                       ull br_local, ull bq_local, ull bk_local,
-                       int balance_local) -> int
-    {
-        int best = balance_local;
-
-        // Local attackers_on using local boards & occ (same pattern as above)
-        auto attackers_on_state = [&](Color c) -> ull
-        {
-            ull atk = 0ULL;
-            ull bit = (1ULL << to_sq);
-
-            ull pawns = (c == Color::WHITE) ? wp_local : bp_local;
-            ull origins;
-            if (c == Color::WHITE) {
-                origins = ((bit & ~FILE_A) >> 7) | ((bit & ~FILE_H) >> 9);
-            }
-            else {
-                origins = ((bit & ~FILE_H) << 7) | ((bit & ~FILE_A) << 9);
-            }
-            atk |= (origins & pawns);
-
-            ull knights = (c == Color::WHITE) ? wn_local : bn_local;
-            atk |= tables::movegen::knight_attack_table[to_sq] & knights;
-
-            ull kings = (c == Color::WHITE) ? wk_local : bk_local;
-            atk |= tables::movegen::king_attack_table[to_sq] & kings;
-
-            ull bishops = (c == Color::WHITE) ? wb_local : bb_local;
-            ull queens  = (c == Color::WHITE) ? wq_local : bq_local;
-
-            int r0 = to_sq >> 3;
-            int c0 = to_sq & 7;
-
-            const int diag_dirs[4][2] = { {+1,+1}, {+1,-1}, {-1,+1}, {-1,-1} };
-            for (int k = 0; k < 4; ++k) {
-                int r = r0;
-                int f = c0;
-                while (true)
-                {
-                    r += diag_dirs[k][0];
-                    f += diag_dirs[k][1];
-                    if (r < 0 || r > 7 || f < 0 || f > 7) break;
-                    int s2  = r * 8 + f;
-                    ull bb2 = 1ULL << s2;
-                    if (occ_local & bb2) {
-                        if ((bb2 & bishops) || (bb2 & queens))
-                            atk |= bb2;
-                        break;
-                    }
-                }
-            }
-
-            ull rooks = (c == Color::WHITE) ? wr_local : br_local;
-            const int ortho_dirs[4][2] = { {+1,0}, {-1,0}, {0,+1}, {0,-1} };
-            for (int k = 0; k < 4; ++k) {
-                int r = r0;
-                int f = c0;
-                while (true) {
-                    r += ortho_dirs[k][0];
-                    f += ortho_dirs[k][1];
-                    if (r < 0 || r > 7 || f < 0 || f > 7) break;
-                    int s2  = r * 8 + f;
-                    ull bb2 = 1ULL << s2;
-                    if (occ_local & bb2)
-                    {
-                        if ((bb2 & rooks) || (bb2 & queens))
-                            atk |= bb2;
-                        break;
-                    }
-                }
-            }
-
-            return atk;
-        };
-
-        // Get all attackers for stm on to_sq
-        ull atk_side = attackers_on_state(stm);
-        if (!atk_side)
-            return best;  // no more captures; side chooses to stop
-
-        // Try every possible attacker
-        ull tmp_atk = atk_side;
-        while (tmp_atk) {
-
-            ull attacker_bb = tmp_atk & (~tmp_atk + 1ULL);  // extract LS1B
-            tmp_atk &= ~attacker_bb;
-
-            // Copy local state
-            ull occ2  = occ_local;
-            ull wp2   = wp_local, wn2 = wn_local, wb2 = wb_local;
-            ull wr2   = wr_local, wq2 = wq_local, wk2 = wk_local;
-            ull bp2   = bp_local, bn2 = bn_local, bb2 = bb_local;
-            ull br2   = br_local, bq2 = bq_local, bk2 = bk_local;
-
-            // Material change from root_side's point of view:
-            int val = centipawn_score_of(target_piece_local);
-            int new_balance = balance_local;
-            if (stm == root_side)
-                new_balance += val;
-            else
-                new_balance -= val;
-
-            // Apply capture: remove target from its bitboard, move attacker to to_sq
-            ull to_mask_local = (1ULL << to_sq);
-
-            if (target_color_local == Color::WHITE) {
-                if (target_piece_local == Piece::PAWN)   wp2 &= ~to_mask_local;
-                else if (target_piece_local == Piece::KNIGHT) wn2 &= ~to_mask_local;
-                else if (target_piece_local == Piece::BISHOP) wb2 &= ~to_mask_local;
-                else if (target_piece_local == Piece::ROOK)   wr2 &= ~to_mask_local;
-                else if (target_piece_local == Piece::QUEEN)  wq2 &= ~to_mask_local;
-                else if (target_piece_local == Piece::KING)   wk2 &= ~to_mask_local;
-            } else {
-                if (target_piece_local == Piece::PAWN)   bp2 &= ~to_mask_local;
-                else if (target_piece_local == Piece::KNIGHT) bn2 &= ~to_mask_local;
-                else if (target_piece_local == Piece::BISHOP) bb2 &= ~to_mask_local;
-                else if (target_piece_local == Piece::ROOK)   br2 &= ~to_mask_local;
-                else if (target_piece_local == Piece::QUEEN)  bq2 &= ~to_mask_local;
-                else if (target_piece_local == Piece::KING)   bk2 &= ~to_mask_local;
-            }
-
-            // Figure out what piece is attacking (before we remove it)
-            //Piece attacker_piece2 = piece_type_of(stm, attacker_bb);
-            Piece attacker_piece = get_piece_type_on_bitboard(stm, attacker_bb);
-            //assert(attacker_piece == attacker_piece2);
-
-            // Remove attacker from its original square
-            if (stm == Color::WHITE) {
-                if (attacker_bb & wp2) wp2 &= ~attacker_bb;
-                else if (attacker_bb & wn2) wn2 &= ~attacker_bb;
-                else if (attacker_bb & wb2) wb2 &= ~attacker_bb;
-                else if (attacker_bb & wr2) wr2 &= ~attacker_bb;
-                else if (attacker_bb & wq2) wq2 &= ~attacker_bb;
-                else if (attacker_bb & wk2) wk2 &= ~attacker_bb;
-            } else {
-                if (attacker_bb & bp2) bp2 &= ~attacker_bb;
-                else if (attacker_bb & bn2) bn2 &= ~attacker_bb;
-                else if (attacker_bb & bb2) bb2 &= ~attacker_bb;
-                else if (attacker_bb & br2) br2 &= ~attacker_bb;
-                else if (attacker_bb & bq2) bq2 &= ~attacker_bb;
-                else if (attacker_bb & bk2) bk2 &= ~attacker_bb;
-            }
-
-            // Place attacker on to_sq
-            if (stm == Color::WHITE) {
-                if (attacker_piece == Piece::PAWN)   wp2 |= to_mask_local;
-                else if (attacker_piece == Piece::KNIGHT) wn2 |= to_mask_local;
-                else if (attacker_piece == Piece::BISHOP) wb2 |= to_mask_local;
-                else if (attacker_piece == Piece::ROOK)   wr2 |= to_mask_local;
-                else if (attacker_piece == Piece::QUEEN)  wq2 |= to_mask_local;
-                else if (attacker_piece == Piece::KING)   wk2 |= to_mask_local;
-            } else {
-                if (attacker_piece == Piece::PAWN)   bp2 |= to_mask_local;
-                else if (attacker_piece == Piece::KNIGHT) bn2 |= to_mask_local;
-                else if (attacker_piece == Piece::BISHOP) bb2 |= to_mask_local;
-                else if (attacker_piece == Piece::ROOK)   br2 |= to_mask_local;
-                else if (attacker_piece == Piece::QUEEN)  bq2 |= to_mask_local;
-                else if (attacker_piece == Piece::KING)   bk2 |= to_mask_local;
-            }
-
-            // Update occupancy
-            occ2 &= ~attacker_bb;
-            occ2 &= ~to_mask_local;
-            occ2 |=  to_mask_local;
-
-            // New target is this attacker on to_sq
-            Piece new_target_piece = attacker_piece;
-            Color new_target_color = stm;
-
-            Color next = (stm == Color::WHITE ? Color::BLACK : Color::WHITE);
-
-            int child = self(self,
-                             next,
-                             new_target_piece, new_target_color,
-                             occ2,
-                             wp2, wn2, wb2, wr2, wq2, wk2,
-                             bp2, bn2, bb2, br2, bq2, bk2,
-                             new_balance);
-
-            if (stm == root_side) {
-                if (child > best) best = child;
-            }
-            else {
-                if (child < best) best = child;
-            }
-        }
-
-        return best;
-    };
-
-    int result = see_rec(see_rec,
-                         next_clr,
-                         target_piece, target_color,
-                         occ,
-                         wp, wn, wb, wr, wq, wk,
-                         bp, bn, bb, br, bq, bk,
-                         balance);
-
-    if (fpDebug) {
-        fprintf(fpDebug,
-                "debug final: move(from_sq=%d,to_sq=%d) side=%s SEE=%d\n",
-                from_sq, to_sq,
-                utility::representation::color_to_string(side).c_str(),
-                result);
-    }
-
-    return result;
+    return (tables::movegen::black_pawn_attack_table[sq] & white_pawns)
+         | (tables::movegen::white_pawn_attack_table[sq] & black_pawns)
+         | (tables::movegen::knight_attack_table[sq] & (white_knights | black_knights))
+         | (tables::movegen::king_attack_table[sq] & (white_king | black_king))
+         | (get_diagonal_attacks_mbb(occ, sq) & diagonal_sliders)
+         | (get_straight_attacks_mbb(occ, sq) & straight_sliders);
 }
 
-
-// -----------------------------------------------------------------------------
-// Static Exchange Evaluation (SEE) for a *single* capture move.
 //
-// Given a capture move `mv`
-// this routine estimates the net material gain/loss in centipawns assuming
-// optimal recaptures on the destination square.
-// Positive value returned means the capture is materially profitable for the side to move.
-// Zero value means the capture is materially neutral after exchanges.
-//   1) It identifies the moving piece (mover) on `from` and the captured piece
-//      (victim) on `to`. If there is no victim (e.g. en-passant), it returns 0.
-//   2) It "plays" the forced first capture on local copies of all piece
-//      bitboards + occupancy: removes the victim, moves the mover to `to_sq`,
-//      and updates `occ`.
-//   3) It then calls SEE_recursive() for alternating recaptures on `to_sq`,
-//      treating the mover (now on `to_sq`) as the current target.
-//   4) Returns the resulting net score from the perspective of `clr` (the side
-//      making the initial capture), in centipawns. 
-//
-// Notes / assumptions:
-// - SEE is purely material-based and local to the target square; it does not
-//   consider check, pins, discovered tactics beyond what SEE_recursive models.
-// -----------------------------------------------------------------------------
-int GameBoard::SEE_for_capture_new(Color clr, const Move &mv, FILE* fpDebug)
+// The swap list. gain[d] is what the side making capture d has won if the exchange stops after it.
+// Each capture takes with the least valuable attacker. Removing it from occ uncovers any slider behind it
+// (x-ray), which the magic lookups then see. Then the list is folded back: at each capture the side
+// either takes, or stands pat.
+int GameBoard::see(const Move& mv) const
 {
-    // from and to are BITBOARDS (ull) with exactly one bit set.
-    // ull frm = mv.from;
-    // ull to  = mv.to;
-    const ull from_bb = utility::bit::square_to_bitboard(mv.fromSQ);
     const ull to_bb = utility::bit::square_to_bitboard(mv.toSQ);
-    // assert(frm == from_bb);
-    // assert(to == to_bb);
-
-    assert (bits_in(from_bb) == 1);
-    assert (bits_in(to_bb) == 1);
-
-    if (from_bb == 0ULL || to_bb == 0ULL) {   
-        assert(0);      // NULL bitboards in the Move, should never happen.
-        return 0;
-    }
-
-    // Convert bitboards to 0..63 square indices (h1 = 0)
-    ull tmp = from_bb;
-    Square from_sq = utility::bit::lsb_and_pop_to_square(tmp);
-    tmp = to_bb;
-    Square to_sq   = utility::bit::lsb_and_pop_to_square(tmp);
-
-
-    // There must be an enemy victim on 'to_sq' for a normal capture
-    Piece victim = get_piece_type_on_bitboard(to_bb);
-
-    if (victim == Piece::NONE) {
-        //assert(0);
-        return 0;  // ignore en passant etc. for SEE, for now
-    }
+    ull from_bb     = utility::bit::square_to_bitboard(mv.fromSQ);
 
-    // Identify the victim on 'to_sq'
-    Color victim_color = get_color_on_bitboard(to_bb);
-    if (victim_color == clr) {   
-        assert(0);     // Caller should prevent this. Cant take your own piece!
-        return 0;
-    }
-
-    // Identify the moving piece on 'from_sq'
-    Piece mover = get_piece_type_on_bitboard(from_bb);
-    if (mover == Piece::NONE) {
-        assert(0);      // Caller should prevent this. Cant take nothing!
-        return 0;
-    }
-
-    // Get local mutable copies of all piece bitboards
-    ull wp = white_pawns,   wn = white_knights, wb = white_bishops,
-        wr = white_rooks,   wq = white_queens,  wk = white_king;
+    const ull all_pieces = get_pieces();
+    if (!(all_pieces & to_bb)) return 0;        // en passant (or not a capture)
 
-    ull bp = black_pawns,   bn = black_knights, bb = black_bishops,
-        br = black_rooks,   bq = black_queens,  bk = black_king;
+    const ull diagonal_sliders = white_bishops | black_bishops | white_queens | black_queens;
+    const ull straight_sliders = white_rooks | black_rooks | white_queens | black_queens;
 
-    ull occ = get_pieces();
+    const ull by_color[2] = {
+        white_pawns | white_rooks | white_knights | white_bishops | white_queens | white_king,
+        black_pawns | black_rooks | black_knights | black_bishops | black_queens | black_king,
+    };
+    // LVA order
+    const ull by_piece[6][2] = {
+        {white_pawns,   black_pawns},
+        {white_knights, black_knights},
+        {white_bishops, black_bishops},
+        {white_rooks,   black_rooks},
+        {white_queens,  black_queens},
+        {white_king,    black_king},
+    };
+    static constexpr Piece lva_order[6] = {Piece::PAWN, Piece::KNIGHT, Piece::BISHOP, Piece::ROOK, Piece::QUEEN, Piece::KING};
 
-    const ull FILE_A = col_masks[ColHA::COL_A];
-    const ull FILE_H = col_masks[ColHA::COL_H];
+    int gain[32];
+    int d = 0;
+    gain[0] = see_values[mv.capture];
 
- 
-    // === Apply the FORCED first capture mv by 'color' ===
+    ull occ = all_pieces;
+    ull attackers = attackers_to(mv.toSQ, occ);
+    Piece attacker = mv.piece_type;
+    int side = mv.color;
 
-    int balance = 0;
-    balance += centipawn_score_of(victim);   // color captures victim
+    while (d < 31) {
+        occ ^= from_bb;
+        attackers &= occ;
+        if (attacker == Piece::PAWN || attacker == Piece::BISHOP || attacker == Piece::QUEEN) {
+            attackers |= get_diagonal_attacks_mbb(occ, mv.toSQ) & diagonal_sliders & occ;
+        }
+        if (attacker == Piece::ROOK || attacker == Piece::QUEEN) {
+            attackers |= get_straight_attacks_mbb(occ, mv.toSQ) & straight_sliders & occ;
+        }
 
-    ull to_mask = (1ULL << to_sq);
+        side ^= 1;
+        const ull side_attackers = attackers & by_color[side];
+        if (!side_attackers) break;
 
-    // Remove victim from its color's bitboard
-    if (victim_color == Color::WHITE) {
-        if (victim == Piece::PAWN)   wp &= ~to_mask;
-        else if (victim == Piece::KNIGHT) wn &= ~to_mask;
-        else if (victim == Piece::BISHOP) wb &= ~to_mask;
-        else if (victim == Piece::ROOK)   wr &= ~to_mask;
-        else if (victim == Piece::QUEEN)  wq &= ~to_mask;
-        else if (victim == Piece::KING)   wk &= ~to_mask;
-    } else {
-        if (victim == Piece::PAWN)   bp &= ~to_mask;
-        else if (victim == Piece::KNIGHT) bn &= ~to_mask;
-        else if (victim == Piece::BISHOP) bb &= ~to_mask;
-        else if (victim == Piece::ROOK)   br &= ~to_mask;
-        else if (victim == Piece::QUEEN)  bq &= ~to_mask;
-        else if (victim == Piece::KING)   bk &= ~to_mask;
-    }
+        int i = 0;
+        while (!(side_attackers & by_piece[i][side])) i++;
+        // A king can't take into an attack
+        if (lva_order[i] == Piece::KING && (attackers & by_color[side ^ 1])) break;
 
-    // Remove mover from its original square
-    if (clr == Color::WHITE) {
-        if (mover == Piece::PAWN)   wp &= ~from_bb;
-        else if (mover == Piece::KNIGHT) wn &= ~from_bb;
-        else if (mover == Piece::BISHOP) wb &= ~from_bb;
-        else if (mover == Piece::ROOK)   wr &= ~from_bb;
-        else if (mover == Piece::QUEEN)  wq &= ~from_bb;
-        else if (mover == Piece::KING)   wk &= ~from_bb;
-    } else {
-        if (mover == Piece::PAWN)   bp &= ~from_bb;
-        else if (mover == Piece::KNIGHT) bn &= ~from_bb;
-        else if (mover == Piece::BISHOP) bb &= ~from_bb;
-        else if (mover == Piece::ROOK)   br &= ~from_bb;
-        else if (mover == Piece::QUEEN)  bq &= ~from_bb;
-        else if (mover == Piece::KING)   bk &= ~from_bb;
-    }
+        d++;
+        gain[d] = see_values[attacker] - gain[d - 1];
 
-    // Place mover on to_sq
-    if (clr == Color::WHITE) {
-        if (mover == Piece::PAWN)   wp |= to_mask;
-        else if (mover == Piece::KNIGHT) wn |= to_mask;
-        else if (mover == Piece::BISHOP) wb |= to_mask;
-        else if (mover == Piece::ROOK)   wr |= to_mask;
-        else if (mover == Piece::QUEEN)  wq |= to_mask;
-        else if (mover == Piece::KING)   wk |= to_mask;
-    } else {
-        if (mover == Piece::PAWN)   bp |= to_mask;
-        else if (mover == Piece::KNIGHT) bn |= to_mask;
-        else if (mover == Piece::BISHOP) bb |= to_mask;
-        else if (mover == Piece::ROOK)   br |= to_mask;
-        else if (mover == Piece::QUEEN)  bq |= to_mask;
-        else if (mover == Piece::KING)   bk |= to_mask;
+        const ull bb = side_attackers & by_piece[i][side];
+        from_bb  = bb & (0ULL - bb);
+        attacker = lva_order[i];
     }
 
-    // Update occupancy
-    occ &= ~from_bb;   // clear original square of mover
-    occ &= ~to_mask;   // clear victim
-    occ |=  to_mask;   // mover now on to_sq
-
-    // After the first forced capture, the target is now the mover on to_sq
-    Piece target_piece  = mover;
-    Color target_color  = clr;
-    Color root_side     = clr;
-    Color next_clr      = (clr == Color::WHITE) ? Color::BLACK : Color::WHITE;
-
-    SEEBoards b0;
-    b0.wp = wp; b0.wn = wn; b0.wb = wb; b0.wr = wr; b0.wq = wq; b0.wk = wk;
-    b0.bp = bp; b0.bn = bn; b0.bb = bb; b0.br = br; b0.bq = bq; b0.bk = bk;
-
-    int result = SEE_recursive(next_clr,
-                        root_side,
-                        to_sq,
-                        target_piece,
-                        target_color,
-                        occ,
-                        b0,             // all the bitboards
-                        balance);
-
-    if (fpDebug) {
-        fprintf(fpDebug,
-                "debug final: move(from_sq=%d,to_sq=%d) clt=%s SEE=%d\n",
-                from_sq, to_sq,
-                utility::representation::color_to_string(clr).c_str(),
-                result);
+    for (; d > 0; d--) {
+        gain[d - 1] = -std::max(-gain[d - 1], gain[d]);
     }
-
-    return result;
+    return gain[0];
 }
 
 //
-// Returns a bitboard of all pieces of color `c` that currently attack the
-// square `sq`, using the *local SEE board state* instead of the real board.
-//
-// This function is used during Static Exchange Evaluation (SEE).  It does not
-// read the GameBoard’s live bitboards; instead it uses the supplied SEEBoards
-// snapshot `b` plus the supplied occupancy `occ_now`, which represent a
-// hypothetical capture sequence in progress.
-//
-// Attacks detected:
-//   - pawn capture sources
-//   - knight attacks (table lookup)
-//   - king attacks (table lookup)
-//   - sliding attacks from bishops/queens (diagonals)
-//   - sliding attacks from rooks/queens (ranks/files)
-//
-// Important properties:
-//   • `sq` is a 0..63 index (h1=0 convention)
-//   • `occ_now` must match the board state represented in `b`
-//   • Only the first blocker in each ray is considered (correct for SEE)
-//   • Returned bitboard may contain multiple attackers
-//
-// This routine is intentionally side-effect free and fast, since it is called
-// repeatedly during SEE recursion.
-ull GameBoard::SEE_attackers_on_square_local(Color c,
-                                             int sq,
-                                             ull occ_now,
-                                             const SEEBoards& b) const
-{
-    ull atk = 0ULL;
-    const ull bit = (1ULL << sq);
-
-    const ull FILE_A = col_masks[ColHA::COL_A];
-    const ull FILE_H = col_masks[ColHA::COL_H];
-
-    // -----------------------
-    // Pawns (origins that attack sq)
-    // -----------------------
-    const ull pawns = (c == Color::WHITE) ? b.wp : b.bp;
-
-    ull origins = 0ULL;
-    if (c == Color::WHITE) {
-        origins = ((bit & ~FILE_A) >> 7) | ((bit & ~FILE_H) >> 9);
-    } else {
-        origins = ((bit & ~FILE_H) << 7) | ((bit & ~FILE_A) << 9);
-    }
-    atk |= (origins & pawns);
-
-    // -----------------------
-    // Knights
-    // -----------------------
-    const ull knights = (c == Color::WHITE) ? b.wn : b.bn;
-    atk |= (tables::movegen::knight_attack_table[sq] & knights);
-
-    // -----------------------
-    // Kings
-    // -----------------------
-    const ull kings = (c == Color::WHITE) ? b.wk : b.bk;
-    atk |= (tables::movegen::king_attack_table[sq] & kings);
-
-    // -----------------------
-    // Sliders via your ray-attack helpers
-    // -----------------------
-    const ull all_pieces_but_self = occ_now & ~bit;
-
-    // Diagonals: bishops/queens
-
-    const ull bishops = (c == Color::WHITE) ? b.wb : b.bb;
-    const ull queens  = (c == Color::WHITE) ? b.wq : b.bq;
-
-    //const ull diag_attacks2 = get_diagonal_attacks(all_pieces_but_self, sq);
-    const ull diag_attacks = get_diagonal_attacks_mbb(all_pieces_but_self, sq);
-    //assert(diag_attacks == diag_attacks2);
-
-    atk |= (diag_attacks & (bishops | queens));
-
-    // Straights: rooks/queens
-
-    const ull rooks  = (c == Color::WHITE) ? b.wr : b.br;
-
-    //const ull straight_attacks2 = get_straight_attacks(all_pieces_but_self, sq);
-    const ull straight_attacks = get_straight_attacks_mbb(all_pieces_but_self, sq);
-    //assert(straight_attacks == straight_attacks2);
-
-    atk |= (straight_attacks & (rooks | queens));
-
-    return atk;
-}
-
-
-int GameBoard::SEE_recursive(Color stm,
-                       Color root_side,
-                       int to_sq,
-                       Piece target_piece,
-                       Color target_color,
-                       ull occ_local,
-                       const SEEBoards& b_local,
-                       int balance_local)
+// As see(), but only answers "is it at least threshold". swap is the margin for the side to move in the
+// exchange: once it can stop, or the other side can, with the answer settled, we are done.
+bool GameBoard::see_ge(const Move& mv, int threshold) const
 {
-    int best = balance_local;
-
-    // attackers for stm on to_sq
-    ull atk_side = SEE_attackers_on_square_local(stm, to_sq, occ_local, b_local);
-    if (!atk_side) return best;     // No more attackers
-
-
-    ull tmp_atk = atk_side;
-    while (tmp_atk) {
-
-        ull attacker_bb = tmp_atk & (~tmp_atk + 1ULL);   // LS1B
-        tmp_atk &= ~attacker_bb;
-
-        // Copy state
-        SEEBoards b2 = b_local;
-        ull occ2 = occ_local;
-
-        // Material swing is the value of the current target on to_sq
-        int val = centipawn_score_of(target_piece);
-        int new_balance = balance_local;
+    const ull to_bb   = utility::bit::square_to_bitboard(mv.toSQ);
+    const ull from_bb = utility::bit::square_to_bitboard(mv.fromSQ);
 
-        if (stm == root_side) new_balance += val;
-        else                  new_balance -= val;
+    const ull all_pieces = get_pieces();
+    if (!(all_pieces & to_bb)) return (0 >= threshold);     // en passant (or not a capture)
 
-        ull to_mask_local = (1ULL << to_sq);
+    int swap = see_values[mv.capture] - threshold;
+    if (swap < 0) return false;         // Even winning the victim for free is not enough
 
-        // Remove the captured target from its bitboard
-        if (target_color == Color::WHITE) {
-            if      (target_piece == Piece::PAWN)   b2.wp &= ~to_mask_local;
-            else if (target_piece == Piece::KNIGHT) b2.wn &= ~to_mask_local;
-            else if (target_piece == Piece::BISHOP) b2.wb &= ~to_mask_local;
-            else if (target_piece == Piece::ROOK)   b2.wr &= ~to_mask_local;
-            else if (target_piece == Piece::QUEEN)  b2.wq &= ~to_mask_local;
-            else if (target_piece == Piece::KING)   b2.wk &= ~to_mask_local;
-        } else {
-            if      (target_piece == Piece::PAWN)   b2.bp &= ~to_mask_local;
-            else if (target_piece == Piece::KNIGHT) b2.bn &= ~to_mask_local;
-            else if (target_piece == Piece::BISHOP) b2.bb &= ~to_mask_local;
-            else if (target_piece == Piece::ROOK)   b2.br &= ~to_mask_local;
-            else if (target_piece == Piece::QUEEN)  b2.bq &= ~to_mask_local;
-            else if (target_piece == Piece::KING)   b2.bk &= ~to_mask_local;
-        }
+    swap = see_values[mv.piece_type] - swap;
+    if (swap <= 0) return true;         // Even losing the mover is still enough
 
-        // Identify attacker piece (you already have this overload in your code)
-        Piece attacker_piece = get_piece_type_on_bitboard(stm, attacker_bb);
-
-        // Remove attacker from its origin square
-        if (stm == Color::WHITE) {
-            if      (attacker_bb & b2.wp) b2.wp &= ~attacker_bb;
-            else if (attacker_bb & b2.wn) b2.wn &= ~attacker_bb;
-            else if (attacker_bb & b2.wb) b2.wb &= ~attacker_bb;
-            else if (attacker_bb & b2.wr) b2.wr &= ~attacker_bb;
-            else if (attacker_bb & b2.wq) b2.wq &= ~attacker_bb;
-            else if (attacker_bb & b2.wk) b2.wk &= ~attacker_bb;
-        } else {
-            if      (attacker_bb & b2.bp) b2.bp &= ~attacker_bb;
-            else if (attacker_bb & b2.bn) b2.bn &= ~attacker_bb;
-            else if (attacker_bb & b2.bb) b2.bb &= ~attacker_bb;
-            else if (attacker_bb & b2.br) b2.br &= ~attacker_bb;
-            else if (attacker_bb & b2.bq) b2.bq &= ~attacker_bb;
-            else if (attacker_bb & b2.bk) b2.bk &= ~attacker_bb;
-        }
+    const ull diagonal_sliders = white_bishops | black_bishops | white_queens | black_queens;
+    const ull straight_sliders = white_rooks | black_rooks | white_queens | black_queens;
 
-        // Place attacker onto to_sq
-        if (stm == Color::WHITE) {
-            if      (attacker_piece == Piece::PAWN)   b2.wp |= to_mask_local;
-            else if (attacker_piece == Piece::KNIGHT) b2.wn |= to_mask_local;
-            else if (attacker_piece == Piece::BISHOP) b2.wb |= to_mask_local;
-            else if (attacker_piece == Piece::ROOK)   b2.wr |= to_mask_local;
-            else if (attacker_piece == Piece::QUEEN)  b2.wq |= to_mask_local;
-            else if (attacker_piece == Piece::KING)   b2.wk |= to_mask_local;
-        } else {
-            if      (attacker_piece == Piece::PAWN)   b2.bp |= to_mask_local;
-            else if (attacker_piece == Piece::KNIGHT) b2.bn |= to_mask_local;
-            else if (attacker_piece == Piece::BISHOP) b2.bb |= to_mask_local;
-            else if (attacker_piece == Piece::ROOK)   b2.br |= to_mask_local;
-            else if (attacker_piece == Piece::QUEEN)  b2.bq |= to_mask_local;
-            else if (attacker_piece == Piece::KING)   b2.bk |= to_mask_local;
-        }
+    const ull by_color[2] = {
+        white_pawns | white_rooks | white_knights | white_bishops | white_queens | white_king,
+        black_pawns | black_rooks | black_knights | black_bishops | black_queens | black_king,
+    };
 
-        // Update occupancy
-        occ2 &= ~attacker_bb;
-        occ2 &= ~to_mask_local;
-        occ2 |=  to_mask_local;
-
-        // Next ply: the new target is the attacker now sitting on to_sq
-        Piece new_target_piece = attacker_piece;
-        Color new_target_color = stm;
-
-        //Color next = (stm == Color::WHITE) ? Color::BLACK : Color::WHITE;
-        Color next = utility::representation::opposite_color(stm);
-
-        int child = SEE_recursive(next,
-                            root_side,
-                            to_sq,
-                            new_target_piece,
-                            new_target_color,
-                            occ2,
-                            b2,
-                            new_balance);
-
-        if (stm == root_side) {
-            if (child > best) best = child;
+    ull occ = all_pieces ^ from_bb ^ to_bb;
+    ull attackers = attackers_to(mv.toSQ, occ);
+    int side = mv.color;
+    int res = 1;
+
+    while (true) {
+        side ^= 1;
+        attackers &= occ;
+        const ull side_attackers = attackers & by_color[side];
+        if (!side_attackers) break;
+
+        res ^= 1;
+
+        // The least valuable attacker captures. swap is then the margin for the other side.
+        ull bb;
+        if ((bb = side_attackers & (white_pawns | black_pawns))) {
+            if ((swap = see_values[Piece::PAWN] - swap) < res) break;
+            occ ^= bb & (0ULL - bb);
+            attackers |= get_diagonal_attacks_mbb(occ, mv.toSQ) & diagonal_sliders;
+        } else if ((bb = side_attackers & (white_knights | black_knights))) {
+            if ((swap = see_values[Piece::KNIGHT] - swap) < res) break;
+            occ ^= bb & (0ULL - bb);
+        } else if ((bb = side_attackers & (white_bishops | black_bishops))) {
+            if ((swap = see_values[Piece::BISHOP] - swap) < res) break;
+            occ ^= bb & (0ULL - bb);
+            attackers |= get_diagonal_attacks_mbb(occ, mv.toSQ) & diagonal_sliders;
+        } else if ((bb = side_attackers & (white_rooks | black_rooks))) {
+            if ((swap = see_values[Piece::ROOK] - swap) < res) break;
+            occ ^= bb & (0ULL - bb);
+            attackers |= get_straight_attacks_mbb(occ, mv.toSQ) & straight_sliders;
+        } else if ((bb = side_attackers & (white_queens | black_queens))) {
+            if ((swap = see_values[Piece::QUEEN] - swap) < res) break;
+            occ ^= bb & (0ULL - bb);
+            attackers |= (get_diagonal_attacks_mbb(occ, mv.toSQ) & diagonal_sliders)
+                       | (get_straight_attacks_mbb(occ, mv.toSQ) & straight_sliders);
         } else {
-            if (child < best) best = child;
+            // The king takes last. If the other side still has an attacker, it can't, and the result flips back.
+            return (attackers & ~by_color[side]) ? (res ^ 1) : res;
         }
     }
 
-    return best;
+    return res;
 }
 
 
-
-
 // ============================================================================
 // Template implementations for Color-parameterized evaluation helpers
 // ============================================================================
@@ -2511,7 +1869,7 @@ template<Color c> int GameBoard::count_guard_pawn_files_t(const PInfo& PInfoIn,
 }
 
 template<Color c>
-int GameBoard::get_material_for_color_t(int& cp_pawns_only) {
+int GameBoard::get_material_for_color_t(int& cp_pawns_only) const {
     int cp_score_mat_temp = 0;
     cp_pawns_only = bits_in(get_pieces_template<Piece::PAWN, c>()) * centipawn_score_of(Piece::PAWN);
 
@@ -2525,19 +1883,6 @@ int GameBoard::get_material_for_color_t(int& cp_pawns_only) {
     return cp_score_mat_temp;
 }
 
-template<Color c> int GameBoard::get_material_for_color2_t(int& cp_pawns_only) {
-    int cp_score_mat_temp = 0;
-
-    cp_pawns_only = Bits_In[c][Piece::PAWN] * centipawn_score_of(Piece::PAWN);
-
-    cp_score_mat_temp += cp_pawns_only;
-    cp_score_mat_temp += Bits_In[c][Piece::KNIGHT] * centipawn_score_of(Piece::KNIGHT);
-    cp_score_mat_temp += Bits_In[c][Piece::BISHOP] * centipawn_score_of(Piece::BISHOP);
-    cp_score_mat_temp += Bits_In[c][Piece::ROOK]   * centipawn_score_of(Piece::ROOK);
-    cp_score_mat_temp += Bits_In[c][Piece::QUEEN]  * centipawn_score_of(Piece::QUEEN);
-
-    return cp_score_mat_temp;
-}
 // Given a single square, returns a count of the pawns attacking that square.
 // Note: is en passant considered here?
 template<Color c>
@@ -2650,26 +1995,12 @@ int GameBoard::pawns_attacking_center_squares_cp_fast_t()
 
 
 
-// ---------- knights_attacking_square_t ----------
-template<Color c>
-int GameBoard::knights_attacking_square_t(int sq)
-{
-    ull targets = tables::movegen::knight_attack_table[sq];
-    ull knights = get_pieces_template<Piece::KNIGHT, c>();
-    return bits_in(targets & knights);
-}
-
 // ---------- knights_attacking_center_squares_cp_t ----------
+// Each knight counts once for each of e4, d4, e5, d5 it attacks.
 template<Color c>
-int GameBoard::knights_attacking_center_squares_cp_t()
+int GameBoard::knights_attacking_center_squares_cp_t(const AttackInfo& attack_info) const
 {
-    int itemp = 0;
-    itemp += knights_attacking_square_t<c>(square_e4);
-    itemp += knights_attacking_square_t<c>(square_d4);
-    itemp += knights_attacking_square_t<c>(square_e5);
-    itemp += knights_attacking_square_t<c>(square_d5);
-
-    return (itemp * wghts.GetWeight(KNIGHT_ON_CTR));
+    return (attack_info.center_knight_hits[c] * wghts.GetWeight(KNIGHT_ON_CTR));
 }
 
 // ---------- bishops_attacking_square_t ----------
@@ -3522,146 +2853,18 @@ int GameBoard::bishop_blocked_on_both_original_squares_cp_t()
 }
 
 
-// ---------- get_king_near_squares_t ----------
-template<Color c> PotentialCheckInfo GameBoard::potential_checks_against_king_t()
-{
-    constexpr Color e = (c == WHITE) ? BLACK : WHITE;
-
-    PotentialCheckInfo info{};
-
-    const ull king_bb = get_pieces_template<Piece::KING, c>();
-    assert(king_bb != 0ULL);
-    const Square king_sq = utility::bit::bitboard_to_lowest_square_fast(king_bb);
-
-    const ull all_pieces = get_pieces();
-    //const ull our_occupied = get_pieces(c);
-    const ull enemy_occupied = get_pieces(e);
-    // (void)our_occupied;
-
-    ull straight_check_destinations =
-        get_straight_attacks_mbb(all_pieces & ~king_bb, king_sq);
-    ull diagonal_check_destinations =
-        get_diagonal_attacks_mbb(all_pieces & ~king_bb, king_sq);
-
-    straight_check_destinations &= ~enemy_occupied;
-    diagonal_check_destinations &= ~enemy_occupied;
-
-    ull queens = get_pieces_template<Piece::QUEEN, e>();
-    while (queens) {
-        const Square queen_sq = utility::bit::lsb_and_pop_to_square(queens);
-        const ull queen_bb = 1ULL << queen_sq;
-        const ull queen_attacks =
-            get_straight_attacks_mbb(all_pieces & ~queen_bb, queen_sq) |
-            get_diagonal_attacks_mbb(all_pieces & ~queen_bb, queen_sq);
-        const ull queen_check_moves = queen_attacks &
-            (straight_check_destinations | diagonal_check_destinations);
-        info.queen_checks += bits_in(queen_check_moves);
-    }
-
-    ull rooks = get_pieces_template<Piece::ROOK, e>();
-    while (rooks) {
-        const Square rook_sq = utility::bit::lsb_and_pop_to_square(rooks);
-        const ull rook_bb = 1ULL << rook_sq;
-        const ull rook_attacks =
-            get_straight_attacks_mbb(all_pieces & ~rook_bb, rook_sq);
-        const ull rook_check_moves = rook_attacks & straight_check_destinations;
-        info.rook_checks += bits_in(rook_check_moves);
-    }
-
-    ull bishops = get_pieces_template<Piece::BISHOP, e>();
-    while (bishops) {
-        const Square bishop_sq = utility::bit::lsb_and_pop_to_square(bishops);
-        const ull bishop_bb = 1ULL << bishop_sq;
-        const ull bishop_attacks =
-            get_diagonal_attacks_mbb(all_pieces & ~bishop_bb, bishop_sq);
-        const ull bishop_check_moves = bishop_attacks & diagonal_check_destinations;
-        info.bishop_checks += bits_in(bishop_check_moves);
-    }
-
-    ull knight_check_destinations =
-        tables::movegen::knight_attack_table[king_sq];
-    knight_check_destinations &= ~enemy_occupied;
-
-    ull knights = get_pieces_template<Piece::KNIGHT, e>();
-    while (knights) {
-        const Square knight_sq = utility::bit::lsb_and_pop_to_square(knights);
-        const ull knight_moves = tables::movegen::knight_attack_table[knight_sq];
-        const ull knight_check_moves = knight_moves & knight_check_destinations;
-        info.knight_checks += bits_in(knight_check_moves);
-    }
-
-    info.total_checks =
-        info.queen_checks +
-        info.rook_checks +
-        info.bishop_checks +
-        info.knight_checks;
-
-    return info;
-}
-
-
-
-template<Color c>
-int GameBoard::count_potential_checks_against_king_t()
-{
-    const PotentialCheckInfo info = potential_checks_against_king_t<c>();
-    return info.queen_checks +
-           info.rook_checks +
-           info.bishop_checks +
-           info.knight_checks;
-}
-
-
 // ---------- potential_checks_against_king_cp_t ----------
-template<Color c> int GameBoard::potential_checks_against_king_cp_t()
+template<Color c> int GameBoard::potential_checks_against_king_cp_t(const AttackInfo& attack_info) const
 {
-    static const int penalty_table[] = {
-        0,    // 0 checks
-        0,    // 1 check
-        0,    // 2 checks
-        10,   // 3 checks
-        30,   // 4 checks
-        100,   // 5 checks
-        220,  // 6 checks
-        300,  // 7 checks
-        400   // 8+ checks
-    };
-
-    int n = count_potential_checks_against_king_t<c>();
+    constexpr Color e = utility::representation::opposite_color_t<c>;
+    int n = attack_info.checks[e].total_checks;
     if (n > 8) n = 8;
 
-    return -penalty_table[n];
+    return -potential_check_penalty_cp[n];
 }
 
 
 
-template<Color c>
-int GameBoard::get_king_near_squares_t(int king_near_squares_out[9])
-{
-    int count = 0;
-
-    ull kbb = get_pieces_template<Piece::KING, c>();
-    assert(kbb != 0ULL);    // Must be a king
-
-    ull tmp = kbb;
-    Square king_sq = utility::bit::lsb_and_pop_to_square(tmp);
-
-    int king_row = king_sq >> 3;
-    int king_col = king_sq & 7;
-
-    for (int dr = -1; dr <= 1; ++dr) {
-        for (int dc = -1; dc <= 1; dc++) {
-            int r = king_row + dr;
-            int cc = king_col + dc;
-            if (r < 0 || r > 7 || cc < 0 || cc > 7)
-                continue;
-            king_near_squares_out[count++] = r * 8 + cc;
-        }
-    }
-
-    return count;
-}
-
 template<Color c>
 int GameBoard::sliders_and_knights_attacking_square2_t(int sq)
 {
@@ -3699,24 +2902,109 @@ int GameBoard::sliders_and_knights_attacking_square2_t(int sq)
 }
 
 // ---------- attackers_on_enemy_king_near_cp_t ----------
+// Each pawn, knight, bishop, rook and queen of color c counts once for each square of the enemy king zone it attacks.
 template<Color c>
-int GameBoard::attackers_on_enemy_king_near_cp_t()
+int GameBoard::attackers_on_enemy_king_near_cp_t(const AttackInfo& attack_info) const
 {
-    constexpr Color defender_color = utility::representation::opposite_color_t<c>;
+    return (attack_info.king_zone_hits[c] * wghts.GetWeight(ATTACKERS_ON_KING));
+}
 
-    int king_near_squares[9];
-    int count = get_king_near_squares_t<defender_color>(king_near_squares);
 
-    int total = 0;
+//
+// Builds the attack maps for both colors: set-wise shifts for the pawns, one table or magic lookup per
+// piece for the rest. The counts (king zone, center, checks) are made here too, while each piece's own
+// attacks are at hand.
+void GameBoard::build_attack_info(AttackInfo& attack_info) const
+{
+    const ull occ = get_pieces();
+    const ull FILE_H = col_masks[ColHA::COL_H];
+    const ull FILE_A = col_masks[ColHA::COL_A];
+    const ull center = (1ULL << square_e4) | (1ULL << square_d4) | (1ULL << square_e5) | (1ULL << square_d5);
+
+    // Per king: its zone, and the squares a piece would give check from (not holding the checker's own piece)
+    ull straight_checks[2];
+    ull diagonal_checks[2];
+    ull knight_checks[2];
+    for (const Color c : {Color::WHITE, Color::BLACK}) {
+        const int king_sq = utility::bit::bitboard_to_lowest_square_fast((c == Color::WHITE) ? white_king : black_king);
+        const ull checkers_own = get_pieces(utility::representation::opposite_color(c));
+
+        attack_info.king_zone[c] = tables::movegen::king_attack_table[king_sq] | (1ULL << king_sq);
+        straight_checks[c] = get_straight_attacks_mbb(occ, king_sq) & ~checkers_own;
+        diagonal_checks[c] = get_diagonal_attacks_mbb(occ, king_sq) & ~checkers_own;
+        knight_checks[c]   = tables::movegen::knight_attack_table[king_sq] & ~checkers_own;
+    }
+
+    for (const Color c : {Color::WHITE, Color::BLACK}) {
+        const Color e = utility::representation::opposite_color(c);
+        const ull enemy_zone = attack_info.king_zone[e];
+
+        ull* by_piece = attack_info.by_piece[c];
+        ull& all = attack_info.all[c];
+        ull& twice = attack_info.double_attacks[c];
+        int& zone_hits = attack_info.king_zone_hits[c];
+        PotentialCheckInfo& checks = attack_info.checks[c];
+
+        for (int p = 0; p < NUM_PIECES; p++) by_piece[p] = 0ULL;
+        all = 0ULL;
+        twice = 0ULL;
+        zone_hits = 0;
+        attack_info.center_knight_hits[c] = 0;
+        checks = PotentialCheckInfo{};
+
+        auto add = [&](Piece p, ull attacks) {
+            twice |= all & attacks;
+            all |= attacks;
+            by_piece[p] |= attacks;
+        };
 
-    for (int i = 0; i < count; ++i) {
-        int sq = king_near_squares[i];
-        int nAttackers = sliders_and_knights_attacking_square2_t<c>(sq);
-        total += nAttackers;
-        total += pawns_attacking_square_t<c>(sq);
-    }
+        // Pawns, toward either edge. A square in both sets is attacked by two pawns.
+        const ull pawns = get_pieces(c, Piece::PAWN);
+        const ull pawn_left  = (c == Color::WHITE) ? ((pawns & ~FILE_A) << 9) : ((pawns & ~FILE_H) >> 9);
+        const ull pawn_right = (c == Color::WHITE) ? ((pawns & ~FILE_H) << 7) : ((pawns & ~FILE_A) >> 7);
+        zone_hits += bits_in(pawn_left & enemy_zone) + bits_in(pawn_right & enemy_zone);
+        add(Piece::PAWN, pawn_left);
+        add(Piece::PAWN, pawn_right);
 
-    return (total*wghts.GetWeight(ATTACKERS_ON_KING));
+        ull knights = get_pieces(c, Piece::KNIGHT);
+        while (knights) {
+            const ull attacks = tables::movegen::knight_attack_table[utility::bit::lsb_and_pop_to_square(knights)];
+            zone_hits += bits_in(attacks & enemy_zone);
+            attack_info.center_knight_hits[c] += bits_in(attacks & center);
+            checks.knight_checks += bits_in(attacks & knight_checks[e]);
+            add(Piece::KNIGHT, attacks);
+        }
+
+        ull bishops = get_pieces(c, Piece::BISHOP);
+        while (bishops) {
+            const ull attacks = get_diagonal_attacks_mbb(occ, utility::bit::lsb_and_pop_to_square(bishops));
+            zone_hits += bits_in(attacks & enemy_zone);
+            checks.bishop_checks += bits_in(attacks & diagonal_checks[e]);
+            add(Piece::BISHOP, attacks);
+        }
+
+        ull rooks = get_pieces(c, Piece::ROOK);
+        while (rooks) {
+            const ull attacks = get_straight_attacks_mbb(occ, utility::bit::lsb_and_pop_to_square(rooks));
+            zone_hits += bits_in(attacks & enemy_zone);
+            checks.rook_checks += bits_in(attacks & straight_checks[e]);
+            add(Piece::ROOK, attacks);
+        }
+
+        ull queens = get_pieces(c, Piece::QUEEN);
+        while (queens) {
+            const int sq = utility::bit::lsb_and_pop_to_square(queens);
+            const ull attacks = get_straight_attacks_mbb(occ, sq) | get_diagonal_attacks_mbb(occ, sq);
+            zone_hits += bits_in(attacks & enemy_zone);
+            checks.queen_checks += bits_in(attacks & (straight_checks[e] | diagonal_checks[e]));
+            add(Piece::QUEEN, attacks);
+        }
+
+        const ull king = (c == Color::WHITE) ? white_king : black_king;
+        add(Piece::KING, tables::movegen::king_attack_table[utility::bit::bitboard_to_lowest_square_fast(king)]);
+
+        checks.total_checks = checks.queen_checks + checks.rook_checks + checks.bishop_checks + checks.knight_checks;
+    }
 }
 
 // ---------- kings_far_apart_t ----------
@@ -3768,19 +3056,6 @@ double GameBoard::kings_close_toegather_cp_t() {
     return (int)(dFarness * wghts.GetWeight(KINGS_CLOSE_TOGETHER));
 }
 
-// ---------- king_centerness_cp_t ----------
-template<Color c>
-int GameBoard::king_centerness_cp_t() {
-    //double dkk = kings_far_apart_t<c>();
-
-    int itemp = king_center_manhattan_dist_t<c>();
-
-    int iFarness = 6 - itemp;
-    assert (iFarness>=0.0);
-    return (int)(iFarness * wghts.GetWeight(KING_CENTER_LATE));
-}
-
-
 // ---------- hasNoMajorPieces_t ----------
 template<Color c>
 bool GameBoard::hasNoMajorPieces_t() {
@@ -3798,24 +3073,6 @@ bool GameBoard::hasNoMajorPieces_t() {
     return true;
 }
 
-// ---------- is_knight_on_edge_cp_t ----------
-template<Color c>
-int GameBoard::is_knight_on_edge_cp_t() {
-    int pointsOff=0;
-    ull knghts = get_pieces_template<Piece::KNIGHT, c>();
-    if (!knghts) return 0;
-
-    while (knghts) {
-        Square s  = utility::bit::lsb_and_pop_to_square(knghts);
-        const int f = s & 7;
-        const int r = s >> 3;
-        if ((f==0) || (f==7)) pointsOff += wghts.GetWeight(KNIGHT_ON_EDGE);
-        if ((r==0) || (r==7)) pointsOff += wghts.GetWeight(KNIGHT_ON_EDGE);
-    }
-    return pointsOff;
-}
-
-
 template<Color c> int GameBoard::blocked_home_bishops_cp_t()
 {
     int cp = 0;
@@ -4112,10 +3369,8 @@ template int GameBoard::get_castled_bonus_cp_t<Color::BLACK>(int,const PInfo& PI
 template int GameBoard::center_closeness_bonus<Color::WHITE>();
 template int GameBoard::center_closeness_bonus<Color::BLACK>();
 
-template int GameBoard::get_material_for_color_t<Color::WHITE>(int& cp_pawns_only);
-template int GameBoard::get_material_for_color_t<Color::BLACK>(int& cp_pawns_only);
-template int GameBoard::get_material_for_color2_t<Color::WHITE>(int& cp_pawns_only);
-template int GameBoard::get_material_for_color2_t<Color::BLACK>(int& cp_pawns_only);
+template int GameBoard::get_material_for_color_t<Color::WHITE>(int& cp_pawns_only) const;
+template int GameBoard::get_material_for_color_t<Color::BLACK>(int& cp_pawns_only) const;
 
 // pawns_attacking_square_t
 template int GameBoard::pawns_attacking_square_t<Color::WHITE>(int);
@@ -4130,13 +3385,9 @@ template int GameBoard::pawns_attacking_center_squares_cp_fast_t<Color::WHITE>()
 template int GameBoard::pawns_attacking_center_squares_cp_fast_t<Color::BLACK>();
 
 
-// knights_attacking_square_t
-template int GameBoard::knights_attacking_square_t<Color::WHITE>(int);
-template int GameBoard::knights_attacking_square_t<Color::BLACK>(int);
-
 // knights_attacking_center_squares_cp_t
-template int GameBoard::knights_attacking_center_squares_cp_t<Color::WHITE>();
-template int GameBoard::knights_attacking_center_squares_cp_t<Color::BLACK>();
+template int GameBoard::knights_attacking_center_squares_cp_t<Color::WHITE>(const AttackInfo&) const;
+template int GameBoard::knights_attacking_center_squares_cp_t<Color::BLACK>(const AttackInfo&) const;
 
 // bishops_attacking_square_t
 template int GameBoard::bishops_attacking_square_t<Color::WHITE>(int);
@@ -4219,25 +3470,16 @@ template int GameBoard::queenOnCenterSquare_cp_t<Color::BLACK>();
 // template int GameBoard::moved_f_pawn_early_cp_t<Color::WHITE>() const;
 // template int GameBoard::moved_f_pawn_early_cp_t<Color::BLACK>() const;
 
-// get_king_near_squares_t
-template PotentialCheckInfo GameBoard::potential_checks_against_king_t<Color::WHITE>();
-template PotentialCheckInfo GameBoard::potential_checks_against_king_t<Color::BLACK>();
-template int GameBoard::count_potential_checks_against_king_t<Color::WHITE>();
-template int GameBoard::count_potential_checks_against_king_t<Color::BLACK>();
-template int GameBoard::potential_checks_against_king_cp_t<Color::WHITE>();
-template int GameBoard::potential_checks_against_king_cp_t<Color::BLACK>();
-
-
-
-template int GameBoard::get_king_near_squares_t<Color::WHITE>(int[9]);
-template int GameBoard::get_king_near_squares_t<Color::BLACK>(int[9]);
+// potential_checks_against_king_cp_t
+template int GameBoard::potential_checks_against_king_cp_t<Color::WHITE>(const AttackInfo&) const;
+template int GameBoard::potential_checks_against_king_cp_t<Color::BLACK>(const AttackInfo&) const;
 
 template int GameBoard::sliders_and_knights_attacking_square2_t<Color::WHITE>(int);
 template int GameBoard::sliders_and_knights_attacking_square2_t<Color::BLACK>(int);
 
 // attackers_on_enemy_king_near_cp_t
-template int GameBoard::attackers_on_enemy_king_near_cp_t<Color::WHITE>();
-template int GameBoard::attackers_on_enemy_king_near_cp_t<Color::BLACK>();
+template int GameBoard::attackers_on_enemy_king_near_cp_t<Color::WHITE>(const AttackInfo&) const;
+template int GameBoard::attackers_on_enemy_king_near_cp_t<Color::BLACK>(const AttackInfo&) const;
 
 template int GameBoard::rook_endgame_keep_rooks_when_down_cp_t<Color::WHITE>();
 template int GameBoard::rook_endgame_keep_rooks_when_down_cp_t<Color::BLACK>();
@@ -4249,24 +3491,14 @@ template int GameBoard::blocked_home_bishops_cp_t<Color::BLACK>();
 template double GameBoard::kings_far_apart_t<Color::WHITE>();
 template double GameBoard::kings_far_apart_t<Color::BLACK>();
 
-template int GameBoard::king_center_manhattan_dist_t<Color::WHITE>();
-template int GameBoard::king_center_manhattan_dist_t<Color::BLACK>();
-
 // kings_close_toegather_cp_t
 template double GameBoard::kings_close_toegather_cp_t<Color::WHITE>();
 template double GameBoard::kings_close_toegather_cp_t<Color::BLACK>();
 
-template int GameBoard::king_centerness_cp_t<Color::WHITE>();
-template int GameBoard::king_centerness_cp_t<Color::BLACK>();
-
 // hasNoMajorPieces_t
 template bool GameBoard::hasNoMajorPieces_t<Color::WHITE>();
 template bool GameBoard::hasNoMajorPieces_t<Color::BLACK>();
 
-// is_knight_on_edge_cp_t
-template int GameBoard::is_knight_on_edge_cp_t<Color::WHITE>();
-template int GameBoard::is_knight_on_edge_cp_t<Color::BLACK>();
-
 // development_minor_cp_t
 template int GameBoard::development_minor_cp_t<Color::WHITE>();
 template int GameBoard::development_minor_cp_t<Color::BLACK>();
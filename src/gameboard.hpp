@@ -56,6 +56,17 @@ struct PawnFileInfo {
     int passed_cp[2];
 };
 
+//
+// A piece-square score, in centipawns. mg is used before GamePhase::ENDGAME, eg from it on.
+struct PsqScore {
+    int mg = 0;
+    int eg = 0;
+
+    PsqScore& operator+=(const PsqScore& o) { mg += o.mg; eg += o.eg; return *this; }
+    PsqScore& operator-=(const PsqScore& o) { mg -= o.mg; eg -= o.eg; return *this; }
+};
+
+// Checking moves (to empty or enemy occupied squares) a side has available against one king
 struct PotentialCheckInfo {
     int queen_checks;
     int rook_checks;
@@ -63,6 +74,18 @@ struct PotentialCheckInfo {
     int knight_checks;
     int total_checks;
 };
+
+// Attack maps for both colors. Built once per eval (GameBoard::build_attack_info()), and read by
+// every eval term that needs to know what attacks what. Indexed by the attacking color.
+struct AttackInfo {
+    ull by_piece[2][NUM_PIECES];    // Squares attacked by each piece type
+    ull all[2];                     // Squares attacked by any piece
+    ull double_attacks[2];          // Squares attacked at least twice
+    ull king_zone[2];               // The king square and the squares next to it (of the color, not the attacker)
+    int king_zone_hits[2];          // Attacker/square pairs on the enemy king zone, kings not counted
+    int center_knight_hits[2];      // Knight/square pairs on d4, e4, d5, e5
+    PotentialCheckInfo checks[2];   // Checks available against the enemy king
+};
 // #define friendlyP 0 
 // #define enemyP    1
 
@@ -123,25 +146,39 @@ class GameBoard {
 
         void set_zobrist();
 
-        // Computes "Bits_In" arrays (used by eval routines as shortcuts for "bits_in())")
-        uint8_t Bits_In[2][NUM_PIECES];
-        inline void compute_bits_in()
-        {
-            Bits_In[Color::WHITE][Piece::PAWN]   = bits_in(white_pawns);
-            Bits_In[Color::WHITE][Piece::KNIGHT] = bits_in(white_knights);
-            Bits_In[Color::WHITE][Piece::BISHOP] = bits_in(white_bishops);
-            Bits_In[Color::WHITE][Piece::ROOK]   = bits_in(white_rooks);
-            Bits_In[Color::WHITE][Piece::QUEEN]  = bits_in(white_queens);
-            Bits_In[Color::WHITE][Piece::KING]   = bits_in(white_king);
-
-            Bits_In[Color::BLACK][Piece::PAWN]   = bits_in(black_pawns);
-            Bits_In[Color::BLACK][Piece::KNIGHT] = bits_in(black_knights);
-            Bits_In[Color::BLACK][Piece::BISHOP] = bits_in(black_bishops);
-            Bits_In[Color::BLACK][Piece::ROOK]   = bits_in(black_rooks);
-            Bits_In[Color::BLACK][Piece::QUEEN]  = bits_in(black_queens);
-            Bits_In[Color::BLACK][Piece::KING]   = bits_in(black_king);
+        //
+        // Piece counts, material and piece-square score. pushMove_t() and popMove_t() (Engine) keep these up
+        // to date as the pieces move, so the eval only reads them. set_material_and_psq() computes them from
+        // scratch, as set_zobrist() does for the keys.
+        uint8_t Bits_In[2][NUM_PIECES];     // Shortcuts for "bits_in()"
+        int material_cp[2];                 // Centipawns, all but the king
+        PsqScore psq[2];
+        uint64_t material_key = 0;          // Zobrist of the piece counts (zobrist_material[piece][Nth one])
+
+        void set_material_and_psq();
+        bool material_and_psq_are_valid() const;    // Same as from scratch?
+
+        inline void eval_add_piece(Color c, Piece p, int sq) {
+            material_key ^= zobrist_material[p + c * 6][Bits_In[c][p]];
+            ++Bits_In[c][p];
+            material_cp[c] += centipawn_score_of(p);
+            psq[c] += psq_table[p][sq];
+        }
+        inline void eval_remove_piece(Color c, Piece p, int sq) {
+            --Bits_In[c][p];
+            material_key ^= zobrist_material[p + c * 6][Bits_In[c][p]];
+            material_cp[c] -= centipawn_score_of(p);
+            psq[c] -= psq_table[p][sq];
+        }
+        inline void eval_move_piece(Color c, Piece p, int from_sq, int to_sq) {
+            psq[c] -= psq_table[p][from_sq];
+            psq[c] += psq_table[p][to_sq];
         }
 
+        // Built from the weights (after VOLUME_CONTROL). The terms are the same for both colors.
+        PsqScore psq_table[NUM_PIECES][64];
+        void init_psq_table();
+
         void set_development_start_masks();
         ull start_knights_bb[2];
         ull start_bishops_bb[2];
@@ -187,7 +224,7 @@ class GameBoard {
             else {assert(0);return 0;}
         }
 
-        inline ull get_pieces(Color color) {
+        inline ull get_pieces(Color color) const {
             if (color == Color::WHITE) {
                 return white_pawns | white_rooks | white_knights | 
                     white_bishops | white_queens | white_king;
@@ -204,7 +241,7 @@ class GameBoard {
 
         }
 
-        inline ull get_pieces(Piece piece_type) {
+        inline ull get_pieces(Piece piece_type) const {
             if (piece_type == Piece::PAWN) {
                 return black_pawns | white_pawns;
             }
@@ -230,7 +267,7 @@ class GameBoard {
             }
         }
 
-        inline ull get_pieces(Color color, Piece piece_type) {
+        inline ull get_pieces(Color color, Piece piece_type) const {
             return get_pieces(piece_type) & get_pieces(color);
         }
 
@@ -322,8 +359,7 @@ class GameBoard {
         template<Color c> int pawns_attacking_center_squares_cp_t();
         template<Color c> int pawns_attacking_center_squares_cp_fast_t();
 
-        template<Color c> int knights_attacking_square_t(int sq);
-        template<Color c> int knights_attacking_center_squares_cp_t();
+        template<Color c> int knights_attacking_center_squares_cp_t(const AttackInfo& attack_info) const;
 
         template<Color c> int bishops_attacking_center_squares_cp_t();
         template<Color c> int bishops_attacking_square_t(int sq);
@@ -381,14 +417,24 @@ class GameBoard {
         std::string random_960_FEN_strict(void);
 
 
-        template<Color c> int get_king_near_squares_t(int king_near_squares_out[9]);
+        void build_attack_info(AttackInfo& attack_info) const;
+
         int kings_in_opposition(Color defender_color);
         template<Color c> int sliders_and_knights_attacking_square2_t(int sq);
-        template<Color c> int attackers_on_enemy_king_near_cp_t();
+        template<Color c> int attackers_on_enemy_king_near_cp_t(const AttackInfo& attack_info) const;
         
-        template<Color c> PotentialCheckInfo potential_checks_against_king_t();
-        template<Color c> int count_potential_checks_against_king_t();
-        template<Color c> int potential_checks_against_king_cp_t();
+        template<Color c> int potential_checks_against_king_cp_t(const AttackInfo& attack_info) const;
+        static constexpr int potential_check_penalty_cp[9] = {
+            0,    // 0 checks
+            0,    // 1 check
+            0,    // 2 checks
+            10,   // 3 checks
+            30,   // 4 checks
+            100,  // 5 checks
+            220,  // 6 checks
+            300,  // 7 checks
+            400   // 8+ checks
+        };
 
         int attackers_on_enemy_passed_pawns(Color attacker_color,
                                                ull passed_white_pwns,
@@ -402,11 +448,8 @@ class GameBoard {
         double get_board_distance(int x1, int y1, int x2, int y2);
         //int get_board_distance_100(int x1, int y1, int x2, int y2) const;
         template<Color c> double kings_close_toegather_cp_t();
-        template<Color c> int king_centerness_cp_t();
         
         template<Color c> double kings_far_apart_t();
-        template<Color c> int king_center_manhattan_dist_t();
-        template<Color c> int is_knight_on_edge_cp_t();
         template<Color c> int development_minor_cp_t();
         template<Color c> int bishop_outside_world_cp_t();
         template<Color c> bool hasNoMajorPieces_t();
@@ -425,8 +468,7 @@ class GameBoard {
         int rand_new();
 
         template<Color c> int get_castled_bonus_cp_t(int phase, const PInfo& PInfoIn) const;
-        template<Color c> int get_material_for_color_t(int& cp_pawns_only);
-        template<Color c> int get_material_for_color2_t(int& cp_pawns_only);    // faster, but needs compute_bits_in() called first)
+        template<Color c> int get_material_for_color_t(int& cp_pawns_only) const;  // From scratch. The eval uses material_cp[].
         template<Color c> bool bHasCastled_fake_t(int k_rank, int k_file) const;
 
         template<Color c> int count_guard_pawn_files_t(const PInfo& PInfoIn, int k_file) const;
@@ -439,28 +481,13 @@ class GameBoard {
         bool bWhiteCstled = false;
         bool bBlackCstled = false;
 
-        // returns 0 if sq has no attackers. 
-        int SEE_for_capture(Color side, const Move &mv, FILE* fp);
-        int SEE_for_capture_new(Color side, const Move &mv, FILE* fpDebug);
-
-        struct SEEBoards
-        {
-            ull wp, wn, wb, wr, wq, wk;
-            ull bp, bn, bb, br, bq, bk;
-        };
-
-        ull SEE_attackers_on_square_local(Color c,
-                                             int sq,
-                                             ull occ_now,
-                                             const SEEBoards& b) const;
-        int SEE_recursive(Color stm,
-                            Color root_side,
-                            int to_sq,
-                            Piece target_piece,
-                            Color target_color,
-                            ull occ_local,
-                            const SEEBoards& b_local,
-                            int balance_local);
+        //
+        // Static exchange evaluation of a capture on its to square: the material won (or lost) by the side
+        // making it, after the best sequence of recaptures, each side taking with its least valuable piece
+        // and stopping when it likes. En passant counts as 0. Promotions are valued as the pawn.
+        int see(const Move& mv) const;                      // The value, in centipawns
+        bool see_ge(const Move& mv, int threshold) const;   // see(mv) >= threshold, but stops as soon as it knows
+        ull attackers_to(int sq, ull occ) const;            // Both colors. Sliders seen through occ.
 
         inline int centipawn_score_of(ShumiChess::Piece p) const
         {
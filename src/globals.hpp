@@ -12,6 +12,19 @@
 
 #include "score.hpp"
 
+// PEXT slider backend (x86-64 only). The instruction is used only if the CPU has BMI2 (checked at startup).
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SHUMI_PEXT_AVAILABLE 1
+    #include <immintrin.h>
+    #if defined(__GNUC__) || defined(__clang__)
+        #define SHUMI_TARGET_BMI2 __attribute__((target("bmi2")))
+    #else
+        #define SHUMI_TARGET_BMI2
+    #endif
+#else
+    #define SHUMI_PEXT_AVAILABLE 0
+#endif
+
 #ifdef SHUMI_FORCE_ASSERTS  // Operated by the -asserts" and "-no-asserts" args to run_gui.py. By default on.
 #undef NDEBUG
 #endif
@@ -42,8 +55,9 @@ namespace tables::movegen
 
     constexpr std::size_t straight_magic_attack_table_size = 102400;
 
-    extern std::array<StraightMagicEntry, 64> straight_magic_entries;
-    extern std::array<ull, straight_magic_attack_table_size> straight_magic_attack_table;
+    // These are all constexpr, built at compile time in move_tables.cpp
+    extern const std::array<StraightMagicEntry, 64> straight_magic_entries;
+    extern const std::array<ull, straight_magic_attack_table_size> straight_magic_attack_table;
 
     struct DiagonalMagicEntry {
         ull mask = 0ULL;
@@ -54,11 +68,33 @@ namespace tables::movegen
 
     constexpr std::size_t diagonal_magic_attack_table_size = 5248;
 
-    extern std::array<DiagonalMagicEntry, 64> diagonal_magic_entries;
-    extern std::array<ull, diagonal_magic_attack_table_size> diagonal_magic_attack_table;
+    extern const std::array<DiagonalMagicEntry, 64> diagonal_magic_entries;
+    extern const std::array<ull, diagonal_magic_attack_table_size> diagonal_magic_attack_table;
 
     ull get_straight_magic_attack(ull all_pieces_but_self, int square);
     ull get_diagonal_magic_attack(ull all_pieces_but_self, int square);
+
+    //
+    // PEXT backend. Same masks and offsets as the magic tables, but each square's section is indexed by
+    // _pext_u64(occupancy, mask). No multiply, no shift, no magic to load.
+    // use_pext is set at startup, if cpu_has_fast_pext(). The magic tables stay as the fallback.
+    extern const std::array<ull, straight_magic_attack_table_size> straight_pext_attack_table;
+    extern const std::array<ull, diagonal_magic_attack_table_size> diagonal_pext_attack_table;
+    extern bool use_pext;
+
+    bool cpu_has_fast_pext();           // BMI2, and not an AMD before Zen 3 (PEXT is microcoded, and slow, there)
+    bool set_use_pext(bool b_pext);     // Returns what is actually used (false if the CPU can't)
+
+    #if SHUMI_PEXT_AVAILABLE
+    SHUMI_TARGET_BMI2 inline ull get_straight_pext_attack(ull all_pieces_but_self, int square) {
+        const StraightMagicEntry& entry = straight_magic_entries[square];
+        return straight_pext_attack_table[entry.offset + _pext_u64(all_pieces_but_self, entry.mask)];
+    }
+    SHUMI_TARGET_BMI2 inline ull get_diagonal_pext_attack(ull all_pieces_but_self, int square) {
+        const DiagonalMagicEntry& entry = diagonal_magic_entries[square];
+        return diagonal_pext_attack_table[entry.offset + _pext_u64(all_pieces_but_self, entry.mask)];
+    }
+    #endif
 }
 
 
@@ -180,13 +216,14 @@ enum EvalPersons {      // These are all "ai" no human here.
     RANDOM = 0,
     SLUG,
     CRAZY_IVAN,
-    UNCLE_SHUMI
+    UNCLE_SHUMI,
+    NNUE            // Needs a network (nnue::load()). Without one it plays as UNCLE_SHUMI.
 };
 
 //bool is_move_in_list(const Move& mov, const std::vector<Move>& mvs);
 
 
-// ? maybe can use inline here for externs? but it complicates the build. defining in globals.cpp
+// The tables below are all inline constexpr, built by the compiler. Nothing to initialize at startup.
 
 enum Row {
     ROW_1 = 0,
@@ -215,17 +252,92 @@ enum ColHA {
 
 // TODO move all this to movegen
 
-extern ull a_row;
-extern ull a_col;
-extern std::vector<ull> row_masks;
-extern std::vector<ull> col_masks;
+// Bitboard of the "a" row (rank)
+inline constexpr ull a_row = 1ULL << 0 | 1ULL << 1 | 1ULL << 2 | 1ULL << 3 |
+                             1ULL << 4 | 1ULL << 5 | 1ULL << 6 | 1ULL << 7;
+
+// Bitboard of the "h" column (file)
+inline constexpr ull h_col = 1ULL << 0 | 1ULL << 8 | 1ULL << 16 | 1ULL << 24 |
+                             1ULL << 32 | 1ULL << 40 | 1ULL << 48 | 1ULL << 56;
+
+// bitboards of the various rows (ranks) and columns (files). Indexed by Row and ColHA.
+inline constexpr std::array<ull, 8> row_masks = {
+    a_row,
+    a_row << 8,
+    a_row << 16,
+    a_row << 24,
+    a_row << 32,
+    a_row << 40,
+    a_row << 48,
+    a_row << 56
+};
+
+inline constexpr std::array<ull, 8> col_masks = {
+    h_col,         // H-file
+    h_col << 1,    // G-file
+    h_col << 2,    // F-file
+    h_col << 3,    // E-file
+    h_col << 4,    // D-file
+    h_col << 5,    // C-file
+    h_col << 6,    // B-file
+    h_col << 7     // A-file
+};
 
-extern uint64_t zobrist_piece_square[12][64];
-extern uint64_t zobrist_enpassant[8];
-extern uint64_t zobrist_castling[16];
-extern uint64_t zobrist_side;
 
-void initialize_zobrist();
+// One number for each piece at each square
+// One number to indicate the side to move is black
+// Four numbers to indicate the castling rights, though usually 16 (2^4) are used for speed
+// Eight numbers to indicate the file of a valid En passant square, if any
+// This leaves us with 793 numbers (12*64 + 1 + 16 + 8)
+// Then, for the material key, one number for each piece and count (the Nth knight, ...)
+struct ZobristKeys {
+    uint64_t piece_square[12][64] = {};
+    uint64_t enpassant[8] = {};
+    uint64_t castling[16] = {};
+    uint64_t side = 0;
+    uint64_t material[12][16] = {};
+};
+
+// A 64-bit Linear Congruential Generator (LCG) [Numerical Recipes (3rd edition)], filled in the order above
+constexpr ZobristKeys init_zobrist_keys() {
+    constexpr uint64_t a = 6364136223846793005ULL; // multiplier
+    constexpr uint64_t c = 1442695040888963407ULL; // increment
+    constexpr uint64_t m = UINT64_MAX;             // modulus
+    uint64_t state = 123456789;
+    auto next = [&state]() {
+        state = (a * state + c) % m;
+        return state;
+    };
+
+    ZobristKeys keys = {};
+    for (int i = 0; i < 12; i++) {
+        for (int j = 0; j < 64; j++) {
+            keys.piece_square[i][j] = next();
+        }
+    }
+    for (int i = 0; i < 8; i++) {
+        keys.enpassant[i] = next();
+    }
+    for (int i = 0; i < 16; i++) {
+        keys.castling[i] = next();
+    }
+    keys.side = next();
+    for (int i = 0; i < 12; i++) {
+        for (int j = 0; j < 16; j++) {
+            keys.material[i][j] = next();
+        }
+    }
+    return keys;
+}
+
+inline constexpr ZobristKeys zobrist_keys = init_zobrist_keys();
+
+inline constexpr const uint64_t (&zobrist_piece_square)[12][64] = zobrist_keys.piece_square;
+inline constexpr const uint64_t (&zobrist_enpassant)[8] = zobrist_keys.enpassant;
+inline constexpr const uint64_t (&zobrist_castling)[16] = zobrist_keys.castling;
+inline constexpr uint64_t zobrist_side = zobrist_keys.side;
+inline constexpr const uint64_t (&zobrist_material)[12][16] = zobrist_keys.material;
+
 inline uint64_t zobrist_piece_square_get(int i, int j) {
     // assert (i>= 0);
     // assert (i< 12);
@@ -234,22 +346,71 @@ inline uint64_t zobrist_piece_square_get(int i, int j) {
     return zobrist_piece_square[i][j];
 }
 
-extern std::array<int, 64> square_to_y;
-extern std::array<int, 64> square_to_x;
-
-extern std::array<ull, 65> north_east_square_ray;
-extern std::array<ull, 65> north_west_square_ray;
-extern std::array<ull, 65> south_east_square_ray;
-extern std::array<ull, 65> south_west_square_ray;
+//
+// 8 directional "ray" bitboards for every board square (0..63).
+//
+// A "ray" is a 64-bit mask with 1-bits on every square reachable by sliding
+// from the origin square in a given direction until the edge of the board
+// (origin square itself is NOT included).
+//
+// These tables support fast rook/bishop/queen move generation:
+//   - masked_blockers = all_pieces & ray[square]   (pieces that block that ray)
+//   - if blockers exist, trim the ray past the nearest blocker
+//   - if no blockers exist, the attack set is the full ray
+//
+// square_to_x[s] and square_to_y[s] store file/rank coordinates derived from
+// the engine's square indexing (here: x = s % 8, y = s / 8).
+//
+// Sentinel index 64:
+//   ray[64] is 0 for every direction. This allows code to use 64 as a
+//   "no blocker" sentinel (e.g., blockerSquare = 64) without out-of-bounds
+//   access: ~ray[64] & ray[square] becomes (~0) & ray[square] == ray[square].
+
+constexpr std::array<int, 64> init_square_to_y() {
+    std::array<int, 64> to_y = {};
+    for (int square = 0; square < 64; square++) to_y[square] = square / 8;
+    return to_y;
+}
 
-extern std::array<ull, 65> north_square_ray;
-extern std::array<ull, 65> south_square_ray;
-extern std::array<ull, 65> east_square_ray;
-extern std::array<ull, 65> west_square_ray;
+constexpr std::array<int, 64> init_square_to_x() {
+    std::array<int, 64> to_x = {};
+    for (int square = 0; square < 64; square++) to_x[square] = square % 8;
+    return to_x;
+}
 
-void initialize_rays();
+inline constexpr std::array<int, 64> square_to_y = init_square_to_y();
+inline constexpr std::array<int, 64> square_to_x = init_square_to_x();
+
+// (step_x, step_y) is the direction. x grows toward the a-file, so "east" is a negative step_x.
+constexpr std::array<ull, 65> init_square_ray(int step_x, int step_y) {
+    std::array<ull, 65> ray = {};
+    for (int square = 0; square < 64; square++) {
+        for (int i = 1; i < 8; i++) {
+            const int x = square % 8 + step_x * i;
+            const int y = square / 8 + step_y * i;
+            if (x < 0 || x >= 8 || y < 0 || y >= 8) break;
+            ray[square] |= 1ULL << (y * 8 + x);
+        }
+    }
+    return ray;
+}
 
-extern std::vector<Piece> promotion_values;
+inline constexpr std::array<ull, 65> north_east_square_ray = init_square_ray(-1, +1);
+inline constexpr std::array<ull, 65> north_west_square_ray = init_square_ray(+1, +1);
+inline constexpr std::array<ull, 65> south_east_square_ray = init_square_ray(-1, -1);
+inline constexpr std::array<ull, 65> south_west_square_ray = init_square_ray(+1, -1);
+
+inline constexpr std::array<ull, 65> north_square_ray = init_square_ray(0, +1);
+inline constexpr std::array<ull, 65> south_square_ray = init_square_ray(0, -1);
+inline constexpr std::array<ull, 65> east_square_ray = init_square_ray(-1, 0);
+inline constexpr std::array<ull, 65> west_square_ray = init_square_ray(+1, 0);
+
+inline constexpr std::array<Piece, 4> promotion_values = {
+    Piece::BISHOP,
+    Piece::KNIGHT,
+    Piece::ROOK,
+    Piece::QUEEN
+};
 
 
 // Note: I should not be here
@@ -301,9 +462,13 @@ inline ull get_diagonal_attacks(ull all_pieces_but_self, int square)
     return (ne_attacks | nw_attacks | se_attacks | sw_attacks);
 }
 
-// mbb means magic bitboards
+// mbb means magic bitboards (or PEXT bitboards, if the CPU has fast PEXT)
 inline ull get_diagonal_attacks_mbb(ull all_pieces_but_self, int square)
 {
+    #if SHUMI_PEXT_AVAILABLE
+    if (tables::movegen::use_pext) return tables::movegen::get_diagonal_pext_attack(all_pieces_but_self, square);
+    #endif
+
     // Get the precomputed magic-bitboard data for this bishop/diagonal square.
     // This entry contains:
     //   mask   : the relevant blocker squares for this square, excluding edge squares
@@ -377,9 +542,13 @@ inline ull get_straight_attacks(ull all_pieces_but_self, int square)
     return (n_attacks | s_attacks | w_attacks | e_attacks);
 }
 
-// mbb means magic bitboards
+// mbb means magic bitboards (or PEXT bitboards, if the CPU has fast PEXT)
 inline ull get_straight_attacks_mbb(ull all_pieces_but_self, int square)
 {
+    #if SHUMI_PEXT_AVAILABLE
+    if (tables::movegen::use_pext) return tables::movegen::get_straight_pext_attack(all_pieces_but_self, square);
+    #endif
+
     const tables::movegen::StraightMagicEntry& entry = tables::movegen::straight_magic_entries[square];
     const ull blockers = all_pieces_but_self & entry.mask;
     const std::size_t magic_index = (blockers * entry.magic) >> entry.shift;
@@ -0,0 +1,31 @@
+#include <algorithm>
+#include <cstring>
+
+#include "material_hash_table.hpp"
+
+
+//
+// Sizes the table to the largest power of two number of entries that fits in size_kb kilobytes.
+void MaterialHashTable::resize(std::size_t size_kb) {
+
+    size_kb = std::clamp<std::size_t>(size_kb, 1, MAX_SIZE_KB);
+
+    const std::size_t max_entries = (size_kb * 1024) / sizeof(Entry);
+    std::size_t n_new = 1;
+    while ((n_new * 2) <= max_entries) n_new *= 2;
+
+    entries.reset();
+    entries.reset(new Entry[n_new]);
+    n_entries = n_new;
+    index_mask = n_entries - 1;
+    size_in_kb = size_kb;
+
+    clear();
+}
+
+
+void MaterialHashTable::clear() {
+    if (n_entries > 0) {
+        std::memset(static_cast<void*>(entries.get()), 0, n_entries * sizeof(Entry));
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "gameboard.hpp"
+#include "endgame.hpp"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Material hash. Caches everything in the eval that depends only on the piece counts, by
+// GameBoard::material_key. Few material signatures come up in one search, so the table is small,
+// and almost every eval is one lookup.
+//
+// Direct mapped, like the pawn hash. Each search thread owns its own table.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace ShumiChess {
+
+struct MaterialInfo {
+
+    static constexpr int SCALE_NORMAL = 64;
+
+    int phase;                          // GamePhase from material (and queens). The castling part is per eval.
+    std::uint8_t scale[2];              // By color, out of SCALE_NORMAL. Shrinks the eval when that color is ahead.
+    EndgameEvalFn endgame;              // Specialized evaluator for this material, or nullptr
+    Color endgame_strong;               // The side endgame() scores for
+    bool endgame_is_exact;              // endgame() is known, not guessed. The search can stop there.
+};
+
+}
+
+class MaterialHashTable {
+public:
+
+    static constexpr std::size_t DEFAULT_SIZE_KB = 256;
+    static constexpr std::size_t MAX_SIZE_KB = 64 * 1024;
+
+    MaterialHashTable() = default;      // Empty. Call resize() before use.
+    MaterialHashTable(const MaterialHashTable&) = delete;
+    MaterialHashTable& operator=(const MaterialHashTable&) = delete;
+
+    void resize(std::size_t size_kb);   // Rounds down to a power of two number of entries. Clears.
+    void clear();                       // New game
+
+    // Returns NULL on a miss.
+    const ShumiChess::MaterialInfo* probe(std::uint64_t material_key) const {
+        const Entry& e = entries[material_key & index_mask];
+        return (e.used && e.key == material_key) ? &e.info : nullptr;
+    }
+
+    // Returns the stored copy.
+    const ShumiChess::MaterialInfo& store(std::uint64_t material_key, const ShumiChess::MaterialInfo& info) {
+        Entry& e = entries[material_key & index_mask];
+        e.key  = material_key;
+        e.used = true;
+        e.info = info;
+        return e.info;
+    }
+
+    std::size_t size_kb() const { return size_in_kb; }
+    std::size_t capacity() const { return n_entries; }
+
+private:
+
+    struct Entry {
+        std::uint64_t key;
+        bool used;              // clear() zeroes the table. Without this, a zeroed entry would hit for key 0.
+        ShumiChess::MaterialInfo info;
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    std::size_t n_entries = 0;
+    std::uint64_t index_mask = 0;
+    std::size_t size_in_kb = 0;
+};
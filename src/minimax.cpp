@@ -1,6 +1,7 @@
 #define _CRT_SECURE_NO_WARNINGS     // To prevent dunb warnings about deprecated "strcpy/sprintf" like functions.
 
 #include <float.h>
+#include <array>
 #include <bitset>
 #include <iomanip>
 #include <sstream>
@@ -31,6 +32,7 @@
 #include "salt.h"
 #include "features.hpp"
 #include "status_output.hpp"
+#include "endgameTables.hpp"
 
 
 
@@ -79,6 +81,8 @@ using namespace utility::bit;
 
 //#define DEBUGGING_PAWN_HASH     // burp3
 
+//#define DEBUGGING_INCREMENTAL_EVAL   // burp4 if the material/piece-square values kept by pushMove_t() are off (and the cached phase)
+
 bool global_debug_flag = false;
 
 #ifdef _DEBUGGING_TO_FILE   // Data used for debug
@@ -187,11 +191,13 @@ MinimaxAI::MinimaxAI(Engine& e) : engine(e) {
     //TTable.clear();
     //TTable.reserve(1'000'000);    // NOTE: What size here? (we dont even normally use this table)
     
-    TTable2.clear();
-    TTable2.reserve(200'000);    // NOTE: What size here? Games seem to use 150,000 max, of EXACT MATCH.
+    TTable2.resize(TranspositionTable::DEFAULT_SIZE_MB);
+
+    pawn_hash.resize(PawnHashTable::DEFAULT_SIZE_KB);
+    material_hash.resize(MaterialHashTable::DEFAULT_SIZE_KB);
 
-    pawn_file_info.clear();
-    pawn_file_info.reserve(1'000'000);    // NOTE: What size here?
+    init_lazy_eval_margins();
+    endgame::init();
 
     // Set default features
     Features_mask = _DEFAULT_FEATURES_MASK;
@@ -226,13 +232,158 @@ MinimaxAI::MinimaxAI(Engine& e) : engine(e) {
 
 
 
+//
+// Lazy SMP helper. It searches with its own (cloned) engine, but shares the TT2 of main_ai. The TT2 is 
+// not reserved here. The pawn and material hashes are per thread, sized like main_ai's.
+MinimaxAI::MinimaxAI(Engine& e, MinimaxAI& main_ai) : engine(e), smp_main(&main_ai) { 
+
+    Features_mask = main_ai.Features_mask;
+
+    // Each thread has its own pawn hash.
+    pawn_hash.resize(main_ai.pawn_hash.size_kb());
+    material_hash.resize(main_ai.material_hash.size_kb());
+
+    init_lazy_eval_margins();
+    endgame::init();
+
+    excluded_root_moves.clear();
+    std::fill(std::begin(prev_root_best_), std::end(prev_root_best_),
+              std::pair<Move, Score>{});
+}
+
+
+void MinimaxAI::set_pawn_hash_size_kb(std::size_t size_kb) {
+    pawn_hash.resize(size_kb);
+    for (auto& helper : smp_helpers) helper->pawn_hash.resize(size_kb);
+}
+
+
 MinimaxAI::~MinimaxAI() { 
+    smp_stop_helpers();
+
     #ifdef _DEBUGGING_TO_FILE   // close debug file
-        if (fpDebug != NULL) fclose(fpDebug);
+        if (!is_smp_helper() && fpDebug != NULL) fclose(fpDebug);
     #endif
 }
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Lazy SMP. Starts (n_threads-1) helper threads on the current root position. Helpers are kept between 
+// moves, and their engines are re-cloned from the main engine at every start.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+void MinimaxAI::smp_start_helpers() {
+
+    assert(!is_smp_helper());
+    assert(smp_threads.empty());
+
+    const int n_helpers = std::clamp(n_threads, 1, MAX_SEARCH_THREADS) - 1;
+
+    // (Re)build the helper pool when the thread count changes.
+    if ((int)smp_helpers.size() != n_helpers) {
+        smp_helpers.clear();
+        smp_engines.clear();
+        for (int i = 0; i < n_helpers; i++) {
+            smp_engines.push_back(std::make_unique<Engine>(engine));
+            smp_helpers.push_back(std::make_unique<MinimaxAI>(*smp_engines.back(), *this));
+        }
+    }
+
+    smp_helper_nodes = 0;
+    smp_helper_tb_hits = 0;
+    if (n_helpers == 0) return;
+
+    smp_stop = false;
+    smp_active = true;
+
+    for (int i = 0; i < n_helpers; i++) {
+        *smp_engines[i] = engine;           // clone the root position (and its history)
+        smp_engines[i]->reserve_storage_buffers();
+
+        MinimaxAI& helper = *smp_helpers[i];
+        helper.eval_person = eval_person;
+        helper.Features_mask = Features_mask;
+        helper.stop_calculation = false;
+        helper.nodes_visited = 0;
+        helper.nodes_visited_depth_zero = 0;
+        helper.evals_visited = 0;
+        helper.evals_lazy_exits = 0;
+        helper.n_tb_hits = 0;
+        helper.n_exact_endgame_hits = 0;
+        helper.excluded_root_moves = excluded_root_moves;     // tablebase filtered root moves
+        for (int ii=0;ii<MAX_PLY;ii++) {
+            helper.killer1[ii] = {}; 
+            helper.killer2[ii] = {};
+        }
+        std::fill(std::begin(helper.prev_root_best_), std::end(helper.prev_root_best_),
+                  std::pair<Move, Score>{});
+
+        smp_threads.emplace_back(&MinimaxAI::smp_helper_search, &helper, i);
+    }
+}
+
+//
+// Stops and joins the helper threads. Harmless if none are running.
+void MinimaxAI::smp_stop_helpers() {
+
+    if (smp_threads.empty()) return;
+
+    smp_stop = true;
+    for (auto& helper : smp_helpers) helper->stop_calculation = true;
+
+    for (std::thread& t : smp_threads) {
+        if (t.joinable()) t.join();
+    }
+    smp_threads.clear();
+    smp_active = false;
+
+    smp_helper_nodes = 0;
+    smp_helper_tb_hits = 0;
+    for (auto& helper : smp_helpers) {
+        smp_helper_nodes += helper->nodes_visited;
+        smp_helper_tb_hits += helper->n_tb_hits;
+    }
+}
+
+//
+// The helper's own iterative deepening. Full window, no time control, no displays. It just keeps going 
+// deeper until its main thread says stop. Odd helpers start one ply deeper so the threads drift apart.
+void MinimaxAI::smp_helper_search(int helper_id) {
+
+    assert(is_smp_helper());
+
+    int depth = 1 + (helper_id & 1);
+
+    while (!smp_main->smp_stop.load(std::memory_order_relaxed) && (depth < MAXIMUM_DEEPENING)) {
+
+        top_deepening = depth;
+        age_history();
+
+        tuple<Score, Move> ret_val = recursive_negamax(depth
+                                    , -HUGE_SCORE, HUGE_SCORE
+                                    , true              // I am called from the root
+                                    , 1
+                                    , 0
+                                    , true              // the root is a PV node
+                                 );
+
+        const Score d_Return_score = get<0>(ret_val);
+        const Move best_move = get<1>(ret_val);
+
+        if (d_Return_score == ABORT_SCORE) break;
+        if (d_Return_score == ONLY_MOVE_SCORE) break;
+        if (best_move.piece_type == Piece::NONE) break;
+
+        prev_root_best_[depth] = std::make_pair(best_move, d_Return_score);
+
+        if (IS_MATE_SCORE(d_Return_score)) break;
+
+        depth++;
+    }
+}
+
+
 
 template<class T> string MinimaxAI::format_with_commas(T value) {
     stringstream ss;
@@ -275,6 +426,48 @@ void MinimaxAI::hard_abort_end() {
     hard_abort_budget_ms = 0ULL;
 }
 
+void MinimaxAI::ponder_start() {
+    ponder_hit_time_ms = 0;
+    pondering = true;
+}
+
+void MinimaxAI::ponder_hit() {
+    if (!pondering) return;
+    ponder_hit_time_ms = get_time_ms();
+    pondering = false;
+}
+
+ull MinimaxAI::time_before_ponder_hit_ms() const {
+    const ull hit_ms = ponder_hit_time_ms.load();
+    return (hit_ms > search_start_time_ms) ? (hit_ms - search_start_time_ms) : 0ULL;
+}
+
+//
+// Asked after the search. A ponder search can end by itself (a mate, the deepening cap) before the hit.
+// Then only the time up to its end was searched.
+ull MinimaxAI::ponder_free_ms() const {
+    const ull hit_ms = ponder_hit_time_ms.load();
+    if (hit_ms == 0) return 0ULL;
+
+    const ull end_ms = (search_end_time_ms != 0) ? std::min(hit_ms, search_end_time_ms) : hit_ms;
+    return (end_ms > search_start_time_ms) ? (end_ms - search_start_time_ms) : 0ULL;
+}
+
+//
+// The ponder hit (seen by the search thread). The deepening under way gets the move's budget from the 
+// hit, then falls back to the last one completed. Held back emergency (hard) abort comes first.
+void MinimaxAI::start_clock_after_ponder_hit() {
+    ponder_clock_pending = false;
+
+    const ull hit_ms = ponder_hit_time_ms.load();
+    if (hit_ms == 0) return;        // Stopped, not hit. stop_calculation ends the search.
+
+    ull budget_ms = maximum_duration;
+    if (ponder_hard_abort_ms > 0) budget_ms = std::min(budget_ms, ponder_hard_abort_ms);
+    hard_abort_start(budget_ms);
+    hard_abort_start_time_ms = hit_ms;
+}
+
 void MinimaxAI::soft_abort_start(ull soft_duration) {
     soft_abort_budget_ms = soft_duration;
     soft_abort_start_time_ms = get_time_ms();  // milliseconds
@@ -291,6 +484,8 @@ void MinimaxAI::soft_abort_end() {
 
 bool MinimaxAI::should_abort_search_by_time()
 {
+    if (ponder_clock_pending && !pondering) start_clock_after_ponder_hit();
+
     if (!hard_abort_enabled) return false;
     if (hard_abort_budget_ms == 0ULL) return false;
 
@@ -474,48 +669,17 @@ bool MinimaxAI::no_queens_on_board() {
 
 // material_cp must be average material (positive)
 int MinimaxAI::phase_of_game(int material_cp_avg) {
+    assert(material_cp_avg>=0);
+    return castled_phase(material_phase(material_cp_avg, no_queens_on_board()));
+}
 
-    int king_sq;
-    //int king_sq2;
-    int k_file;
-    int k_rank;
-   //ull king_bb;
+//
+// The phase from the material alone (cached in the MaterialInfo).
+int MinimaxAI::material_phase(int material_cp_avg, bool no_queens) {
 
     int nPhase = GamePhase::OPENING;
     assert(material_cp_avg>=0);
 
-
-    // white castling
-    // king_bb = engine.game_board.get_pieces(ShumiChess::Color::WHITE, Piece::KING);
-    // if (!king_bb) {
-    //     assert(0);      // has to be a king!
-    //     return 0;
-    // }
-    //king_sq2 = utility::bit::bitboard_to_lowest_square_fast(king_bb);
-    king_sq = engine.white_king_square;
-    //assert(king_sq == king_sq2);
-
-
-    k_file  = king_sq & 7;
-    k_rank  = king_sq >> 3;
-
-    engine.game_board.bWhiteCstled = engine.game_board.bHasCastled_fake_t<ShumiChess::Color::WHITE>(k_rank, k_file);
-
-    // black castling
-    // king_bb = engine.game_board.get_pieces(ShumiChess::Color::BLACK, Piece::KING);
-    // if (!king_bb) {
-    //     assert(0);      // has to be a king!
-    //     return 0;
-    // }
-    //king_sq2 = utility::bit::bitboard_to_lowest_square_fast(king_bb);
-    king_sq = engine.black_king_square;
-    //assert(king_sq == king_sq2);
-
-    k_file  = king_sq & 7;
-    k_rank  = king_sq >> 3;
-    engine.game_board.bBlackCstled = engine.game_board.bHasCastled_fake_t<ShumiChess::Color::BLACK>(k_rank, k_file);
-
-
     //
     // Each side has MAX_CP_PER_SIDE centipawns at start. 
     //
@@ -534,22 +698,42 @@ int MinimaxAI::phase_of_game(int material_cp_avg) {
     else if (lost_so_far_cp < 3000) nPhase = GamePhase::ENDGAME;
     else                            nPhase = GamePhase::ENDGAME_LATE; // only 1000 cp left
 
+    if ((nPhase == GamePhase::OPENING) || (nPhase == GamePhase::MIDDLE_EARLY)) {
+        if (no_queens) nPhase = GamePhase::MIDDLE;
+    }
+
+    return nPhase;
+}
+
+//
+// The part of the phase that depends on where the kings are.
+int MinimaxAI::castled_phase(int nPhase) {
+
+    int king_sq;
+    int k_file;
+    int k_rank;
+
+    // white castling
+    king_sq = engine.white_king_square;
+    k_file  = king_sq & 7;
+    k_rank  = king_sq >> 3;
+    engine.game_board.bWhiteCstled = engine.game_board.bHasCastled_fake_t<ShumiChess::Color::WHITE>(k_rank, k_file);
+
+    // black castling
+    king_sq = engine.black_king_square;
+    k_file  = king_sq & 7;
+    k_rank  = king_sq >> 3;
+    engine.game_board.bBlackCstled = engine.game_board.bHasCastled_fake_t<ShumiChess::Color::BLACK>(k_rank, k_file);
+
     bool b_both_castled = (engine.game_board.bWhiteCstled && engine.game_board.bBlackCstled);
-    bool b_either_castled = (engine.game_board.bWhiteCstled || engine.game_board.bBlackCstled);
 
-    if (nPhase == GamePhase::OPENING) {
-        if (b_both_castled) nPhase = GamePhase::MIDDLE;         // Turns off all castling incentives
-        if (no_queens_on_board()) nPhase = GamePhase::MIDDLE;
-    }
-    else if (nPhase == GamePhase::MIDDLE_EARLY) {
+    if ((nPhase == GamePhase::OPENING) || (nPhase == GamePhase::MIDDLE_EARLY)) {
         if (b_both_castled) nPhase = GamePhase::MIDDLE;         // Turns off all castling incentives
-        if (no_queens_on_board()) nPhase = GamePhase::MIDDLE;
     }
 
     return nPhase;
 }
 
-
 // Same as phase_of_game(), but gets the material(s) by itself. For display only. (too slow)
 int MinimaxAI::phase_of_game_full() {
     int cp_score_material_avg_local = 0;
@@ -572,6 +756,64 @@ int MinimaxAI::phase_of_game_full() {
     return nPhase;
 }
 
+//
+// Lazy eval margins. For each phase, adds up the largest score each positional term (other than the piece-square
+// ones) can give, from the weights, times how many times it can count. That sum is a true bound, but a loose one
+// (see LAZY_EVAL_MARGIN_PCT), so only part of it is used.
+//
+void MinimaxAI::init_lazy_eval_margins() {
+    using namespace ShumiChess;
+
+    const Weights& w = engine.game_board.wghts;
+    auto cp = [&w](int wghtIndx, int count) { return std::abs(w.GetWeight(wghtIndx)) * count; };
+
+    // A passed pawn on the 7th, connected
+    const int passed_cp = (cp(PASSED_PAWN_SLOPE, 25) / 2 + cp(PASSED_PAWN_YINRCPT, 1)) * (3 + cp(PASSED_PAWN_CONNECTED, 1)) / 3;
+
+    // Pawn structure, files, centers and pieces. Only while the enemy has major pieces.
+    const int majors_cp = cp(HAS_CASTLED, 1) + cp(CAN_CASTLE, 1)
+                        + cp(ISOLANI, 2) + cp(ISOLANI_OPEN_FILE, 2) + cp(DOUBLED, 2) + cp(DOUBLED_OPEN_FILE, 2)
+                        + cp(PAWN_HOLE, 2) + cp(PAWN_HOLE_OPEN_FILE, 2) + cp(KNIGHT_HOLE, 1)
+                        + 2 * passed_cp
+                        + cp(ROOK_ON_OPEN_FILE, 4) + cp(KING_ON_FILE, 2)
+                        + cp(PAWN_ON_CTR_DEF, 2) + cp(PAWN_ON_CTR_OFF, 2) + cp(PAWN_ON_ADV_CTR, 2) + cp(PAWN_ON_ADV_FLK, 2)
+                        + cp(KNIGHT_ON_CTR, 4) + cp(BISHOP_ON_CTR, 4)
+                        + cp(TWO_BISHOPS, 1) + cp(ROOK_CONNECTED, 1) + cp(MAJOR_ON_RANK7, 3) + cp(MAJOR_ON_RANK8, 3);
+
+    // Kings, once the enemy has no major pieces
+    const int no_majors_cp = cp(KINGS_CLOSE_TOGETHER, MAX_DIST) + cp(KING_EDGE, 3);
+
+    const int checks_cp = GameBoard::potential_check_penalty_cp[8];
+
+    for (int nPhase = GamePhase::OPENING; nPhase <= GamePhase::ENDGAME_LATE; nPhase++) {
+        int margin_cp = majors_cp;
+
+        if (nPhase == GamePhase::OPENING) {
+            margin_cp += cp(BISHOP_ON_CTR, 4);              // counted twice in the opening
+            margin_cp += cp(QUEEN_OUT_EARLY, 4);
+        }
+        if ((nPhase == GamePhase::OPENING) || (nPhase == GamePhase::MIDDLE_EARLY)) {
+            margin_cp += cp(DEVELOPMENT_OPENINGK, 2) + cp(DEVELOPMENT_OPENINGB, 2);
+            margin_cp += cp(BISHOP_PATTERN, 2) + cp(BLOCKED_HOME_BISHOP, 2) + cp(BISHOP_OUTSIDE_WORLD, 2) + cp(BISHOP_CAGED, 2);
+        }
+        if ((nPhase == GamePhase::MIDDLE) || (nPhase == GamePhase::ENDGAME)) {
+            margin_cp += cp(UNPUSHABLE_KNIGHT, 2);
+        }
+        if (nPhase != GamePhase::ENDGAME_LATE) {
+            margin_cp += checks_cp;
+        }
+        if (nPhase > GamePhase::OPENING) {
+            margin_cp += cp(ATTACKERS_ON_KING, 9);          // the king square and the 8 around it
+        }
+        if (nPhase == GamePhase::ENDGAME_LATE) {
+            margin_cp += cp(KEEP_ROOKS_WHEN_DOWN_PAWN, 1);
+        }
+        margin_cp = std::max(margin_cp, no_majors_cp);
+
+        lazy_eval_margin_cp[nPhase] = margin_cp * LAZY_EVAL_MARGIN_PCT / 100;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////////
 
 //
@@ -590,6 +832,8 @@ tuple<Score, Move> MinimaxAI::do_a_deepening(int depth
 
     top_deepening = depth;      // deepening starts at this depth
 
+    age_history();
+
     int aspiration_tries = 0;   // safety fuse
     const bool use_aspiration = ASPIRATION_ENABLED && (depth >= ASPIRATION_MIN_DEPTH);
 
@@ -656,6 +900,7 @@ tuple<Score, Move> MinimaxAI::do_a_deepening(int depth
                                     , true              // I am called from the root
                                     , (nPlys+1)
                                     , qPlys
+                                    , true              // the root is a PV node
                                  );
 
         // ret_val is a tuple of the score and the move.
@@ -725,6 +970,7 @@ tuple<Score, Move> MinimaxAI::do_a_deepening(int depth
                                                 , true
                                                 , (nPlys+1)
                                                 , qPlys
+                                                , true
                                              );
 
                     if (get<0>(full_ret_val) == ABORT_SCORE) return full_ret_val;
@@ -764,6 +1010,39 @@ tuple<Score, Move> MinimaxAI::do_a_deepening(int depth
 
 int g_this_depth = 6;
 
+//
+// Puts every root move that does worse than the best Syzygy rank in excluded_root_moves. Nothing 
+// happens if the position is not in the tables. At least one move is always left.
+void MinimaxAI::tb_filter_root_moves() {
+
+    if (!syzygy::can_probe(engine.game_board)) return;
+
+    syzygy::RootMove tb_moves[syzygy::MAX_MOVES];
+    const bool has_repeated = (engine.times_in_three_time_rep_stack() > 1);
+    const int n_tb = syzygy::probe_root(engine.game_board, has_repeated, tb_moves);
+    if (n_tb == 0) return;
+    n_tb_hits++;
+
+    int best_rank = tb_moves[0].rank;
+    for (int i = 1; i < n_tb; i++) best_rank = std::max(best_rank, tb_moves[i].rank);
+
+    MoveList legal_moves;
+    engine.get_legal_moves_fast(engine.game_board.turn, false, false, legal_moves);
+
+    for (const Move& mv : legal_moves) {
+        for (int i = 0; i < n_tb; i++) {
+            const syzygy::RootMove& tbm = tb_moves[i];
+            if ((tbm.fromSQ == mv.fromSQ) && (tbm.toSQ == mv.toSQ) && (tbm.promotion == mv.promotion)) {
+                if (tbm.rank < best_rank) excluded_root_moves.push_back(std::make_pair(mv, ZERO_SCORE));
+                break;
+            }
+        }
+    }
+
+    if (excluded_root_moves.size() >= legal_moves.size()) excluded_root_moves.clear();
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////
 //
 //   This the entry point into the C to get a minimax AI move.
@@ -797,6 +1076,14 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
     }
 
 
+    // A ponder search has no clock until the ponder hit. Its hard abort waits for it.
+    const bool is_ponder_search = pondering;
+    if (!is_ponder_search) ponder_hit_time_ms = 0;
+    search_start_time_ms = get_time_ms();
+    search_end_time_ms = 0;
+    ponder_clock_pending = is_ponder_search;
+    ponder_hard_abort_ms = 0;
+
     // Schedule the emergency (hard) abort. Once the remaining clock reaches the
     // emergency threshold, divide that remaining time equally among the
     // moves left until the time control. All values are milliseconds.
@@ -825,7 +1112,12 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
             hard_abort_duration_ms = time_until_emergency_ms + emergency_move_budget_ms;
         }
 
-        hard_abort_start(hard_abort_duration_ms);
+        if (is_ponder_search) {
+            ponder_hard_abort_ms = hard_abort_duration_ms;
+            hard_abort_end();
+        } else {
+            hard_abort_start(hard_abort_duration_ms);
+        }
     } else {
         hard_abort_end();
     }
@@ -839,7 +1131,7 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
  
  
     eval_person = (ShumiChess::EvalPersons)player_id;   
-    eval_person = ShumiChess::CRAZY_IVAN;           // debug only (force IVAN)
+    if (eval_person != ShumiChess::NNUE) eval_person = ShumiChess::CRAZY_IVAN;    // debug only (force IVAN). NNUE is asked for by name.
 
     //sout << "\n FEAT = 0x" << hex << feat << dec << "\n";
     //sout << "\n Player = " << eval_person << endl;
@@ -880,17 +1172,12 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
 
         string sss;
         TTable2.clear();    // Clear even if we don't use it.
+        #ifdef DEBUG_NODE_TT2
+            TTable2_debug.clear();
+        #endif
 
-        //sss = format_with_commas(pawn_file_info.size());
-        //printf("pawn_file_info size before clear = %s\n", sss.c_str());
-        
-        max_TTable2_size = 0;
-
-        pawn_file_info.clear();
-
-        //sss = format_with_commas(pawn_file_info.size());
-        //printf("pawn_file_info size after clear = %s\n", sss.c_str());
-        //system("pause");
+        pawn_hash.clear();
+        material_hash.clear();
 
         // Initialize hash table hit counts
         NhitsTT = 0;
@@ -911,6 +1198,16 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
     nSemiFarts = 0;         // Queiseence low level (forced eval) this move
     n_futility_tosses = 0;
     n_delta_tosses = 0;
+    n_null_move_tries = 0;
+    n_null_move_cutoffs = 0;
+    n_lmr_reduced = 0;
+    n_lmr_researches = 0;
+    n_cutoff_nodes = 0;
+    n_first_move_cutoffs = 0;
+    n_movegens_avoided = 0;
+    n_staged_nodes = 0;
+    n_staged_unquiet_gens = 0;
+    n_staged_quiet_gens = 0;
     //
     // Clear debug every move
     // #ifdef _DEBUGGING_TO_FILE 
@@ -929,6 +1226,9 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
     nodes_visited = 0;
     nodes_visited_depth_zero = 0;
     evals_visited = 0;
+    evals_lazy_exits = 0;
+    n_tb_hits = 0;
+    n_exact_endgame_hits = 0;
     aspiration_attempts = 0;
     aspiration_successes = 0;
     aspiration_fail_lows = 0;
@@ -940,6 +1240,7 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
     NTriesP = 0;
 
     //TTable.clear();       // Leaf TT cleared on every move (even if never used)
+    TTable2.new_search();   // Ages the TT2 entries from previous moves (for replacement)
 
     Move best_move = {};
     Score d_best_move_score = ZERO_SCORE;
@@ -987,6 +1288,14 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
     excluded_root_moves.clear();
     bool multipv_aborted = false;
 
+    // Syzygy: keep only the root moves that hold the tablebase result (best DTZ rank). The rest are 
+    // "excluded" like MultiPV moves already played out. Not for MultiPV, which uses that list itself.
+    if (n_Multis == 1) tb_filter_root_moves();
+
+    // Lazy SMP helpers share the root and the TT2. Not used for MultiPV (random moves), where 
+    // the root move list changes between variations.
+    if (n_Multis == 1) smp_start_helpers();
+
 
     //sout << "ENTERED2 get_move... " << n_Multis << endl;
 
@@ -1028,6 +1337,11 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
 
     }
 
+    smp_stop_helpers();
+
+    ponder_clock_pending = false;
+    search_end_time_ms = get_time_ms();
+
     #ifdef DISPLAY_DEEPING1
         if (n_Multis>1) sout << "\n" << " rand moves collected: " << n_Multis;
     #endif
@@ -1099,7 +1413,7 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
 
     // Total time since this move search started.
     assert(total_time.count() > 0);
-    double nodes_per_sec = nodes_visited / total_time.count();      // NPS   nodes per second
+    double nodes_per_sec = (nodes_visited + smp_helper_nodes) / total_time.count();      // NPS   nodes per second (all threads)
     iNodes_per_Second = (int)nodes_per_sec;
 
     // Time used by the deepening that just finished.
@@ -1154,6 +1468,82 @@ Move MinimaxAI::get_move_iterative_deepening(ull duration_requested, int max_dee
             " ---- " + format_with_commas(evals_visited) + " Evals"
         ) << endl;
 
+        if (smp_helper_nodes > 0) {
+            sout << colorize(AColor::BRIGHT_YELLOW,
+                "Helpers (" + to_string(n_threads - 1) + "): " + format_with_commas(smp_helper_nodes) + " nodes"
+            ) << endl;
+        }
+
+        if (NTriesP > 0) {
+            char pawn_pct[32];
+            snprintf(pawn_pct, sizeof(pawn_pct), "%.1f", 100.0 * (double)NhitsP / (double)NTriesP);
+            sout << colorize(AColor::BRIGHT_YELLOW,
+                "Pawn hash: " + format_with_commas(NhitsP) + " hits / " + format_with_commas(NTriesP) + " tries = "
+                + std::string(pawn_pct) + "%"
+            ) << endl;
+        }
+
+        if (n_lmr_reduced > 0) {
+            sout << colorize(AColor::BRIGHT_YELLOW,
+                "LMR: " + format_with_commas(n_lmr_reduced) + " reduced / "
+                + format_with_commas(n_lmr_researches) + " re-searched"
+            ) << endl;
+        }
+
+        sout << colorize(AColor::BRIGHT_YELLOW,
+            "Move generations avoided (TT2 cutoff first): " + format_with_commas(n_movegens_avoided)
+        ) << endl;
+
+        if (n_staged_nodes > 0) {
+            char gen_pct[64];
+            snprintf(gen_pct, sizeof(gen_pct), "%.1f%% / %.1f%%",
+                     100.0 * (double)n_staged_unquiet_gens / (double)n_staged_nodes,
+                     100.0 * (double)n_staged_quiet_gens / (double)n_staged_nodes);
+            sout << colorize(AColor::BRIGHT_YELLOW,
+                "Staged movegen: " + format_with_commas(n_staged_nodes) + " nodes, unquiet / quiet generated at "
+                + std::string(gen_pct)
+            ) << endl;
+        }
+
+        if (n_cutoff_nodes > 0) {
+            char cut_pct[32];
+            snprintf(cut_pct, sizeof(cut_pct), "%.1f", 100.0 * (double)n_first_move_cutoffs / (double)n_cutoff_nodes);
+            sout << colorize(AColor::BRIGHT_YELLOW,
+                "First move cutoffs: " + format_with_commas(n_first_move_cutoffs) + " / "
+                + format_with_commas(n_cutoff_nodes) + " = " + std::string(cut_pct) + "%"
+            ) << endl;
+        }
+
+        if (effective_branching_factor > 0.0) {
+            char ebf[32];
+            snprintf(ebf, sizeof(ebf), "%.2f", effective_branching_factor);
+            sout << colorize(AColor::BRIGHT_YELLOW, "EBF: " + std::string(ebf)) << endl;
+        }
+
+        if (evals_lazy_exits > 0) {
+            char lazy_pct[32];
+            snprintf(lazy_pct, sizeof(lazy_pct), "%.1f", 100.0 * (double)evals_lazy_exits / (double)evals_visited);
+            sout << colorize(AColor::BRIGHT_YELLOW,
+                "Lazy eval: " + format_with_commas(evals_lazy_exits) + " early exits / "
+                + format_with_commas(evals_visited) + " evals = " + std::string(lazy_pct) + "%"
+            ) << endl;
+        }
+
+        if (n_exact_endgame_hits > 0) {
+            sout << colorize(AColor::BRIGHT_YELLOW, "Exact endgame cutoffs: " + format_with_commas(n_exact_endgame_hits)) << endl;
+        }
+
+        if (n_tb_hits + smp_helper_tb_hits > 0) {
+            sout << colorize(AColor::BRIGHT_YELLOW, "Tablebase hits: " + format_with_commas(n_tb_hits + smp_helper_tb_hits)) << endl;
+        }
+
+        if (n_null_move_tries > 0) {
+            sout << colorize(AColor::BRIGHT_YELLOW,
+                "Null move: " + format_with_commas(n_null_move_cutoffs) + " cutoffs / "
+                + format_with_commas(n_null_move_tries) + " tries"
+            ) << endl;
+        }
+
         chrono::duration<double> total_time2 = chrono::high_resolution_clock::now() - start_of_calculation; // still prints seconds
 
         double dElapsedTime = total_time2.count();
@@ -1271,9 +1661,7 @@ void MinimaxAI::playground(int iPhase) {
 
 // TTable2
 
-    max_TTable2_size = std::max(max_TTable2_size, TTable2.size());
-
-    sout << "TT " << TTable2.size() << " max=" << max_TTable2_size << " hits=" << NhitsTT2 << endl;
+    sout << "TT " << TTable2.size_mb() << "MB full=" << TTable2.hashfull() << "/1000 hits=" << NhitsTT2 << endl;
 
     //int material_balance = ;  // evaluate_board();
     //itemp1 = engine.game_board.opposite_bishops_cp_t(material_balance);
@@ -1281,7 +1669,6 @@ void MinimaxAI::playground(int iPhase) {
 
     // sout << "blk " << itemp1 <<  "  " << itemp2 <<  "  " << itemp3 <<  "  " << itemp4 << endl;
 
-    //utemp1 = pawn_file_info.size();
     // string sss1 = format_with_commas(NTriesP); 
     // //string sss1 = format_with_commas(utemp1);
     // string sss2 = format_with_commas(NhitsP);
@@ -1368,6 +1755,11 @@ std::tuple<Score, ShumiChess::Move> MinimaxAI::do_a_principal_variation(int dept
     max_attained_depth = 0; 
     max_attained_qdepth = 0; 
 
+    // Nodes of the last two completed deepenings, for the effective branching factor.
+    ull nodes_last_deepening = 0;
+    ull nodes_prev_deepening = 0;
+    effective_branching_factor = 0.0;
+
     Score d_Return_score = ZERO_SCORE;
 
     tuple<Score, Move> ret_val;
@@ -1395,6 +1787,8 @@ std::tuple<Score, ShumiChess::Move> MinimaxAI::do_a_principal_variation(int dept
 
         // the beast
 
+        const ull nodes_before_deepening = nodes_visited;
+
         // Ha. Here we pass in the elapsed time, just for display, before the deeping.
         ret_val = do_a_deepening(depth
                                 , elapsed_time                      // used for display only
@@ -1424,6 +1818,12 @@ std::tuple<Score, ShumiChess::Move> MinimaxAI::do_a_principal_variation(int dept
 
             aborts_allowed = true;
 
+            // EBF = nodes(depth) / nodes(depth-1)
+            nodes_prev_deepening = nodes_last_deepening;
+            nodes_last_deepening = nodes_visited - nodes_before_deepening;
+            if (nodes_prev_deepening > 0) {
+                effective_branching_factor = (double)nodes_last_deepening / (double)nodes_prev_deepening;
+            }
         }
 
         if (best_move.piece_type == Piece::NONE) {      // from do_a_principal_variation()
@@ -1496,7 +1896,8 @@ std::tuple<Score, ShumiChess::Move> MinimaxAI::do_a_principal_variation(int dept
             growth_factor,
             duration_requested,
             time_control,
-            estimated_elapsed_time);
+            estimated_elapsed_time,
+            time_before_ponder_hit_ms());
 
         // hard abort testing debug only only
         //bThinkingOverByTime = false;        // debug only (to test hard abort)
@@ -1517,6 +1918,9 @@ std::tuple<Score, ShumiChess::Move> MinimaxAI::do_a_principal_variation(int dept
         // we are done thinking if both time and depth is ended OR simple endgame is on.
         bThinkingOver = (bThinkingOverByDepth && bThinkingOverByTime);
 
+        // Pondering goes on until the ponder hit or a stop
+        if (pondering) bThinkingOver = false;
+
     } while (!bThinkingOver);
 
     max_attained_depth = depth-1;       // minus one becuase it was incremented at the end of the loop
@@ -1533,7 +1937,8 @@ std::tuple<Score, ShumiChess::Move> MinimaxAI::do_a_principal_variation(int dept
 bool MinimaxAI::should_stop_by_time(ull elapsed_time, double growth_factor
                                     , ull fallback_move_budget
                                     , const SearchTimeControl& time_control
-                                    , double& estimated_elapsed_time)      // output
+                                    , double& estimated_elapsed_time      // output
+                                    , ull free_time_ms)
 {
 
     // Sometimes I dont believe my incredibly fast (becasue of the TT2 on simple positions), 
@@ -1552,6 +1957,9 @@ bool MinimaxAI::should_stop_by_time(ull elapsed_time, double growth_factor
     //  Note: should this instead be factorial?
     estimated_elapsed_time = (double)elapsed_time * growth_factor;
 
+    // Time searched while pondering was the opponent's. Only what is left comes off our clock.
+    estimated_elapsed_time = std::max(0.0, estimated_elapsed_time - (double)free_time_ms);
+
     // Existing callers specify only a per-move duration. Preserve that behavior
     // until they provide a complete time-control description.
     // However, cutechess and other "GUI"s do pass in times that end up enabling time control.
@@ -1601,6 +2009,24 @@ bool MinimaxAI::should_stop_by_time(ull elapsed_time, double growth_factor
 }
 
 
+//
+// Null move pruning guards, for side c to move. Side c may "pass" only if:
+//      it is not in check (passing would be illegal),
+//      it has a rook or queen, or two minor pieces (otherwise zugzwang is too likely),
+//      its static eval is already at least beta (otherwise a pass will not fail high).
+template<ShumiChess::Color c> bool MinimaxAI::null_move_allowed_t(Score beta) {
+
+    if (engine.is_king_in_check_t<c>()) return false;
+
+    if (engine.game_board.hasNoMajorPieces_t<c>()) return false;
+
+    const int eval_cp = evaluate_board_t<c>(eval_person);
+    if (convert_from_CP(eval_cp) < beta) return false;
+
+    return true;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Choose the "minimax" AI move.
@@ -1616,6 +2042,7 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
                     ,bool is_from_root
                     ,int nPlys
                     ,int qPlys
+                    ,bool is_pv_node
                     )
 {
 
@@ -1638,8 +2065,8 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
 
 
     assert(nPlys < MAX_PLY0);
-    vector<Move>& legal_moves = engine.all_legal_moves[nPlys];
-    vector<Move>* p_moves_to_loop_over = &legal_moves;
+    MoveList& legal_moves = engine.all_legal_moves[nPlys];
+    MoveList* p_moves_to_loop_over = &legal_moves;
 
     assert(depth>0);
     assert(qPlys==0);
@@ -1649,58 +2076,6 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
 
    
 
-    // =====================================================================
-    // Get all legal moves
-    // =====================================================================
-
-    bool caps_only = false;
-   
-
-    int n_legal_moves_found;
-    if (engine.game_board.turn == ShumiChess::Color::WHITE) {
-        if (caps_only) n_legal_moves_found = engine.get_legal_moves_fast_t<ShumiChess::Color::WHITE, true>(false, legal_moves);
-        else n_legal_moves_found = engine.get_legal_moves_fast_t<ShumiChess::Color::WHITE, false>(false, legal_moves);
-    } else {
-        if (caps_only) n_legal_moves_found = engine.get_legal_moves_fast_t<ShumiChess::Color::BLACK, true>(false, legal_moves);
-        else n_legal_moves_found = engine.get_legal_moves_fast_t<ShumiChess::Color::BLACK, false>(false, legal_moves);
-    }
-    
-    // Look, if caps_only is false, then n_legal_moves_found will be equal to legal_moves.size()
-    // if caps_only is true, then n_legal_moves_found will be the count of moves, but 
-    // only unquiet moves will be in legal_moves.
-    #ifndef NDEBUG
-        if (!caps_only) {
-            // Change 0: legal_moves needs a size() that discounts "zero moves".
-            assert (n_legal_moves_found == legal_moves.size());
-        }
-    #endif
-
-    // =====================================================================
-    // MultiPV      // remove excluded (already analyzed) moves from the list ONLY AT ROOT
-    // =====================================================================
-    if (is_from_root) {
-        for (int i = (int)legal_moves.size() - 1; i >= 0; i--) {
-            bool bExclude = false;
-
-            for (int j = 0; j < (int)excluded_root_moves.size(); j++) {
-                if (legal_moves[i] == excluded_root_moves[j].first) {
-                    bExclude = true;
-                    break;
-                }
-            }
-
-            if (bExclude) {
-                //assert(0);
-                legal_moves.erase(legal_moves.begin() + i);
-            }
-
-            assert (!legal_moves.empty());
-            // if (legal_moves.empty()) {
-            //     //return;    // this better not happen!
-            // }
-        }
-    }
-
     // =====================================================================
     // Asserts
     // =====================================================================
@@ -1726,7 +2101,7 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
 
     // User abort
     if (stop_calculation) {
-        sout << "\n! STOP CALCULATION requested" << endl;
+        if (!is_smp_helper()) sout << "\n! STOP CALCULATION requested" << endl;
         stop_calculation = false;
          #ifdef _DEBUGGING_TEMP1
             fprintf(fpDebug, "\nABORT_SCORE s\n");
@@ -1790,7 +2165,7 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
         ull    found_bq = 0ULL;
         ull    found_bk = 0ULL;
 
-        std::stack<ShumiChess::Move> found_move_history; 
+        std::vector<ShumiChess::Move> found_move_history; 
 
         bool   found_white_castled = false;
         bool   found_black_castled = false;
@@ -1818,14 +2193,32 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
 
             bool is_perfect_match = false;
 
+            // Lazy SMP: the table is shared with the helper threads. It is lockless (see transposition_table.hpp).
+            auto& tt2 = shared_TTable2();
+            #ifdef DEBUG_NODE_TT2       // but the debug records are not
+                std::unique_lock<std::mutex> tt2_debug_lock(shared_TTable2_debug_mutex(), std::defer_lock);
+                if (shared_TTable2_needs_lock()) tt2_debug_lock.lock();
+            #endif
+
             // Probe the table
             uint64_t key = engine.game_board.zobrist_key;
-            auto it = TTable2.find(key);
+            TranspositionTable::Entry entry;
 
-            if (it != TTable2.end()) {
+            if (tt2.probe(key, entry)) {
 
-                // probe found for this zobrist key
-                const TTEntry2 &entry = it->second;
+                // probe found for this zobrist key. The table keeps only from/to/promotion of the move.
+                // The moves are not generated yet, so complete it from the board and check it is legal here.
+                Move entry_move = resolve_TT2_move(entry.move16);
+
+                // MultiPV: an already analyzed root move is not a move here.
+                if (is_from_root) {
+                    for (const auto& excluded : excluded_root_moves) {
+                        if (entry_move == excluded.first) {
+                            entry_move = {};
+                            break;
+                        }
+                    }
+                }
 
                 // Qualification #1 on probe:
                 // We are at position X. Use the stored result only if the stored search continued at least as 
@@ -1846,48 +2239,61 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
                     #ifdef DEBUG_NODE_TT2        // Store information recalled from the TT2 "record"
                         foundPos   = true;
                         foundScore_cp = entry.score_cp;
-                        foundMove  = entry.best_move;
-                        foundnPlys = entry.nPlysDebug;
-                        foundDraw  = entry.drawDebug;
-                        foundAlpha = entry.dAlphaDebug;
-                        foundBeta  = entry.dBetaDebug;
+                        foundMove  = entry_move;
                         foundDepth = entry.depth;
-                        foundIsCheck = entry.bIsInCheckDebug;
-                        //foundLegalMoveSize = entry.legalMovesSize;
-                        foundRepCount = entry.repCountDebug;
-                        foundRawScore = entry.dScoreDebug;
-
-                        found_wp = entry.bb_wp;
-                        found_wn = entry.bb_wn;
-                        found_wb = entry.bb_wb;
-                        found_wr = entry.bb_wr;
-                        found_wq = entry.bb_wq;
-                        found_wk = entry.bb_wk;
-
-                        found_bp = entry.bb_bp;
-                        found_bn = entry.bb_bn;
-                        found_bb = entry.bb_bb;
-                        found_br = entry.bb_br;
-                        found_bq = entry.bb_bq;
-                        found_bk = entry.bb_bk;
-
-                        found_white_castled = entry.white_castled_debug;
-                        found_black_castled = entry.black_castled_debug;
-
-                        found_move_history = entry.move_history_debug; 
+
+                        auto it_debug = shared_TTable2_debug().find(key);
+                        if (it_debug != shared_TTable2_debug().end()) {
+                            const TTEntry2Debug &entry_debug = it_debug->second;
+
+                            foundnPlys = entry_debug.nPlysDebug;
+                            foundDraw  = entry_debug.drawDebug;
+                            foundAlpha = entry_debug.dAlphaDebug;
+                            foundBeta  = entry_debug.dBetaDebug;
+                            foundIsCheck = entry_debug.bIsInCheckDebug;
+                            //foundLegalMoveSize = entry_debug.legalMovesSize;
+                            foundRepCount = entry_debug.repCountDebug;
+                            foundRawScore = entry_debug.dScoreDebug;
+
+                            found_wp = entry_debug.bb_wp;
+                            found_wn = entry_debug.bb_wn;
+                            found_wb = entry_debug.bb_wb;
+                            found_wr = entry_debug.bb_wr;
+                            found_wq = entry_debug.bb_wq;
+                            found_wk = entry_debug.bb_wk;
+
+                            found_bp = entry_debug.bb_bp;
+                            found_bn = entry_debug.bb_bn;
+                            found_bb = entry_debug.bb_bb;
+                            found_br = entry_debug.bb_br;
+                            found_bq = entry_debug.bb_bq;
+                            found_bk = entry_debug.bb_bk;
+
+                            found_white_castled = entry_debug.white_castled_debug;
+                            found_black_castled = entry_debug.black_castled_debug;
+
+                            found_move_history = entry_debug.move_history_debug; 
+                        } else {
+                            // The debug record was evicted. Compare only the score.
+                            const int level = top_deepening - depth;
+                            foundRawScore = mate_score_from_TT(convert_from_CP(entry.score_cp), level);
+                        }
 
                     #else
-                        const int level = top_deepening - depth;
-                        Score dScore = convert_from_CP(entry.score_cp);
-                        dScore = mate_score_from_TT(dScore, level);
+                        if (entry_move.piece_type != Piece::NONE) {
+                            const int level = top_deepening - depth;
+                            Score dScore = convert_from_CP(entry.score_cp);
+                            dScore = mate_score_from_TT(dScore, level);
 
-                        return { dScore, entry.best_move };
+                            n_movegens_avoided++;       // the cutoff comes before the move generation
+                            return { dScore, entry_move };
+                        }
                     #endif
 
                 } else {
 
                     // Its a match but not a perfect match. Use the move for ordering anyway (orders it to be seen sooner).
-                    TT2_match_move = entry.best_move;
+                    TT2_match_move = entry_move;
 
                 }
                 
@@ -1898,15 +2304,79 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
 
     }   // END TT2 feature
 
+    // =====================================================================
+    // Get all legal moves
+    // =====================================================================
+
+    // After the TT2 probe, so a hash cutoff does not pay for the generation.
+
+    // Staged move generation (_FEATURE_STAGED_MOVEGEN). Nothing is generated here, the MovePicker does it 
+    // in the move loop, as late as it can. Not at the root (MultiPV exclusions, the "only move" check).
+    // Not at the 50 move rule, where a mate must be told from the draw before the loop. (With the rule 
+    // suppressed, FIFTY_MOVE_RULE_PLY is past anything the uint8_t halfmove holds, so never.)
+    const int halfmove = engine.game_board.halfmove;
+    const bool b_staged = (Features_mask & _FEATURE_STAGED_MOVEGEN) && (!is_from_root) &&
+                          (halfmove < FIFTY_MOVE_RULE_PLY);
+
+    bool caps_only = false;
+   
+
+    int n_legal_moves_found = 0;
+    if (!b_staged) {
+        if (engine.game_board.turn == ShumiChess::Color::WHITE) {
+            if (caps_only) n_legal_moves_found = engine.get_legal_moves_fast_t<ShumiChess::Color::WHITE, true>(false, legal_moves);
+            else n_legal_moves_found = engine.get_legal_moves_fast_t<ShumiChess::Color::WHITE, false>(false, legal_moves);
+        } else {
+            if (caps_only) n_legal_moves_found = engine.get_legal_moves_fast_t<ShumiChess::Color::BLACK, true>(false, legal_moves);
+            else n_legal_moves_found = engine.get_legal_moves_fast_t<ShumiChess::Color::BLACK, false>(false, legal_moves);
+        }
+        
+        // Look, if caps_only is false, then n_legal_moves_found will be equal to legal_moves.size()
+        // if caps_only is true, then n_legal_moves_found will be the count of moves, but 
+        // only unquiet moves will be in legal_moves.
+        #ifndef NDEBUG
+            if (!caps_only) {
+                // Change 0: legal_moves needs a size() that discounts "zero moves".
+                assert (n_legal_moves_found == legal_moves.size());
+            }
+        #endif
+    }
+
+    // =====================================================================
+    // MultiPV      // remove excluded (already analyzed) moves from the list ONLY AT ROOT
+    // =====================================================================
+    if (is_from_root) {
+        for (int i = (int)legal_moves.size() - 1; i >= 0; i--) {
+            bool bExclude = false;
+
+            for (int j = 0; j < (int)excluded_root_moves.size(); j++) {
+                if (legal_moves[i] == excluded_root_moves[j].first) {
+                    bExclude = true;
+                    break;
+                }
+            }
+
+            if (bExclude) {
+                //assert(0);
+                legal_moves.erase(legal_moves.begin() + i);
+            }
+
+            assert (!legal_moves.empty());
+            // if (legal_moves.empty()) {
+            //     //return;    // this better not happen!
+            // }
+        }
+    }
+
     // Purpose: avoid a false zero (no-move) result when the quick/capture-only generation missed moves
     // (or when you only needed to know whether any legal move exists). 
-    if (n_legal_moves_found == 0) {
+    if (!b_staged && (n_legal_moves_found == 0)) {
         //assert(depth==0);
         //assert (caps_only);
 
         // Call get_legal_moves_fast(), but only in "check mode". In this mode in is only trying to decide
         // wether its 0 moves or not. So it returns if it finds just one move.
-        vector<Move> mvs;       // I am not used
+        MoveList mvs;       // I am not used
         int n_legal_moves_found2 = engine.get_legal_moves_fast(engine.game_board.turn, false, true, mvs);
         
         //assert(n_legal_moves_found == n_legal_moves_found2);
@@ -1916,10 +2386,10 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
     // Only one of me, per deepening.
     bool first_node_in_deepening = (top_deepening == depth);
 
-    if (first_node_in_deepening) {
+    if (first_node_in_deepening && !b_staged) {
         // Change 3: legal_moves needs a size() that discounts "zero moves".
         if (legal_moves.size() == 1) {
-            sout << "\x1b[94m!!!!! force !!!!!!!!!!!!!\x1b[0m" << endl;
+            if (!is_smp_helper()) sout << "\x1b[94m!!!!! force !!!!!!!!!!!!!\x1b[0m" << endl;
 
             #ifdef _DEBUGGING_TO_FILE1
                 // Show board
@@ -1931,59 +2401,197 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
         }
     }
 
-    const GameState state = engine.is_game_over(n_legal_moves_found);
+    // Staged: mate and stalemate are only known after the move loop, when it found no moves. Only the draws here.
+    const GameState state = engine.is_game_over(b_staged ? 1 : n_legal_moves_found);
     //GameState state = engine.is_game_over(legal_moves.size());
 
     // =====================================================================
     // Terminal positions (game over)
     // =====================================================================
-    if (state != GameState::INPROGRESS) {
+    auto game_over_score = [&](GameState gs) -> Score {
 
         int level = (top_deepening - depth);
         assert(level >= 0);
 
         Score d_level = static_cast<Score>(level);
+        Score d_score = ZERO_SCORE;
 
-        switch (state) {
+        switch (gs) {
             case GameState::WHITEWIN:
-                d_best_score = (engine.game_board.turn == ShumiChess::WHITE)
+                d_score = (engine.game_board.turn == ShumiChess::WHITE)
                                 ? (+HUGE_SCORE - d_level)
                                 : (-HUGE_SCORE + d_level);
                 break;
 
-            case GameState::BLACKWIN:
-                d_best_score = (engine.game_board.turn == ShumiChess::BLACK)
-                                ? (+HUGE_SCORE - d_level)
-                                : (-HUGE_SCORE + d_level);
-                break;
+            case GameState::BLACKWIN:
+                d_score = (engine.game_board.turn == ShumiChess::BLACK)
+                                ? (+HUGE_SCORE - d_level)
+                                : (-HUGE_SCORE + d_level);
+                break;
+
+            case GameState::DRAW:
+                d_score = ZERO_SCORE;          // Stalemate
+
+                if (is_from_root) engine.reason_for_draw = DRAW_STALEMATE;
+                break;
+
+            default:
+                assert(0);
+                break;
+        }
+        return d_score;
+    };
+
+    if (state != GameState::INPROGRESS) {
+
+        d_best_score = game_over_score(state);
+        //sout << "terminat=" << (int)state << "d=" << depth 
+        //    << "f=" << (int)the_best_move.fromSQ << "t=" << (int)the_best_move.toSQ <<  endl;
+        return {d_best_score, the_best_move};
+
+    }
+
+    // =====================================================================
+    // Syzygy tablebase (WDL) probe
+    // =====================================================================
+    //
+    // Only right after a capture or pawn move (halfmove clock 0), where the 50 move rule cannot change 
+    // the result. Cursed wins and blessed losses are draws under that rule. Not at the root, where 
+    // the DTZ ranking picks the moves (see get_move_iterative_deepening()).
+    if ( (!is_from_root) &&
+         (engine.game_board.halfmove == 0) &&
+         syzygy::can_probe(engine.game_board) ) {
+
+        const syzygy::Wdl wdl = syzygy::probe_wdl(engine.game_board);
+        if (wdl != syzygy::FAILED) {
+            n_tb_hits++;
+            switch (wdl) {
+                case syzygy::WIN:   d_best_score = convert_from_CP(+TB_WIN_CP - nPlys);  break;
+                case syzygy::LOSS:  d_best_score = convert_from_CP(-TB_WIN_CP + nPlys);  break;
+                default:            d_best_score = ZERO_SCORE;                           break;
+            }
+            return {d_best_score, the_best_move};
+        }
+    }
+
+    // An exactly known ending (MaterialInfo::endgame_is_exact, KPK for now). The tree below adds nothing.
+    if (!is_from_root) {
+        const MaterialInfo& mi = get_material_info_for_position();
+        if (mi.endgame_is_exact) {
+            n_exact_endgame_hits++;
+            const int cp_known = mi.endgame(engine.game_board, mi.endgame_strong);
+            return {convert_from_CP((mi.endgame_strong == engine.game_board.turn) ? cp_known : -cp_known), the_best_move};
+        }
+    }
+
+    assert (depth > 0);
+    Score d_stand_pat = HUGE_SCORE;   // If we evaluate, it will be the evaluate score.
+
+    // =====================================================================
+    // Null move pruning
+    // =====================================================================
+    //
+    // Let the enemy move twice. If a reduced depth, null window search still fails high (>= beta),
+    // a real move would (almost surely) too, so cut off now. Not done:
+    //      at PV nodes, or in check, or right after a null move, or near mate scores
+    //      in pawn only (or lone minor piece) positions, where zugzwang makes "passing" too good
+    if (Features_mask & _FEATURE_NULL_MOVE) {
+
+        const int NULL_MOVE_MIN_DEPTH = 3;
+
+        if ( (!is_pv_node) &&
+             (depth >= NULL_MOVE_MIN_DEPTH) &&
+             (!null_move_at_ply[nPlys-1]) &&
+             (!IS_MATE_SCORE(beta)) ) {
+
+            const bool bNullMoveOK = (engine.game_board.turn == ShumiChess::Color::WHITE)
+                ? null_move_allowed_t<ShumiChess::Color::WHITE>(beta)
+                : null_move_allowed_t<ShumiChess::Color::BLACK>(beta);
+
+            if (bNullMoveOK) {
+
+                n_null_move_tries++;
+
+                // Reduction R is 2, or 3 for deeper searches. Below that, go straight to qsearch.
+                const int R = (depth >= 6) ? 3 : 2;
+                const int null_depth = depth - 1 - R;
+
+                if (engine.game_board.turn == ShumiChess::Color::WHITE) engine.pushNullMove_t<ShumiChess::Color::WHITE>();
+                else                                                     engine.pushNullMove_t<ShumiChess::Color::BLACK>();
+                null_move_at_ply[nPlys] = true;
+
+                // No repetition across a null move. Mark it "irreversable" in the 3-time rep stack.
+                engine.three_time_rep_stack.push_back(engine.game_board.zobrist_key);
+                engine.boundary_stack.push_back((int)engine.three_time_rep_stack.size() - 1);
+
+                const Score null_window = convert_from_CP(1);
+                tuple<Score, Move> null_ret_val;
+                if (null_depth > 0) {
+                    null_ret_val = recursive_negamax(null_depth, -beta, -beta + null_window,
+                                                     false, (nPlys+1), qPlys, false);
+                } else {
+                    null_ret_val = recursive_negamaxQ(-beta, -beta + null_window, (nPlys+1), (qPlys+1));
+                }
 
-            case GameState::DRAW:
-                d_best_score = ZERO_SCORE;          // Stalemate
+                engine.pop_from_three_time_rep_stack();
 
-                if (is_from_root) engine.reason_for_draw = DRAW_STALEMATE;
-                break;
+                null_move_at_ply[nPlys] = false;
+                if (engine.game_board.turn == ShumiChess::Color::WHITE) engine.popNullMove_t<ShumiChess::Color::BLACK>();
+                else                                                     engine.popNullMove_t<ShumiChess::Color::WHITE>();
 
-            default:
-                assert(0);
-                break;
-        }
-        //sout << "terminat=" << (int)state << "d=" << depth 
-        //    << "f=" << (int)the_best_move.fromSQ << "t=" << (int)the_best_move.toSQ <<  endl;
-        return {d_best_score, the_best_move};
+                const Score d_null_return = get<0>(null_ret_val);
+                if (d_null_return == ABORT_SCORE) {
+                    return {ABORT_SCORE, the_best_move};
+                }
 
+                const Score d_null_score = -d_null_return;
+                if (d_null_score >= beta) {
+                    // Fail high. Return beta, not an unproven mate.
+                    n_null_move_cutoffs++;
+                    return {beta, the_best_move};
+                }
+            }
+        }
     }
 
-    assert (depth > 0);
-    Score d_stand_pat = HUGE_SCORE;   // If we evaluate, it will be the evaluate score.
-
     ////////////////////////////////////////////////////////////////////////////////////////////
 
     // =====================================================================
     // Recurse over selected move set "moves_to_loop_over"
     // =====================================================================
     
-    assert(!p_moves_to_loop_over->empty());
-    if (!p_moves_to_loop_over->empty()) {
+    if (b_staged) {
+
+        d_best_score = -HUGE_SCORE;
+        the_best_move = {};
+
+        // TT2_match_move is a member (the children overwrite it). The picker keeps its own copy.
+        MovePicker picker(*this, engine, nPlys, TT2_match_move);
+
+        bool did_cutoff;
+        bool was_aborted = loop_over_all_moves(depth, alpha, beta, 
+                        nPlys, qPlys, false, is_pv_node,
+                        d_stand_pat, 
+                        picker,                             // input
+                        the_best_move, d_best_score,        // outputs
+                        did_cutoff);
+        if (was_aborted) {
+            if (!is_smp_helper()) sout << "loop_over_all_moves abort" << endl;
+            return {ABORT_SCORE, the_best_move};
+        }
+
+        n_staged_nodes++;
+        if (picker.did_generate_unquiet()) n_staged_unquiet_gens++;
+        if (picker.did_generate_quiet())   n_staged_quiet_gens++;
+
+        if (picker.n_picked() == 0) {
+            // No legal moves. Checkmate or stalemate.
+            assert(picker.did_generate_quiet());
+            return {game_over_score(engine.is_game_over(0)), the_best_move};
+        }
+
+    }
+    else if (!p_moves_to_loop_over->empty()) {
 
         // Resort moves based on varoius things
         // Fascinating tradeoff. We could also call this if depth==0 and in check.
@@ -1994,7 +2602,7 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
         assert(p_moves_to_loop_over == &legal_moves);
 
         #ifdef _DEBUGGING_MOVE_SORT
-            vector<Move> tempMovs = *p_moves_to_loop_over;
+            MoveList tempMovs = *p_moves_to_loop_over;
         #endif
 
         bool is_top_of_deepening = (depth == top_deepening);
@@ -2015,22 +2623,24 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
 
         // returns 0 if success, 1 if abort     n_legal_moves_found
         bool did_cutoff;
+        MovePicker picker(*p_moves_to_loop_over);
         // Regular-search futility pruning calculates check status lazily inside
         // loop_over_all_moves(); this parameter is needed for qsearch/delta pruning.
         bool was_aborted = loop_over_all_moves(depth, alpha, beta, 
-                        nPlys, qPlys, false, 
+                        nPlys, qPlys, false, is_pv_node,
                         d_stand_pat, 
-                        p_moves_to_loop_over,               // input
+                        picker,                             // input
                         the_best_move, d_best_score,        // outputs
                         did_cutoff);
         if (was_aborted) {
-            sout << "loop_over_all_moves abort" << endl;
+            if (!is_smp_helper()) sout << "loop_over_all_moves abort" << endl;
             return {ABORT_SCORE, the_best_move};
         }
 
 
     }   // END non zero moves to look at
     else {
+         assert(0);
          sout << "should not happen" << endl;
     }
 
@@ -2050,15 +2660,12 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
                 //
                 uint64_t key = engine.game_board.zobrist_key;
 
-                // Rolling size cap for TT2. Note: Is this a non-determinism that can break "burp2" TT2?
-                static const std::size_t MAX_TT2_SIZE = 1'000'000;
-                if (TTable2.size() >= MAX_TT2_SIZE) {
-                    // one arbitrary existing entry is erased;
-                    auto it = TTable2.begin();
-                    if (it != TTable2.end()) {
-                        TTable2.erase(it);
-                    }
-                }
+                // Lazy SMP: the table is shared with the helper threads. It is lockless (see transposition_table.hpp).
+                auto& tt2 = shared_TTable2();
+                #ifdef DEBUG_NODE_TT2       // but the debug records are not
+                    std::unique_lock<std::mutex> tt2_debug_lock(shared_TTable2_debug_mutex(), std::defer_lock);
+                    if (shared_TTable2_needs_lock()) tt2_debug_lock.lock();
+                #endif
 
                 const int level = top_deepening - depth;
                 const Score score_for_TT = mate_score_to_TT(d_best_score, level);
@@ -2225,21 +2832,26 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
                 // Greater depths mean there was less search to get to this position, depth is 
                 // intialized to a higher value, so there was more search after position X.
 
-                auto it_existing = TTable2.find(key);
-
-                // no existing entry → store this one;
-                // new depth is equal or higher → replace the old entry;
-                // new depth is lower → retain the more valuable old entry.
-                if ((it_existing == TTable2.end()) ||           // does not exist
-                    (depth >= it_existing->second.depth)) {     // stored depth is inferior
+                // The table keeps from/to/promotion of the best move and does the depth/age
+                // preferred replacement itself (see transposition_table.hpp).
+                const bool bStored = tt2.store(key, cp_score_temp, TranspositionTable::pack_move(the_best_move),
+                                                depth, TTFlag::EXACT);
+                if (bStored) {
 
-                    TTEntry2 &slot = TTable2[key];
+                    #ifdef DEBUG_NODE_TT2
 
-                    slot.score_cp  = cp_score_temp;
-                    slot.best_move = the_best_move;
-                    slot.depth     = depth;
+                        // Rolling size cap for the debug records.
+                        auto& tt2_debug = shared_TTable2_debug();
+                        static const std::size_t MAX_TT2_DEBUG_SIZE = 1'000'000;
+                        if (tt2_debug.size() >= MAX_TT2_DEBUG_SIZE) {
+                            // one arbitrary existing entry is erased;
+                            auto it = tt2_debug.begin();
+                            if (it != tt2_debug.end()) {
+                                tt2_debug.erase(it);
+                            }
+                        }
 
-                    #ifdef DEBUG_NODE_TT2
+                        TTEntry2Debug &slot = tt2_debug[key];
 
                         slot.dAlphaDebug = alpha_in;
                         slot.dBetaDebug  = beta;
@@ -2271,7 +2883,7 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
                         slot.bb_bq = engine.game_board.black_queens;
                         slot.bb_bk = engine.game_board.black_king;
 
-                        slot.move_history_debug = engine.move_history;
+                        slot.move_history_debug = engine.move_history_to_vector();
 
                         // Position specific debug 1
                         // --- Special debug for cxd4 / 338 ---
@@ -2309,7 +2921,7 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
                         #ifdef _DEBUGGING_TO_FILE
                         {
                             char buf[128];
-                            ull size_after = TTable2.size();
+                            ull size_after = tt2_debug.size();
                             std::sprintf(
                                 buf,
                                 "  fxg4/338: INSERT new entry, size_after=%llu\n",
@@ -2368,6 +2980,31 @@ tuple<Score, Move> MinimaxAI::recursive_negamax(
 }
 
 
+//
+// The TT2 keeps only from/to/promotion of a move. Finds the full (legal) move it stands for, without
+// generating the moves. The stored move may be from another position with the same (index) key, so check it.
+// Returns an empty move (piece_type NONE) if there is none, e.g. no move stored.
+Move MinimaxAI::resolve_TT2_move(std::uint16_t move16) {
+
+    if (move16 == 0) return Move{};
+
+    const Move packed = TranspositionTable::unpack_move(move16);
+    const Move m = engine.complete_move(packed.fromSQ, packed.toSQ, packed.promotion);
+    if ((m.piece_type == Piece::NONE) || !engine.is_legal_move_fast(m)) return Move{};
+    return m;
+}
+
+//
+// What the last search expects the opponent to play, from the TT2. The engine must already have 
+// our move made. Empty if the table has nothing (or nothing legal) for this position.
+Move MinimaxAI::expected_reply() {
+
+    TranspositionTable::Entry entry;
+    if (!TTable2.probe(engine.game_board.zobrist_key, entry)) return Move{};
+    return resolve_TT2_move(entry.move16);
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -2445,8 +3082,8 @@ tuple<Score, Move> MinimaxAI::recursive_negamaxQ(
 
     // Get pointer to buffer where we will put the legal moves.
     assert(nPlys < MAX_PLY0);
-    vector<Move>& legal_moves = engine.all_legal_moves[nPlys];
-    vector<Move>* p_moves_to_loop_over = &legal_moves;
+    MoveList& legal_moves = engine.all_legal_moves[nPlys];
+    MoveList* p_moves_to_loop_over = &legal_moves;
 
     //
     //  If not in check, generate only captures. If in check generate all moves.
@@ -2484,7 +3121,7 @@ tuple<Score, Move> MinimaxAI::recursive_negamaxQ(
 
     // User abort
     if (stop_calculation) {
-        sout << "\n! STOP CALCULATION requested" << endl;
+        if (!is_smp_helper()) sout << "\n! STOP CALCULATION requested" << endl;
         stop_calculation = false;
         #ifdef _DEBUGGING_TEMP1
             fprintf(fpDebug, "\nABORT_SCORE q\n");
@@ -2522,7 +3159,7 @@ tuple<Score, Move> MinimaxAI::recursive_negamaxQ(
 
         // Call get_legal_moves_fast(), but only in "check mode". In this mode in is only trying to decide
         // wether its 0 moves or not. So it returns if it finds just one move.
-        vector<Move> mvs;       // I am not used
+        MoveList mvs;       // I am not used
         int n_legal_moves_found2 = engine.get_legal_moves_fast(engine.game_board.turn, false, true, mvs);
         
         //assert(n_legal_moves_found == n_legal_moves_found2);
@@ -2587,13 +3224,20 @@ tuple<Score, Move> MinimaxAI::recursive_negamaxQ(
         d_best_score = -HUGE_SCORE;
     } else {
         // Standing pat is legal. Use the static evaluation as the initial
-        // best score before searching captures and promotions.
+        // best score before searching captures and promotions. Only which side
+        // of the window it is on matters, if it is outside (_FEATURE_LAZY_EVAL).
+        int alpha_cp = -EVAL_NO_WINDOW_CP;
+        int beta_cp = EVAL_NO_WINDOW_CP;
+        if (Features_mask & _FEATURE_LAZY_EVAL) {
+            alpha_cp = convert_to_CP(alpha);
+            beta_cp = convert_to_CP(beta);
+        }
         if (engine.game_board.turn == ShumiChess::Color::WHITE)
             cp_score_best =
-                evaluate_board_t<ShumiChess::Color::WHITE>(eval_person);
+                evaluate_board_t<ShumiChess::Color::WHITE>(eval_person, alpha_cp, beta_cp);
         else
             cp_score_best =
-                evaluate_board_t<ShumiChess::Color::BLACK>(eval_person);
+                evaluate_board_t<ShumiChess::Color::BLACK>(eval_person, alpha_cp, beta_cp);
 
         d_best_score = convert_from_CP(cp_score_best);
         d_stand_pat = d_best_score;
@@ -2608,7 +3252,7 @@ tuple<Score, Move> MinimaxAI::recursive_negamaxQ(
         // to the set of all check escapes. By definition. So there.
         ////moves_to_loop_over = legal_moves;  // not needed as its done ealier above. Sorry.
         engine.sort_check_evasions_qsearch(legal_moves, engine.all_unquiet_moves[nPlys]);
-        vector<Move>& unquiet_moves = engine.all_unquiet_moves[nPlys];
+        MoveList& unquiet_moves = engine.all_unquiet_moves[nPlys];
         assert(!unquiet_moves.empty());  // oTherwise we are in check mate, and that would be caught earlier. 
 
         assert(legal_moves.size() == unquiet_moves.size());
@@ -2625,7 +3269,7 @@ tuple<Score, Move> MinimaxAI::recursive_negamaxQ(
             engine.sort_unquiet_moves_qsearch_L(legal_moves, engine.all_unquiet_moves[nPlys]);
         }
 
-        vector<Move>& unquiet_moves = engine.all_unquiet_moves[nPlys];
+        MoveList& unquiet_moves = engine.all_unquiet_moves[nPlys];
 
 
         // If quiet (not in check & no tactics), just return stand-pat
@@ -2691,15 +3335,16 @@ tuple<Score, Move> MinimaxAI::recursive_negamaxQ(
         }        
 
         bool did_cutoff;
+        MovePicker picker(*p_moves_to_loop_over);
         // returns 0 if success, 1 if abort
         bool was_aborted = loop_over_all_moves(0, alpha, beta, 
-                        nPlys, qPlys, in_check, 
+                        nPlys, qPlys, in_check, false,
                         d_stand_pat, 
-                        p_moves_to_loop_over,               // input
+                        picker,                             // input
                         the_best_move, d_best_score,        // outputs
                         did_cutoff);
         if (was_aborted) {
-            sout << "loop_over_all_moves abortQ" << endl;
+            if (!is_smp_helper()) sout << "loop_over_all_moves abortQ" << endl;
             return {ABORT_SCORE, the_best_move};
         }
    
@@ -2757,13 +3402,33 @@ tuple<Score, Move> MinimaxAI::recursive_negamaxQ(
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
+//
+// Late move reductions (_FEATURE_LMR). Plies to reduce the search of the move_number'th move 
+// (1 based, in sort_moves_for_search() order) at this depth. 
+// Grows with the log of both: 0.75 + ln(depth) * ln(move_number) / 2.25
+static int lmr_reduction(int depth, int move_number) {
+    constexpr int LMR_TABLE_SIZE = 64;
+    static const auto table = [] {
+        std::array<std::array<uint8_t, LMR_TABLE_SIZE>, LMR_TABLE_SIZE> t{};
+        for (int d = 1; d < LMR_TABLE_SIZE; d++) {
+            for (int m = 1; m < LMR_TABLE_SIZE; m++) {
+                t[d][m] = (uint8_t)(0.75 + std::log((double)d) * std::log((double)m) / 2.25);
+            }
+        }
+        return t;
+    }();
+    return table[std::min(depth, LMR_TABLE_SIZE - 1)][std::min(move_number, LMR_TABLE_SIZE - 1)];
+}
+
+
 // returns false if success, true if abort (ABORT_SCORE) happened
 bool MinimaxAI::loop_over_all_moves(int depth, 
                        Score &alpha, const Score beta, 
                        int nPlys, int qPlys,
                        bool in_check,
+                       bool is_pv_node,         // Only the first move searched from a PV node leads to a PV node.
                        Score d_stand_pat, 
-                       const vector<ShumiChess::Move>* pMoves, 
+                       MovePicker& picker,              // hands out the moves, in search order
                        ShumiChess::Move &bestMoveOut,   // output only 
                        Score &bestScoreOut,             // output and inout
                        bool& did_cutoff)
@@ -2783,8 +3448,14 @@ bool MinimaxAI::loop_over_all_moves(int depth,
 
     bool bFutilityPrunedAny = false;
 
+    // Quiet moves searched so far, for the history malus on a cutoff (_FEATURE_HISTORY)
+    constexpr int MAX_QUIETS_TRIED = 64;
+    ShumiChess::Move quiets_tried[MAX_QUIETS_TRIED];
+    int n_quiets_tried = 0;
+
 
-    for (const Move& m : *pMoves) {
+    Move m;
+    while (picker.next(m)) {
         //int nChars;
 
         #ifdef _DEBUGGING_PUSH_POP
@@ -2804,7 +3475,7 @@ bool MinimaxAI::loop_over_all_moves(int depth,
 
             // Print move number (out of) (this is printed as the move prefix)
             // Change 11, need a size() that ignores "zero moves"
-            int isizedebug = pMoves->size();
+            int isizedebug = picker.n_known();
             sprintf(szDebug, "[%2d/%2d]", imovedebug, isizedebug);
 
             // Print move with prefix (Move always starts a new line)
@@ -2930,9 +3601,48 @@ bool MinimaxAI::loop_over_all_moves(int depth,
 
         }
 
+        //
+        // Late move reductions. Late, quiet, non killer moves, that do not check, are first searched 
+        // shallower. Not when in check. (nSearched is still the count before this move)
+        int lmr_plys = 0;
+        if ( (Features_mask & _FEATURE_LMR) &&
+             (depth >= LMR_MIN_DEPTH) &&
+             (nSearched >= LMR_FULL_DEPTH_MOVES) &&
+             (m.capture == Piece::NONE) &&
+             (m.promotion == Piece::NONE) &&
+             (!(m == killer1[nPlys])) &&
+             (!(m == killer2[nPlys])) ) {
+
+            lmr_plys = lmr_reduction(depth, nSearched + 1);
+            if (is_pv_node) lmr_plys--;                         // reduce the PV less
+            lmr_plys = std::min(lmr_plys, depth - 2);           // leave at least one ply of regular search
+
+            if (lmr_plys > 0) {
+                if (!futility_incheck_have) {
+                    futility_incheck_have = true;
+
+                    if (engine.game_board.turn == ShumiChess::Color::WHITE)
+                        futility_bInCheck = engine.is_king_in_check_t<ShumiChess::Color::WHITE>();
+                    else
+                        futility_bInCheck = engine.is_king_in_check_t<ShumiChess::Color::BLACK>();
+                }
+
+                const bool is_a_check = (futility_bInCheck) ? true :
+                    (m.color == ShumiChess::Color::WHITE)
+                        ? engine.in_check_after_move_fast_t<ShumiChess::Color::WHITE, false>(m)
+                        : engine.in_check_after_move_fast_t<ShumiChess::Color::BLACK, false>(m);
+
+                if (is_a_check) lmr_plys = 0;
+            }
+        }
+
         // push move
         nSearched++;
         assert(m.piece_type != Piece::NONE);
+
+        if ((depth > 0) && (n_quiets_tried < MAX_QUIETS_TRIED) && (!engine.is_unquiet_move(m))) {
+            quiets_tried[n_quiets_tried++] = m;
+        }
         if (m.color == Color::WHITE) engine.pushMove_t<Color::WHITE>(m);
         else                         engine.pushMove_t<Color::BLACK>(m);
 
@@ -2964,14 +3674,37 @@ bool MinimaxAI::loop_over_all_moves(int depth,
 
         if (new_depth) {
 
-            ret_val = recursive_negamax(
-                new_depth,
-                childAlpha, childBeta,
-                false,                    // I am NOT called from the root
-                //m,
-                (nPlys+1),
-                qPlys
-            );
+            bool bFullDepth = true;
+
+            if (lmr_plys > 0) {
+                n_lmr_reduced++;
+                ret_val = recursive_negamax(
+                    (new_depth - lmr_plys),
+                    childAlpha, childBeta,
+                    false,                    // I am NOT called from the root
+                    (nPlys+1),
+                    qPlys,
+                    false
+                );
+
+                // The reduced search says this move beats alpha. Do not believe it until it is 
+                // searched to the full depth.
+                const Score d_reduced_return = get<0>(ret_val);
+                bFullDepth = ((d_reduced_return != ABORT_SCORE) && (-d_reduced_return > alpha));
+                if (bFullDepth) n_lmr_researches++;
+            }
+
+            if (bFullDepth) {
+                ret_val = recursive_negamax(
+                    new_depth,
+                    childAlpha, childBeta,
+                    false,                    // I am NOT called from the root
+                    //m,
+                    (nPlys+1),
+                    qPlys,
+                    (is_pv_node && (nSearched == 1))
+                );
+            }
 
         } else {
 
@@ -3120,7 +3853,17 @@ bool MinimaxAI::loop_over_all_moves(int depth,
                 }
             #endif
 
+            if (depth > 0) {
+                n_cutoff_nodes++;
+                if (nSearched == 1) n_first_move_cutoffs++;
+            }
+
             if ((depth > 0) && (!engine.is_unquiet_move(m))) {
+
+                if (Features_mask & _FEATURE_HISTORY) {
+                    update_quiet_history(m, depth, nPlys, quiets_tried, n_quiets_tried);
+                }
+
                 // Quiet moves that "cut off" are "notable", or "killer moves"
                 if (killer1[nPlys] == ShumiChess::Move{}) {
                     killer1[nPlys] = m;
@@ -3147,6 +3890,49 @@ bool MinimaxAI::loop_over_all_moves(int depth,
 }
 
 
+//
+// A quiet move cut off at this depth (_FEATURE_HISTORY). Rewards it, punishes the quiet moves 
+// searched before it, and makes it the countermove to the move that led here.
+//      Uses "gravity" (h += bonus - h*|bonus|/HISTORY_MAX), so values saturate at +/- HISTORY_MAX
+//      instead of overflowing, and old values fade as new ones come in.
+void MinimaxAI::update_quiet_history(const ShumiChess::Move& cutoff_move, int depth, int nPlys,
+                                     const ShumiChess::Move* quiets_tried, int n_quiets_tried) {
+
+    const int bonus = std::min(depth * depth, 400);
+
+    auto apply = [&](const ShumiChess::Move& mv, int delta) {
+        int& h = history[mv.color][mv.fromSQ][mv.toSQ];
+        h += delta - (h * std::abs(delta)) / HISTORY_MAX;
+        assert((h >= -HISTORY_MAX) && (h <= HISTORY_MAX));
+    };
+
+    apply(cutoff_move, bonus);
+    for (int i = 0; i < n_quiets_tried; i++) {
+        if (!(quiets_tried[i] == cutoff_move)) apply(quiets_tried[i], -bonus);
+    }
+
+    // Countermove. (No previous move at the start of a game, and none to refute after a null move)
+    assert(nPlys > 0);
+    const ShumiChess::Move* p_prev = engine.last_move();
+    if (p_prev && !null_move_at_ply[nPlys-1]) {
+        const ShumiChess::Move& prev = *p_prev;
+        assert(prev.piece_type != Piece::NONE);
+        countermove[prev.color][prev.piece_type][prev.toSQ] = cutoff_move;
+    }
+}
+
+
+//
+// Between deepenings, halve the history, so the newer (deeper) cutoffs count more.
+void MinimaxAI::age_history() {
+    for (auto& by_color : history) {
+        for (auto& by_from : by_color) {
+            for (int& h : by_from) h /= 2;
+        }
+    }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 //  Resort moves in this order (they will later be searched in this order):
@@ -3155,7 +3941,8 @@ bool MinimaxAI::loop_over_all_moves(int depth,
 //      captures/promotions  (unquiet moves (captures/promotions, sorted by MVV-LVA, and "last square")
 //      castling
 //      killer moves         (quiet, bubbled to the front of the "cutoff" quiet slice).
-//      remaining quiet moves
+//      countermove          (quiet, the move that last refuted the previous move)
+//      remaining quiet moves (by history score)
 //  Sorts moves in place.
 //      Explanation: So why sort, if we look at all legal moves? Regular search considers all legal moves except those removed by pruning.
 //      But move ordering still matters: searching strong moves first raises alpha sooner
@@ -3163,7 +3950,7 @@ bool MinimaxAI::loop_over_all_moves(int depth,
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-bool MinimaxAI::sort_moves_for_search(std::vector<ShumiChess::Move>* pMovesInOut   // input/output
+bool MinimaxAI::sort_moves_for_search(MoveList* pMovesInOut   // input/output
                             , int depth, int nPlys, bool is_top_of_deepening)
 {
     assert(pMovesInOut);
@@ -3173,12 +3960,6 @@ bool MinimaxAI::sort_moves_for_search(std::vector<ShumiChess::Move>* pMovesInOut
         return false;
     }
 
-    const bool have_last = !engine.move_history.empty();
-    Square last_toSQ = ShumiChess::NO_SQUARE;
-    if (have_last) {
-        last_toSQ = engine.move_history.top().toSQ;
-    }
-
     //  The sort, from top to bottom. Items 0 and 1 done always, the rest done if the unquiet sort is on.
     //      0. Move from the hash table hit (if any).
     //      1. PV from the previous iteration (previous deepening’s best).
@@ -3187,24 +3968,19 @@ bool MinimaxAI::sort_moves_for_search(std::vector<ShumiChess::Move>* pMovesInOut
     //         get an MVV-LVA base score here.
     //      2.5 Bubble castling moves to the front of the quiet region.
     //      3. Killer moves (quiet, bubbled to the front of the remaining quiet region).
-    //      4. Remaining quiet moves.
+    //      3.5 Countermove to the previous move (_FEATURE_HISTORY).
+    //      4. Remaining quiet moves (by history score, if _FEATURE_HISTORY).
 
     if (Features_mask &_FEATURE_UNQUIET_SORT) {
 
-
-
-        // it_split still points to the first quiet move, exactly as the later code expects.
-
-
-
         // --- 1. Partition unquiet moves (captures/promotions) to the front ---
         //
         // Scan the move list once. Each unquiet move is swapped into the next
         // available position at the front of the vector.
         //
-        std::vector<ShumiChess::Move>::iterator it_split = pMovesInOut->begin();
+        MoveList::iterator it_split = pMovesInOut->begin();
 
-        for (std::vector<ShumiChess::Move>::iterator it = pMovesInOut->begin();
+        for (MoveList::iterator it = pMovesInOut->begin();
             it != pMovesInOut->end();
             ++it) {
 
@@ -3215,103 +3991,14 @@ bool MinimaxAI::sort_moves_for_search(std::vector<ShumiChess::Move>* pMovesInOut
         }
 
 
-        // --- 2. Sort the unquiet prefix using MVV-LVA and SEE ---
-        //
-        // Calculate each move's ordering key once. This avoids repeatedly
-        // calculating SEE while the moves are being sorted.
-        //
-        const int nUnquietMoves =
-            static_cast<int>(std::distance(pMovesInOut->begin(), it_split));
-
-        std::vector<int> moveKeys(nUnquietMoves);
-
-        for (int i = 0; i < nUnquietMoves; i++) {
-            const ShumiChess::Move& mv = (*pMovesInOut)[i];
-
-            int key = 0;
-
-            // Captures are ordered by MVV-LVA.
-            if (mv.capture != ShumiChess::Piece::NONE) {
-                key = engine.mvv_lva_key(mv) << 10;
-
-                // Strongly penalize captures that lose material.
-                const int see =
-                    engine.game_board.SEE_for_capture_new(
-                        engine.game_board.turn, mv, nullptr);
-
-                if (see < 0) key += see * 100;
-            }
-
-            // Prefer a move to the destination square of the preceding move.
-            if (mv.toSQ == last_toSQ) key += 800;
-
-            moveKeys[i] = key;
-        }
-
-        // Sort the unquiet moves from highest key to lowest key.
-        //
-        // Capture lists are normally small, so insertion sort is appropriate here.
-        // The already-calculated keys move with their corresponding moves.
-        //
-        for (int i = 1; i < nUnquietMoves; i++) {
-            const ShumiChess::Move moveToInsert = (*pMovesInOut)[i];
-            const int keyToInsert = moveKeys[i];
-
-            int j = i - 1;
-
-            while (j >= 0 && moveKeys[j] < keyToInsert) {
-                (*pMovesInOut)[j + 1] = (*pMovesInOut)[j];
-                moveKeys[j + 1] = moveKeys[j];
-                j--;
-            }
-
-            (*pMovesInOut)[j + 1] = moveToInsert;
-            moveKeys[j + 1] = keyToInsert;
-        }
-
-
-        // It is known that Killer moves force "TT2 unrepeatibility". The theory is I guess that the
-        // later analysis is profited by these killer moves.
-        #ifndef DEBUG_NODE_TT2
-        if (Features_mask & _FEATURE_KILLER) {
-            // --- 3. Apply killer moves to the quiet region (for speed, not re-sorting) ---
-            auto quiet_begin = it_split;
-            auto quiet_end   = pMovesInOut->end();
-
-            // 2.5  Bubble castling moves to the front of the quiet region ---
-            for (auto it = quiet_begin; it != quiet_end; ++it) {
-                const ShumiChess::Move& mv = *it;
-
-                if (mv.flags & FLAGS_IS_CASTLE_MOVE) {
-                    std::rotate(quiet_begin, it, it + 1);
-                    ++quiet_begin;   // if a second castle move exists, it goes just after the first
-                }
-            }
-
-            auto bring_front = [&](const ShumiChess::Move& km)
-            {
-                if (km == ShumiChess::Move{}) return;
-                for (auto it = quiet_begin; it != quiet_end; ++it) {
-                    if (*it == km) {
-                        std::rotate(quiet_begin, it, it + 1);
-                        ++quiet_begin; // next killer goes just after previous
-                        break;
-                    }
-                }
-            };
-            
-            bring_front(killer1[nPlys]);
-
-            #ifdef DEBUGGING_KILLER_MOVES1
-                engine.move_into_string(killer1[nPlys]);
-                fprintf(fpDebug, " killer1-> %s\n", engine.move_string.c_str());
-                engine.print_move_history_to_file(fpDebug, "BB");
-            #endif
+        const int i_split = static_cast<int>(it_split - pMovesInOut->begin());
+        const int n_moves = static_cast<int>(pMovesInOut->size());
 
-            bring_front(killer2[nPlys]);
+        // --- 2. Sort the unquiet prefix using MVV-LVA and SEE ---
+        order_unquiet_moves(*pMovesInOut, 0, i_split);
 
-        }
-        #endif
+        // --- 2.5, 3, 3.5, 4. The quiet region ---
+        order_quiet_moves(*pMovesInOut, i_split, n_moves, nPlys, true);
 
     }
 
@@ -3363,6 +4050,147 @@ bool MinimaxAI::sort_moves_for_search(std::vector<ShumiChess::Move>* pMovesInOut
 }
 
 
+//
+// Orders unquiet moves (captures/promotions) in place: MVV-LVA, losing captures (SEE) last, and a
+// bonus for recapturing on the square the previous move went to. Orders moves[i_begin, i_end).
+void MinimaxAI::order_unquiet_moves(MoveList& moves, int i_begin, int i_end) {
+
+    Square last_toSQ = ShumiChess::NO_SQUARE;
+    if (const ShumiChess::Move* p_last = engine.last_move()) {
+        last_toSQ = p_last->toSQ;
+    }
+
+    //
+    // Calculate each move's ordering key once, into the list's scores. This avoids repeatedly
+    // calculating SEE while the moves are being sorted.
+    //
+    for (int i = i_begin; i < i_end; i++) {
+        const ShumiChess::Move& mv = moves[i];
+
+        int key = 0;
+
+        // Captures are ordered by MVV-LVA.
+        if (mv.capture != ShumiChess::Piece::NONE) {
+            key = engine.mvv_lva_key(mv) << 10;
+
+            // Strongly penalize captures that lose material. Most don't, and see_ge() says so cheaply.
+            if (!engine.game_board.see_ge(mv, 0)) key += engine.game_board.see(mv) * 100;
+        }
+
+        // Prefer a move to the destination square of the preceding move.
+        if (mv.toSQ == last_toSQ) key += 800;
+
+        moves.score(i) = key;
+    }
+
+    // Sort the unquiet moves from highest key to lowest key.
+    //
+    // Capture lists are normally small, so insertion sort is appropriate here.
+    // The already-calculated keys move with their corresponding moves.
+    //
+    insertion_sort_by_score(moves, i_begin, i_end);
+}
+
+//
+// Sorts moves[i_begin, i_end) by their scores, highest first. Stable, so ties keep their order.
+void MinimaxAI::insertion_sort_by_score(MoveList& moves, int i_begin, int i_end) {
+
+    for (int i = i_begin + 1; i < i_end; i++) {
+        const ShumiChess::Move moveToInsert = moves[i];
+        const int keyToInsert = moves.score(i);
+
+        int j = i - 1;
+
+        while (j >= i_begin && moves.score(j) < keyToInsert) {
+            moves[j + 1] = moves[j];
+            moves.score(j + 1) = moves.score(j);
+            j--;
+        }
+
+        moves[j + 1] = moveToInsert;
+        moves.score(j + 1) = keyToInsert;
+    }
+}
+
+//
+// Orders quiet moves in place: castling, the killers (if b_killers), the countermove, then by history.
+// The MovePicker hands out the killers itself, so it passes b_killers false.
+// Under DEBUG_NODE_TT2 none of this is done. Killers, countermoves and history all depend on what was 
+// searched before, and that debug needs the TT2 repeatable.
+void MinimaxAI::order_quiet_moves(MoveList& moves, int i_begin, int i_end,
+                                  int nPlys, bool b_killers) {
+
+    #ifdef DEBUG_NODE_TT2
+        return;
+    #endif
+
+    // The quiet region. Moves brought to its front (killers, countermove) are stepped over.
+    MoveList::iterator quiet_begin = moves.begin() + i_begin;
+    MoveList::iterator quiet_end   = moves.begin() + i_end;
+
+    auto bring_front = [&](const ShumiChess::Move& km)
+    {
+        if (km == ShumiChess::Move{}) return;
+        for (auto it = quiet_begin; it != quiet_end; ++it) {
+            if (*it == km) {
+                std::rotate(quiet_begin, it, it + 1);
+                ++quiet_begin; // next killer goes just after previous
+                break;
+            }
+        }
+    };
+
+    // It is known that Killer moves force "TT2 unrepeatibility". The theory is I guess that the
+    // later analysis is profited by these killer moves.
+    if (Features_mask & _FEATURE_KILLER) {
+        // --- 3. Apply killer moves to the quiet region (for speed, not re-sorting) ---
+
+        // 2.5  Bubble castling moves to the front of the quiet region ---
+        for (auto it = quiet_begin; it != quiet_end; ++it) {
+            const ShumiChess::Move& mv = *it;
+
+            if (mv.flags & FLAGS_IS_CASTLE_MOVE) {
+                std::rotate(quiet_begin, it, it + 1);
+                ++quiet_begin;   // if a second castle move exists, it goes just after the first
+            }
+        }
+
+        if (b_killers) {
+            bring_front(killer1[nPlys]);
+
+            #ifdef DEBUGGING_KILLER_MOVES1
+                engine.move_into_string(killer1[nPlys]);
+                fprintf(fpDebug, " killer1-> %s\n", engine.move_string.c_str());
+                engine.print_move_history_to_file(fpDebug, "BB");
+            #endif
+
+            bring_front(killer2[nPlys]);
+        }
+
+    }
+
+    if (Features_mask & _FEATURE_HISTORY) {
+        // --- 3.5 Countermove (the quiet move that last refuted the previous move) ---
+        if (const ShumiChess::Move* p_prev = engine.last_move()) {
+            const ShumiChess::Move& prev = *p_prev;
+            bring_front(countermove[prev.color][prev.piece_type][prev.toSQ]);
+        }
+
+        // --- 4. Sort the remaining quiet moves by history, highest first ---
+        //
+        // Same insertion sort as the unquiet moves. It is stable, so ties keep generation order.
+        //
+        const int i_quiet_begin = static_cast<int>(quiet_begin - moves.begin());
+        for (int i = i_quiet_begin; i < i_end; i++) {
+            const ShumiChess::Move& mv = moves[i];
+            moves.score(i) = history[mv.color][mv.fromSQ][mv.toSQ];
+        }
+
+        insertion_sort_by_score(moves, i_quiet_begin, i_end);
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 
 
@@ -3457,7 +4285,7 @@ try_again:
 
 #ifdef _DEBUGGING_MOVE_SORT
 
-    void MinimaxAI::print_moves_to_file(const vector<Move> &mvs, int depth, char* szHeader, char* szTrailer) {
+    void MinimaxAI::print_moves_to_file(const MoveList &mvs, int depth, char* szHeader, char* szTrailer) {
 
         if (szHeader != NULL) {int ierr = fprintf(fpDebug, szHeader);}
 
@@ -3485,37 +4313,84 @@ const PawnFileInfo& MinimaxAI::get_pawn_file_info_for_position() {
 
     NTriesP++;
 
-    auto it = pawn_file_info.find(key);
-    if (it != pawn_file_info.end()) {
+    const PawnFileInfo* pFound = pawn_hash.probe(key);
+    if (pFound != NULL) {
         // found an "pawn summary" entry in the hash (this is the more common case)
         NhitsP++;
 
         #ifdef DEBUGGING_PAWN_HASH
             engine.game_board.build_pawn_summaries(pawnFileInfoTemp);
-            if (!(pawnFileInfoTemp.p[0] == it->second.p[0])) {
+            if (!(pawnFileInfoTemp.p[0] == pFound->p[0])) {
                 assert(0);
             }
-            if (!(pawnFileInfoTemp.p[1] == it->second.p[1])) {
+            if (!(pawnFileInfoTemp.p[1] == pFound->p[1])) {
                 assert(0);
             }
         #endif
 
-        return it->second;
+        return *pFound;
     }
 
     // rebuild the pawn summary.
     engine.game_board.build_pawn_summaries(pawnFileInfoTemp);
 
-    // Add to hash
-    auto result = pawn_file_info.emplace(key, pawnFileInfoTemp);
-    return result.first->second;
+    // Add to hash (replaces whatever was in the slot)
+    return pawn_hash.store(key, pawnFileInfoTemp);
+}
+
+const MaterialInfo& MinimaxAI::get_material_info_for_position() {
+
+    const uint64_t key = engine.game_board.material_key;
+
+    const MaterialInfo* pFound = material_hash.probe(key);
+    if (pFound != NULL) return *pFound;
+
+    MaterialInfo materialInfoTemp;
+    build_material_info(materialInfoTemp);
+    return material_hash.store(key, materialInfoTemp);
+}
+
+//
+// Everything in the eval that depends only on the piece counts.
+//      phase:      material_phase()
+//      scale:      without pawns, a side up no more than a minor piece can hardly win (0 with less than
+//                  a rook). Insufficient material is 0 for both.
+//      endgame:    a specialized evaluator for this material (endgame.hpp)
+//
+void MinimaxAI::build_material_info(MaterialInfo& mi) {
+    using namespace ShumiChess;
+
+    GameBoard& b = engine.game_board;
+
+    const bool no_queens = (b.Bits_In[WHITE][Piece::QUEEN] == 0) && (b.Bits_In[BLACK][Piece::QUEEN] == 0);
+    mi.phase = material_phase((b.material_cp[WHITE] + b.material_cp[BLACK]) / 2, no_queens);
+
+    const int pawn_cp = b.centipawn_score_of(Piece::PAWN);
+    const int bishop_cp = b.centipawn_score_of(Piece::BISHOP);
+    const int rook_cp = b.centipawn_score_of(Piece::ROOK);
+    const int npm_cp[2] = { b.material_cp[WHITE] - b.Bits_In[WHITE][Piece::PAWN] * pawn_cp,
+                            b.material_cp[BLACK] - b.Bits_In[BLACK][Piece::PAWN] * pawn_cp };
+
+    for (const Color c : {WHITE, BLACK}) {
+        const Color enemy = utility::representation::opposite_color(c);
+        mi.scale[c] = MaterialInfo::SCALE_NORMAL;
+        if ((b.Bits_In[c][Piece::PAWN] == 0) && (npm_cp[c] - npm_cp[enemy] <= bishop_cp)) {
+            mi.scale[c] = (npm_cp[c] < rook_cp) ? 0 : ((npm_cp[enemy] <= bishop_cp) ? 4 : 14);
+        }
+    }
+    if (b.insufficient_material_simple()) mi.scale[WHITE] = mi.scale[BLACK] = 0;
+
+    const endgame::Entry* eg = endgame::find(b.material_key);
+    mi.endgame = eg ? eg->fn : nullptr;
+    mi.endgame_strong = eg ? eg->strong_side : WHITE;
+    mi.endgame_is_exact = eg ? eg->is_exact : false;
 }
 
 //
 // I am called UNLESS there are no enemy major pieces left
 //
 template<ShumiChess::Color c>
-int MinimaxAI::cp_score_positional_get_open_cp_t(int nPhase, const PawnFileInfo*& pawnFileInfoP) {
+int MinimaxAI::cp_score_positional_get_open_cp_t(int nPhase, const PawnFileInfo*& pawnFileInfoP, const AttackInfo& attackInfo) {
     using namespace ShumiChess;
 
     constexpr Color enemyColor = utility::representation::opposite_color_t<c>;
@@ -3615,7 +4490,7 @@ int MinimaxAI::cp_score_positional_get_open_cp_t(int nPhase, const PawnFileInfo*
 
     cp_score_position_temp += icp_temp;
 
-    icp_temp = engine.game_board.knights_attacking_center_squares_cp_t<c>();
+    icp_temp = engine.game_board.knights_attacking_center_squares_cp_t<c>(attackInfo);
     cp_score_position_temp += icp_temp;
 
     int multiplier;
@@ -3625,9 +4500,6 @@ int MinimaxAI::cp_score_positional_get_open_cp_t(int nPhase, const PawnFileInfo*
     icp_temp = engine.game_board.bishops_attacking_center_squares_cp_t<c>();
     cp_score_position_temp += (icp_temp*multiplier);
 
-    icp_temp = engine.game_board.is_knight_on_edge_cp_t<c>();
-    cp_score_position_temp += icp_temp;
-
     return cp_score_position_temp;
 }
 
@@ -3635,7 +4507,7 @@ int MinimaxAI::cp_score_positional_get_open_cp_t(int nPhase, const PawnFileInfo*
 // I am called UNLESS there are no enemy major pieces left
 //
 template<ShumiChess::Color c>
-int MinimaxAI::cp_score_positional_get_middle_cp_t(int nPhase) {
+int MinimaxAI::cp_score_positional_get_middle_cp_t(int nPhase, const AttackInfo& attackInfo) {
     int cp_score_position_temp = 0;
     int icp_temp;
 
@@ -3654,7 +4526,7 @@ int MinimaxAI::cp_score_positional_get_middle_cp_t(int nPhase) {
     cp_score_position_temp += icp_temp;
 
     if (nPhase != GamePhase::ENDGAME_LATE) {
-        icp_temp = engine.game_board.potential_checks_against_king_cp_t<c>();
+        icp_temp = engine.game_board.potential_checks_against_king_cp_t<c>(attackInfo);
         cp_score_position_temp += icp_temp;
     }
 
@@ -3666,14 +4538,15 @@ int MinimaxAI::cp_score_positional_get_middle_cp_t(int nPhase) {
 // I am called always
 //
 template<ShumiChess::Color c>
-int MinimaxAI::cp_score_positional_get_end_t(int nPhase, int cp_material_all, bool noMajorPiecesFriend, bool noMajorPiecesEnemy) {
+int MinimaxAI::cp_score_positional_get_end_t(int nPhase, int cp_material_all, bool noMajorPiecesFriend, bool noMajorPiecesEnemy
+                                            , const AttackInfo& attackInfo) {
     using namespace ShumiChess;
 
     int icp_temp;
     int cp_score_position_temp = 0;
 
     if (nPhase > GamePhase::OPENING) {
-        icp_temp = engine.game_board.attackers_on_enemy_king_near_cp_t<c>();
+        icp_temp = engine.game_board.attackers_on_enemy_king_near_cp_t<c>(attackInfo);
         cp_score_position_temp += icp_temp;
     }
 
@@ -3682,12 +4555,6 @@ int MinimaxAI::cp_score_positional_get_end_t(int nPhase, int cp_material_all, bo
         cp_score_position_temp += icp_temp;
     }
 
-    // King to center in end
-    if (nPhase >= GamePhase::ENDGAME) {
-        icp_temp = engine.game_board.king_centerness_cp_t<c>();
-        cp_score_position_temp += icp_temp;       
-    }
-
     // if (nPhase >= GamePhase::MIDDLE) {
     //     icp_temp = engine.game_board.opposite_bishops_cp_t<c>(cp_material_all);
     //     cp_score_position_temp += icp_temp;
@@ -3710,11 +4577,26 @@ int MinimaxAI::cp_score_positional_get_end_t(int nPhase, int cp_material_all, bo
 
 //  Final eval is (material+positional).
 template<ShumiChess::Color for_color>
-int MinimaxAI::evaluate_board_t(ShumiChess::EvalPersons evp) {
+int MinimaxAI::evaluate_board_t(ShumiChess::EvalPersons evp, int alpha_cp, int beta_cp) {
     using namespace ShumiChess;
 
     evals_visited++;
 
+    // Piece counts only: phase, scale and known endgames
+    const MaterialInfo& mi = get_material_info_for_position();
+    if (mi.endgame != nullptr) {
+        const int cp_known = mi.endgame(engine.game_board, mi.endgame_strong);
+        return (mi.endgame_strong == for_color) ? cp_known : -cp_known;
+    }
+
+    if (evp == EvalPersons::NNUE && nnue::is_loaded()) {
+        const int cp_nnue = engine.nnue_evaluate();
+        return (engine.game_board.turn == for_color) ? cp_nnue : -cp_nnue;
+    }
+
+    // The pawn/file info is needed later in the eval. Start loading its hash slot now.
+    pawn_hash.prefetch(engine.game_board.pawn_zobrist_key);
+
     int cp_score_adjusted = 0;
 
     int mat_cp_white = 0;
@@ -3722,8 +4604,13 @@ int MinimaxAI::evaluate_board_t(ShumiChess::EvalPersons evp) {
 
     int tempsum = 0;
 
-    // Computes "Bits_In" (many eval routines use these shortcuts for speed)
-    engine.game_board.compute_bits_in();        // Computes shortcuts for "bits_in()", used in the eval.
+    // Bits_In, material_cp and psq are kept up to date by pushMove_t()/popMove_t().
+    #ifdef DEBUGGING_INCREMENTAL_EVAL
+        if (!engine.game_board.material_and_psq_are_valid()) {
+            sout << "burp4 " << engine.game_board.to_fen() << std::endl;
+            assert(0);
+        }
+    #endif
 
     //int tempsumNP = 0;
 
@@ -3738,12 +4625,9 @@ int MinimaxAI::evaluate_board_t(ShumiChess::EvalPersons evp) {
     int cp_score_pawns_only = 0;
 
     for (const auto& color1 : std::array<Color, 2>{Color::WHITE, Color::BLACK}) {
-        int cp_pawns_only_temp;
+        int cp_pawns_only_temp = engine.game_board.Bits_In[color1][Piece::PAWN] * engine.game_board.centipawn_score_of(Piece::PAWN);
 
-        int cp_score_mat_temp = (color1 == Color::WHITE)
-            ? engine.game_board.get_material_for_color2_t<Color::WHITE>(cp_pawns_only_temp)
-            : engine.game_board.get_material_for_color2_t<Color::BLACK>(cp_pawns_only_temp);
-        //assert(cp_score_mat_temp == cp_score_mat_temp2);
+        int cp_score_mat_temp = engine.game_board.material_cp[color1];
         assert(cp_score_mat_temp >= 0);
 
         if (color1 == Color::WHITE) {
@@ -3776,19 +4660,41 @@ int MinimaxAI::evaluate_board_t(ShumiChess::EvalPersons evp) {
     //
     // Get phase of game (note phase is not used for material)
     // NOTE phase must be computed before any positional eval.
-    int nPhase = phase_of_game(cp_score_material_avg);
+    int nPhase = castled_phase(mi.phase);
+    #ifdef DEBUGGING_INCREMENTAL_EVAL       // The cached phase is the one the material gives
+        assert(nPhase == phase_of_game(cp_score_material_avg));
+    #endif
+
+    // Lazy exit. With material and piece-square in, if the rest of the positional terms cannot bring the
+    // score back inside the window, skip them. (Only without a window is the full eval always returned.)
+    // Not when the material scales the score, which could bring it back inside.
+    const bool b_scaled = (mi.scale[WHITE] != MaterialInfo::SCALE_NORMAL) || (mi.scale[BLACK] != MaterialInfo::SCALE_NORMAL);
+    if ((evp == EvalPersons::UNCLE_SHUMI) && !b_scaled) {
+        constexpr Color enemy_color = utility::representation::opposite_color_t<for_color>;
+        const PsqScore& psqF = engine.game_board.psq[for_color];
+        const PsqScore& psqE = engine.game_board.psq[enemy_color];
+        const int cp_psq = (nPhase >= GamePhase::ENDGAME) ? (psqF.eg - psqE.eg) : (psqF.mg - psqE.mg);
+
+        const int cp_score_lazy = cp_score_material_all + cp_psq;
+        const int margin_cp = lazy_eval_margin_cp[nPhase];
+        if ((cp_score_lazy - margin_cp >= beta_cp) || (cp_score_lazy + margin_cp <= alpha_cp)) {
+            evals_lazy_exits++;
+            return cp_score_lazy;
+        }
+    }
 
     int cp_score_position = 0;
     //bool isOK;
     int cp_score_position_temp;
 
-    const PawnFileInfo* pawnFileInfoP = NULL;   // Initialize the lazy pointer
+    const PawnFileInfo* pawnFileInfoP = NULL;   // Initialize the lazy pointers
+    const AttackInfo* attackInfoP = NULL;
 
-    cp_score_position_temp =  get_positional_for_one_color<Color::WHITE>(nPhase, evp, cp_score_material_all, pawnFileInfoP);
+    cp_score_position_temp =  get_positional_for_one_color<Color::WHITE>(nPhase, evp, cp_score_material_all, pawnFileInfoP, attackInfoP);
     if (Color::WHITE != for_color) cp_score_position_temp *= -1;
     cp_score_position += cp_score_position_temp;
 
-    cp_score_position_temp =  get_positional_for_one_color<Color::BLACK>(nPhase, evp, cp_score_material_all, pawnFileInfoP);
+    cp_score_position_temp =  get_positional_for_one_color<Color::BLACK>(nPhase, evp, cp_score_material_all, pawnFileInfoP, attackInfoP);
     if (Color::BLACK != for_color) cp_score_position_temp *= -1;
     cp_score_position += cp_score_position_temp;
 
@@ -3796,13 +4702,19 @@ int MinimaxAI::evaluate_board_t(ShumiChess::EvalPersons evp) {
     // Add the material and positional togather to get a final return in centipawns.
     cp_score_adjusted = cp_score_material_all + cp_score_position;
 
+    // Drawish material. Shrink the score of the side that is ahead.
+    if (b_scaled) {
+        const Color ahead = (cp_score_adjusted > 0) ? for_color : utility::representation::opposite_color_t<for_color>;
+        cp_score_adjusted = cp_score_adjusted * mi.scale[ahead] / MaterialInfo::SCALE_NORMAL;
+    }
+
     return cp_score_adjusted;
 }
 
 // Final eval is (material+positional).
 template<ShumiChess::Color c> 
 int MinimaxAI::get_positional_for_one_color(int nPhase, ShumiChess::EvalPersons evp, int cp_score_material_all
-                                            , const PawnFileInfo*& pawnFileInfoP)
+                                            , const PawnFileInfo*& pawnFileInfoP, const AttackInfo*& attackInfoP)
 {
     int bonus_cp;
     int temp;
@@ -3829,16 +4741,26 @@ int MinimaxAI::get_positional_for_one_color(int nPhase, ShumiChess::EvalPersons
             bool NoMajorPiecesEnemy  = engine.game_board.hasNoMajorPieces_t<enemy_of_color>();
             bool NoMajorPiecesFriend = engine.game_board.hasNoMajorPieces_t<c>();
 
+            // Lazy pointer. Build the attack maps only once for the pair of color eval calls.
+            if (attackInfoP == NULL) {
+                engine.game_board.build_attack_info(attack_info);
+                attackInfoP = &attack_info;
+            }
+
             if (!NoMajorPiecesEnemy) {
-                temp = cp_score_positional_get_open_cp_t<c>(nPhase, pawnFileInfoP);
+                temp = cp_score_positional_get_open_cp_t<c>(nPhase, pawnFileInfoP, *attackInfoP);
                 cp_score_position_temp += temp;
 
-                temp = cp_score_positional_get_middle_cp_t<c>(nPhase);
+                temp = cp_score_positional_get_middle_cp_t<c>(nPhase, *attackInfoP);
                 cp_score_position_temp += temp;
             }
-            temp = cp_score_positional_get_end_t<c>(nPhase, cp_score_material_all, NoMajorPiecesFriend, NoMajorPiecesEnemy);
+            temp = cp_score_positional_get_end_t<c>(nPhase, cp_score_material_all, NoMajorPiecesFriend, NoMajorPiecesEnemy, *attackInfoP);
             cp_score_position_temp += temp;
 
+            // Piece-square terms (knights on the edge, king to the center in the end)
+            const PsqScore& psq = engine.game_board.psq[c];
+            cp_score_position_temp += (nPhase >= GamePhase::ENDGAME) ? psq.eg : psq.mg;
+
             break;
         }
     }
@@ -3848,20 +4770,20 @@ int MinimaxAI::get_positional_for_one_color(int nPhase, ShumiChess::EvalPersons
 }
 
 // Explicit template instantiations
-template int MinimaxAI::evaluate_board_t<ShumiChess::Color::WHITE>(ShumiChess::EvalPersons);
-template int MinimaxAI::evaluate_board_t<ShumiChess::Color::BLACK>(ShumiChess::EvalPersons);
+template int MinimaxAI::evaluate_board_t<ShumiChess::Color::WHITE>(ShumiChess::EvalPersons, int, int);
+template int MinimaxAI::evaluate_board_t<ShumiChess::Color::BLACK>(ShumiChess::EvalPersons, int, int);
 
-template int MinimaxAI::get_positional_for_one_color<ShumiChess::Color::WHITE>(int nPhase, ShumiChess::EvalPersons evp, int cp_score_material_all, const ShumiChess::PawnFileInfo*& pawnFileInfoP);
-template int MinimaxAI::get_positional_for_one_color<ShumiChess::Color::BLACK>(int nPhase, ShumiChess::EvalPersons evp, int cp_score_material_all, const ShumiChess::PawnFileInfo*& pawnFileInfoP);
+template int MinimaxAI::get_positional_for_one_color<ShumiChess::Color::WHITE>(int nPhase, ShumiChess::EvalPersons evp, int cp_score_material_all, const ShumiChess::PawnFileInfo*& pawnFileInfoP, const ShumiChess::AttackInfo*& attackInfoP);
+template int MinimaxAI::get_positional_for_one_color<ShumiChess::Color::BLACK>(int nPhase, ShumiChess::EvalPersons evp, int cp_score_material_all, const ShumiChess::PawnFileInfo*& pawnFileInfoP, const ShumiChess::AttackInfo*& attackInfoP);
 
 
 
-template int MinimaxAI::cp_score_positional_get_open_cp_t<ShumiChess::Color::WHITE>(int, const ShumiChess::PawnFileInfo*&);
-template int MinimaxAI::cp_score_positional_get_open_cp_t<ShumiChess::Color::BLACK>(int, const ShumiChess::PawnFileInfo*&);
-template int MinimaxAI::cp_score_positional_get_middle_cp_t<ShumiChess::Color::WHITE>(int);
-template int MinimaxAI::cp_score_positional_get_middle_cp_t<ShumiChess::Color::BLACK>(int);
-template int MinimaxAI::cp_score_positional_get_end_t<ShumiChess::Color::WHITE>(int, int cp_material_all, bool, bool);
-template int MinimaxAI::cp_score_positional_get_end_t<ShumiChess::Color::BLACK>(int, int cp_material_all, bool, bool);
+template int MinimaxAI::cp_score_positional_get_open_cp_t<ShumiChess::Color::WHITE>(int, const ShumiChess::PawnFileInfo*&, const ShumiChess::AttackInfo&);
+template int MinimaxAI::cp_score_positional_get_open_cp_t<ShumiChess::Color::BLACK>(int, const ShumiChess::PawnFileInfo*&, const ShumiChess::AttackInfo&);
+template int MinimaxAI::cp_score_positional_get_middle_cp_t<ShumiChess::Color::WHITE>(int, const ShumiChess::AttackInfo&);
+template int MinimaxAI::cp_score_positional_get_middle_cp_t<ShumiChess::Color::BLACK>(int, const ShumiChess::AttackInfo&);
+template int MinimaxAI::cp_score_positional_get_end_t<ShumiChess::Color::WHITE>(int, int cp_material_all, bool, bool, const ShumiChess::AttackInfo&);
+template int MinimaxAI::cp_score_positional_get_end_t<ShumiChess::Color::BLACK>(int, int cp_material_all, bool, bool, const ShumiChess::AttackInfo&);
 
 
 
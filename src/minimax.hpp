@@ -9,9 +9,17 @@
 #include <string>
 #include <limits>
 #include <tuple>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 #include "features.hpp"
 #include "gameboard.hpp"
+#include "transposition_table.hpp"
+#include "pawn_hash_table.hpp"
+#include "material_hash_table.hpp"
+#include "move_picker.hpp"
 
 
 using MoveAndScore     = std::pair<ShumiChess::Move, Score>;
@@ -69,6 +77,7 @@ public:
     };
 
     MinimaxAI(ShumiChess::Engine&);
+    MinimaxAI(ShumiChess::Engine&, MinimaxAI& main_ai);     // Lazy SMP helper (shares main_ai's TT2)
     ~MinimaxAI();
 
     //ShumiChess::EvalPersons eval_person = ShumiChess::UNCLE_SHUMI;   // CRAZY_IVAN;
@@ -79,9 +88,22 @@ public:
     std::atomic<bool> stop_calculation{false};
     //bool stop_calculation = false;
 
+    // Pondering (UCI "go ponder"). The search thinks on the opponent's time, with no clock and no depth 
+    // limit, until stop_calculation, or until ponder_hit() puts it on the clock. Called from the UCI thread.
+    std::atomic<bool> pondering{false};
+    void ponder_start();                // Before the search starts
+    void ponder_hit();                  // The opponent played the expected move. Our clock starts now.
+    bool ponder_was_hit() const { return ponder_hit_time_ms != 0; }     // The last search got its ponder hit
+    ull ponder_free_ms() const;         // Of the last search, the time it searched before the ponder hit
+
+    ShumiChess::Move expected_reply();  // The TT2 move in the current position, if legal. For "bestmove .. ponder .."
+
     ull nodes_visited = 0;
     ull nodes_visited_depth_zero = 0;
     ull evals_visited = 0;
+    ull evals_lazy_exits = 0;          // evals that returned before the positional terms (_FEATURE_LAZY_EVAL)
+    ull n_tb_hits = 0;                 // successful Syzygy probes (see endgameTables.hpp)
+    static constexpr int TB_WIN_CP = 20000;   // tablebase win, less the plies to it. Far above any eval, not a mate.
     int iNodes_per_Second = 0;
 
     // Root aspiration-window controls and statistics. Scores are in pawns.
@@ -148,21 +170,17 @@ public:
 
     /////////////////////////////////////////////////////////////////////
     // Transposition table #2 (TT2)     Protects the node (recursive_negamax()). Cleared on every game start. 
-    enum class TTFlag : unsigned char {
-        EXACT,       // exact alpha–beta result
-        LOWER_BOUND, // fail-high node
-        UPPER_BOUND  // fail-low node
-    };
+    // Fixed size, cache-line bucketed. See transposition_table.hpp. Sized with the "Hash" UCI option.
+    using TTFlag = TranspositionTable::Flag;
 
-    struct TTEntry2 {
-        int              score_cp;   // search score in centipawns
-        int              depth;      // depth this node was searched to
-        ShumiChess::Move best_move;  // move that produced score_cp
-        TTFlag           flag;       // optional: EXACT / LOWER_BOUND / UPPER_BOUND
-        unsigned char    age;        // optional: for aging/replacement
+    TranspositionTable TTable2;
 
-  
-        #ifdef DEBUG_NODE_TT2
+    void set_hash_size_mb(std::size_t size_mb) { TTable2.resize(size_mb); }
+
+    #ifdef DEBUG_NODE_TT2
+        //
+        // The compact TT2 entries have no room for these, so they live in a side table, by zobrist key.
+        struct TTEntry2Debug {
 
             Score dAlphaDebug;
             Score dBetaDebug;
@@ -178,19 +196,33 @@ public:
             ull   bb_wp, bb_wn, bb_wb, bb_wr, bb_wq, bb_wk;
             ull   bb_bp, bb_bn, bb_bb, bb_br, bb_bq, bb_bk;
 
-            std::stack<ShumiChess::Move> move_history_debug; 
+            std::vector<ShumiChess::Move> move_history_debug; 
 
             bool white_castled_debug;
             bool black_castled_debug;
+        };
 
-        #endif
+        std::unordered_map<uint64_t, TTEntry2Debug> TTable2_debug;
+    #endif
 
-    };
+    /////////////////////////////////////////////////////////////////////
+    // Lazy SMP. When n_threads > 1, (n_threads-1) helpers search the same root as this (main) thread.
+    // Each helper owns a cloned Engine (board, ply move buffers) and its own killers, but they all
+    // probe and store into the main thread's TT2. Only the main thread's result is played.
+    static constexpr int MAX_SEARCH_THREADS = 64;
+    int n_threads = 1;                  // Total search threads, including the main one. ("Threads" UCI option)
+    ull smp_helper_nodes = 0;           // Nodes visited by all helpers during the last move
+    ull smp_helper_tb_hits = 0;         // Tablebase hits of all helpers during the last move
+
+    bool is_smp_helper() const { return (smp_main != nullptr); }
 
-    std::unordered_map<uint64_t, TTEntry2> TTable2;
-    ull max_TTable2_size = 0;
+    PawnHashTable pawn_hash;            // pawn/file info, by pawn_zobrist_key
+    ShumiChess::AttackInfo attack_info; // Attack maps of the position being evaluated (built by get_positional_for_one_color())
+    void set_pawn_hash_size_kb(std::size_t size_kb);     // This thread's and the helpers'. Not while searching.
 
-    std::unordered_map<uint64_t, ShumiChess::PawnFileInfo> pawn_file_info;
+    MaterialHashTable material_hash;    // phase, scale factors and endgame evaluator, by material_key
+    const ShumiChess::MaterialInfo& get_material_info_for_position();
+    void build_material_info(ShumiChess::MaterialInfo& mi);
 
 
     ull passed_white_pawns = 0ULL; // im a bitmap
@@ -200,19 +232,37 @@ public:
     ShumiChess::Move killer1[MAX_PLY]; 
     ShumiChess::Move killer2[MAX_PLY];
 
+    // History heuristic (_FEATURE_HISTORY). Butterfly table of quiet cutoffs, by [color][from][to].
+    // Countermoves: the quiet move that last refuted a move, by [its color][its piece][its to square].
+    static constexpr int HISTORY_MAX = 16384;
+    int history[2][64][64] = {};
+    ShumiChess::Move countermove[2][6][64];
+    void age_history();
+    void update_quiet_history(const ShumiChess::Move& cutoff_move, int depth, int nPlys,
+                              const ShumiChess::Move* quiets_tried, int n_quiets_tried);
+
+    // Move ordering quality: how often a beta cutoff came from the first move searched.
+    ull n_cutoff_nodes = 0;
+    ull n_first_move_cutoffs = 0;
+
 
     int TT_ntrys = 0;
     int TT_ntrys1 = 0;
 
     // Template variants (compile-time color)
     const ShumiChess::PawnFileInfo& get_pawn_file_info_for_position();
-    template<ShumiChess::Color c> int cp_score_positional_get_open_cp_t(int nPhase, const ShumiChess::PawnFileInfo*& pawnFileInfoP);
-    template<ShumiChess::Color c> int cp_score_positional_get_middle_cp_t(int nPhase);
-    template<ShumiChess::Color c> int cp_score_positional_get_end_t(int nPly, int cp_score_material_all, bool noMajorPiecesFriend, bool noMajorPiecesEnemy);
-    template<ShumiChess::Color for_color> int evaluate_board_t(ShumiChess::EvalPersons evp);
-    template<ShumiChess::Color c> int get_positional_for_one_color(int nPhase, ShumiChess::EvalPersons evp, int cp_score_material_all, const ShumiChess::PawnFileInfo*& pawnFileInfoP);
+    template<ShumiChess::Color c> int cp_score_positional_get_open_cp_t(int nPhase, const ShumiChess::PawnFileInfo*& pawnFileInfoP, const ShumiChess::AttackInfo& attackInfo);
+    template<ShumiChess::Color c> int cp_score_positional_get_middle_cp_t(int nPhase, const ShumiChess::AttackInfo& attackInfo);
+    template<ShumiChess::Color c> int cp_score_positional_get_end_t(int nPly, int cp_score_material_all, bool noMajorPiecesFriend, bool noMajorPiecesEnemy, const ShumiChess::AttackInfo& attackInfo);
+    // With a window, returns early (material and piece-square only) when the other positional terms cannot
+    // bring the score back inside (alpha_cp, beta_cp). Without one, always the full eval.
+    static constexpr int EVAL_NO_WINDOW_CP = std::numeric_limits<int>::max() / 2;
+    template<ShumiChess::Color for_color> int evaluate_board_t(ShumiChess::EvalPersons evp,
+                                                               int alpha_cp = -EVAL_NO_WINDOW_CP, int beta_cp = EVAL_NO_WINDOW_CP);
+    template<ShumiChess::Color c> int get_positional_for_one_color(int nPhase, ShumiChess::EvalPersons evp, int cp_score_material_all, const ShumiChess::PawnFileInfo*& pawnFileInfoP, const ShumiChess::AttackInfo*& attackInfoP);
     
     template<ShumiChess::Color c> int trade_imbalance_cp_t(int material_balance, int me_pawn_material) const;
+    template<ShumiChess::Color c> bool null_move_allowed_t(Score beta);
     
 
 
@@ -221,7 +271,11 @@ public:
     bool should_abort_search_by_time();
     bool should_abort_search_by_soft_time();
 
-    bool sort_moves_for_search(vector<ShumiChess::Move>* p_moves_to_loop_over, int depth, int nPlys, bool is_top_of_deepening);
+    bool sort_moves_for_search(ShumiChess::MoveList* p_moves_to_loop_over, int depth, int nPlys, bool is_top_of_deepening);
+    void order_unquiet_moves(ShumiChess::MoveList& moves, int i_begin, int i_end);
+    void order_quiet_moves(ShumiChess::MoveList& moves, int i_begin, int i_end,
+                           int nPlys, bool b_killers);
+    static void insertion_sort_by_score(ShumiChess::MoveList& moves, int i_begin, int i_end);
    
     
     typedef std::chrono::high_resolution_clock::time_point TIME_TYPE;
@@ -235,7 +289,8 @@ public:
     static bool should_stop_by_time(ull elapsed_time, double growth_factor
                                         , ull fallback_move_budget
                                         , const SearchTimeControl& time_control
-                                        , double& estimated_elapsed_time);
+                                        , double& estimated_elapsed_time        // output
+                                        , ull free_time_ms = 0);              // searched off our clock (pondering)
 
     tuple<Score, ShumiChess::Move> do_a_deepening(int depth, ull elapsed_time_display_only
                                                 , ull& last_elapsed_time_display_only
@@ -289,6 +344,7 @@ public:
                                             , bool is_from_root
                                             , int nPlys
                                             , int qPlys
+                                            , bool is_pv_node       // on the first-move line from the root
                                         );
     std::tuple<Score, ShumiChess::Move> recursive_negamaxQ( 
                                             //int depth,
@@ -302,9 +358,9 @@ public:
     bool loop_over_all_moves(int depth, Score &alpha, 
                        const Score beta, 
                        int nPlys, int qPlys,
-                       bool in_check, Score d_stand_pat, 
+                       bool in_check, bool is_pv_node, Score d_stand_pat, 
                        //const ShumiChess::Move& move_last,       // NOTE: remove me
-                       const vector<ShumiChess::Move>* pMoves, 
+                       MovePicker& picker, 
                        ShumiChess::Move &bestMoveOut, Score &bestScoreOut,
                        bool& did_cutoff);     // outputs
 
@@ -316,6 +372,21 @@ public:
 
     int phase_of_game(int material_cp);
     int phase_of_game_full();
+    static int material_phase(int material_cp_avg, bool no_queens);     // the part of the phase from material only
+    int castled_phase(int nPhase);                                      // the rest (sets bWhiteCstled/bBlackCstled)
+
+    // Lazy eval margins, by phase: the most the positional terms after material and piece-square can add up to,
+    // times LAZY_EVAL_MARGIN_PCT.
+    //
+    // The terms never all max out together, and the two sides' terms mostly cancel, so the full sum is far 
+    // too wide (0.4% of qsearch evals exit, against 23.5% at half, same nodes and moves on the five bench 
+    // positions). Half still covers the largest positional score seen in random playouts, by over 10% in every 
+    // phase. Test LazyEval.NeverOnTheWrongSideInPlayouts checks it against the full eval.
+    static constexpr int LAZY_EVAL_MARGIN_PCT = 50;
+    int lazy_eval_margin_cp[ShumiChess::GamePhase::ENDGAME_LATE + 1] = {};
+    void init_lazy_eval_margins();
+
+    ull n_exact_endgame_hits = 0;       // interior nodes ended by an exact endgame evaluator (KPK bitbase, endgame.hpp)
 
     bool no_queens_on_board();
 
@@ -323,8 +394,10 @@ public:
     Score d_best_move_score_rel = ZERO_SCORE;
     int max_attained_depth = 0;
     int max_attained_qdepth = 0;
+    double effective_branching_factor = 0.0;      // nodes(depth) / nodes(depth-1), last two completed deepenings
 
     std::vector<std::pair<ShumiChess::Move, Score>> excluded_root_moves;          // for "MultiPV"
+    void tb_filter_root_moves();                  // Syzygy DTZ ranking of the root moves (see endgameTables.hpp)
 
     //bool is_debug = false;
     int nFarts = 0;
@@ -332,11 +405,30 @@ public:
     int n_futility_tosses = 0;
     int n_delta_tosses = 0;
 
+    // Null move pruning (_FEATURE_NULL_MOVE)
+    ull n_null_move_tries = 0;
+    ull n_null_move_cutoffs = 0;
+    bool null_move_at_ply[MAX_PLY0] = {};     // true while the side to move at this ply has passed
+
+    // Late move reductions (_FEATURE_LMR)
+    static constexpr int LMR_MIN_DEPTH = 3;           // regular search depth
+    static constexpr int LMR_FULL_DEPTH_MOVES = 3;    // the first moves are never reduced
+    ull n_lmr_reduced = 0;
+    ull n_lmr_researches = 0;
+
+    // Staged move generation (_FEATURE_STAGED_MOVEGEN). Nodes, and how many of them had to generate.
+    ull n_staged_nodes = 0;
+    ull n_staged_unquiet_gens = 0;
+    ull n_staged_quiet_gens = 0;
+
+    // TT2 hash cutoffs, taken before the moves were generated
+    ull n_movegens_avoided = 0;
+
     template<class T> string format_with_commas(T value);
     void playgroundOld(int iPhase);
     void playground(int iPhase);
 
-    void print_moves_to_file(const vector<ShumiChess::Move> &mvs, int depth, char* szHeader, char* szTrailer);
+    void print_moves_to_file(const ShumiChess::MoveList &mvs, int depth, char* szHeader, char* szTrailer);
 
 
     // Salt the entry. Specific to evalute_board() TT leaf protection 
@@ -355,6 +447,29 @@ private:
 
     int n_Multis = 1;           // MultiPV if greater than 1
 
+    // Lazy SMP state. A helper points at its main thread, which owns the shared TT2.
+    MinimaxAI* smp_main = nullptr;
+    #ifdef DEBUG_NODE_TT2
+        std::mutex TTable2_debug_mutex;     // Guards TTable2_debug, only while helpers are running
+    #endif
+    bool smp_active = false;            // Helpers are running (main thread only)
+    std::atomic<bool> smp_stop{false};  // Main tells its helpers to quit
+    std::vector<std::unique_ptr<ShumiChess::Engine>> smp_engines;
+    std::vector<std::unique_ptr<MinimaxAI>> smp_helpers;
+    std::vector<std::thread> smp_threads;
+
+    TranspositionTable& shared_TTable2() { return smp_main ? smp_main->TTable2 : TTable2; }
+    #ifdef DEBUG_NODE_TT2
+        std::unordered_map<uint64_t, TTEntry2Debug>& shared_TTable2_debug() { return smp_main ? smp_main->TTable2_debug : TTable2_debug; }
+        std::mutex& shared_TTable2_debug_mutex() { return smp_main ? smp_main->TTable2_debug_mutex : TTable2_debug_mutex; }
+        bool shared_TTable2_needs_lock() const { return smp_main ? true : smp_active; }
+    #endif
+    ShumiChess::Move resolve_TT2_move(std::uint16_t move16);      // checks it with is_legal_move_fast()
+
+    void smp_start_helpers();
+    void smp_stop_helpers();
+    void smp_helper_search(int helper_id);
+
 
     bool aborts_allowed = false;        // Aborts cant happen until at least one deepening has finished, and
                                         // given us a fallback move to use.
@@ -366,6 +481,15 @@ private:
     void hard_abort_start(ull hard_duration);
     void hard_abort_end();
 
+    std::atomic<ull> ponder_hit_time_ms{0};     // Steady clock. Zero until the ponder hit.
+    ull search_start_time_ms = 0;
+    ull search_end_time_ms = 0;                 // Zero while searching
+    bool ponder_clock_pending = false;          // A ponder search, not yet on the clock
+    ull ponder_hard_abort_ms = 0;               // The hard abort held back until the ponder hit
+
+    ull time_before_ponder_hit_ms() const;
+    void start_clock_after_ponder_hit();
+
     bool soft_abort_enabled = false;
     ull soft_abort_budget_ms = 0;       // Relative duration in milliseconds
     ull soft_abort_start_time_ms = 0;   // Absolute steady-clock time in milliseconds
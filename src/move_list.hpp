@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "globals.hpp"
+
+inline constexpr int MAX_MOVES = 256;        // More than any legal (or pseudo legal) position has
+
+namespace ShumiChess {
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// A list of moves with inline (fixed) storage, for the move generators and the search.
+//
+// No allocation and no capacity checks (only asserts), so push_back() is a store and an increment.
+// Each move has an int score next to it, in a parallel array, for the move ordering. insert() and erase()
+// move the scores with the moves, the <algorithm> functions (on the iterators) move only the moves.
+// A score is garbage until something sets it.
+//
+// Iterators are plain pointers, so the <algorithm> functions work on it as on a vector.
+// to_vector() is the adapter for code that wants a std::vector<Move> (the Python module, tests).
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class MoveList {
+public:
+
+    using iterator       = Move*;
+    using const_iterator = const Move*;
+
+    MoveList() = default;
+
+    void clear() { n_moves = 0; }
+    std::size_t size() const { return static_cast<std::size_t>(n_moves); }
+    bool empty() const { return (n_moves == 0); }
+    static constexpr std::size_t capacity() { return MAX_MOVES; }
+
+    void push_back(const Move& m) {
+        assert(n_moves < MAX_MOVES);
+        moves[n_moves++] = m;
+    }
+    template<class... Args> void emplace_back(Args&&... args) {
+        assert(n_moves < MAX_MOVES);
+        moves[n_moves++] = Move(std::forward<Args>(args)...);
+    }
+
+    // Insert before pos. The moves after it shift down one place (with their scores).
+    iterator insert(iterator pos, const Move& m, int score = 0) {
+        assert(n_moves < MAX_MOVES);
+        const int i = static_cast<int>(pos - moves);
+        assert((i >= 0) && (i <= n_moves));
+        for (int j = n_moves; j > i; j--) {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        moves[i] = m;
+        scores[i] = score;
+        n_moves++;
+        return moves + i;
+    }
+
+    iterator erase(iterator pos) {
+        const int i = static_cast<int>(pos - moves);
+        assert((i >= 0) && (i < n_moves));
+        for (int j = i; j < (n_moves - 1); j++) {
+            moves[j] = moves[j + 1];
+            scores[j] = scores[j + 1];
+        }
+        n_moves--;
+        return moves + i;
+    }
+
+    Move& operator[](std::size_t i)             { assert(i < size()); return moves[i]; }
+    const Move& operator[](std::size_t i) const { assert(i < size()); return moves[i]; }
+    Move& front() { assert(!empty()); return moves[0]; }
+    Move& back()  { assert(!empty()); return moves[n_moves - 1]; }
+
+    iterator begin() { return moves; }
+    iterator end()   { return moves + n_moves; }
+    const_iterator begin() const { return moves; }
+    const_iterator end()   const { return moves + n_moves; }
+
+    // The score of the move at i (or at an iterator into this list).
+    int& score(std::size_t i) { assert(i < size()); return scores[i]; }
+    int& score_of(const_iterator it) { return score(static_cast<std::size_t>(it - moves)); }
+
+    std::vector<Move> to_vector() const { return std::vector<Move>(begin(), end()); }
+
+private:
+
+    Move moves[MAX_MOVES];
+    int scores[MAX_MOVES];
+    int n_moves = 0;
+};
+
+} // end namespace ShumiChess
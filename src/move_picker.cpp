@@ -0,0 +1,136 @@
+#include <cassert>
+
+#include "move_picker.hpp"
+#include "engine.hpp"
+#include "minimax.hpp"
+
+using ShumiChess::Move;
+using ShumiChess::Color;
+
+
+MovePicker::MovePicker(const ShumiChess::MoveList& sorted_moves)
+    : stage(Stage::LIST)
+    , p_list(&sorted_moves) {
+}
+
+
+MovePicker::MovePicker(MinimaxAI& ai, ShumiChess::Engine& engine, int nPlys_in, const Move& tt_move_in)
+    : stage(Stage::TT_MOVE)
+    , p_ai(&ai)
+    , p_engine(&engine)
+    , nPlys(nPlys_in)
+    , tt_move(tt_move_in) {
+
+    assert((nPlys >= 0) && (nPlys < MAX_PLY0));
+    p_unquiet = &engine.all_unquiet_moves[nPlys];
+    p_quiet = &engine.all_legal_moves[nPlys];
+}
+
+
+int MovePicker::n_known() const {
+    if (stage == Stage::LIST) return static_cast<int>(p_list->size());
+
+    int n = n_moves_picked;
+    if (stage == Stage::UNQUIET) n += static_cast<int>(p_unquiet->size() - i_next);
+    if (stage == Stage::QUIET)   n += static_cast<int>(p_quiet->size() - i_next);
+    return n;
+}
+
+
+bool MovePicker::was_picked_early(const Move& m) const {
+    if (b_tt_move_picked && (m == tt_move)) return true;
+    for (int i = 0; i < n_killers_picked; i++) {
+        if (m == killers_picked[i]) return true;
+    }
+    return false;
+}
+
+
+bool MovePicker::next(Move& m_out) {
+
+    switch (stage) {
+
+        case Stage::LIST:
+            if (i_next >= p_list->size()) return false;
+            m_out = (*p_list)[i_next++];
+            n_moves_picked++;
+            return true;
+
+        case Stage::TT_MOVE:
+            stage = Stage::UNQUIET_GEN;
+            if (!(tt_move == Move{}) && p_engine->is_legal_move_fast(tt_move)) {
+                b_tt_move_picked = true;
+                m_out = tt_move;
+                n_moves_picked++;
+                return true;
+            }
+            [[fallthrough]];
+
+        case Stage::UNQUIET_GEN:
+            if (p_engine->game_board.turn == Color::WHITE) p_engine->get_legal_moves_fast_t<Color::WHITE, true>(false, *p_unquiet);
+            else                                           p_engine->get_legal_moves_fast_t<Color::BLACK, true>(false, *p_unquiet);
+            b_generated_unquiet = true;
+            p_ai->order_unquiet_moves(*p_unquiet, 0, static_cast<int>(p_unquiet->size()));
+            i_next = 0;
+            stage = Stage::UNQUIET;
+            [[fallthrough]];
+
+        case Stage::UNQUIET:
+            while (i_next < p_unquiet->size()) {
+                const Move& m = (*p_unquiet)[i_next++];
+                if (was_picked_early(m)) continue;
+                m_out = m;
+                n_moves_picked++;
+                return true;
+            }
+            stage = Stage::KILLERS;
+            i_killer = 0;
+            [[fallthrough]];
+
+        case Stage::KILLERS:
+            // Same rule as sort_moves_for_search(): no killers when debugging the TT2.
+            #ifndef DEBUG_NODE_TT2
+            if (p_ai->Features_mask & _FEATURE_KILLER) {
+                while (i_killer < 2) {
+                    const Move killer = (i_killer == 0) ? p_ai->killer1[nPlys] : p_ai->killer2[nPlys];
+                    i_killer++;
+
+                    if (killer == Move{}) continue;
+                    if (b_tt_move_picked && (killer == tt_move)) continue;
+                    if (!p_engine->is_legal_move_fast(killer)) continue;
+
+                    killers_picked[n_killers_picked++] = killer;
+                    m_out = killer;
+                    n_moves_picked++;
+                    return true;
+                }
+            }
+            #endif
+            stage = Stage::QUIET_GEN;
+            [[fallthrough]];
+
+        case Stage::QUIET_GEN:
+            if (p_engine->game_board.turn == Color::WHITE) p_engine->get_legal_moves_fast_t<Color::WHITE, false, true>(false, *p_quiet);
+            else                                           p_engine->get_legal_moves_fast_t<Color::BLACK, false, true>(false, *p_quiet);
+            b_generated_quiet = true;
+            p_ai->order_quiet_moves(*p_quiet, 0, static_cast<int>(p_quiet->size()), nPlys, false);
+            i_next = 0;
+            stage = Stage::QUIET;
+            [[fallthrough]];
+
+        case Stage::QUIET:
+            while (i_next < p_quiet->size()) {
+                const Move& m = (*p_quiet)[i_next++];
+                if (was_picked_early(m)) continue;
+                m_out = m;
+                n_moves_picked++;
+                return true;
+            }
+            stage = Stage::DONE;
+            [[fallthrough]];
+
+        case Stage::DONE:
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+
+#include "globals.hpp"
+#include "move_list.hpp"
+
+namespace ShumiChess { class Engine; }
+class MinimaxAI;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Hands out the moves of one node, one at a time, to loop_over_all_moves().
+//
+// List mode: walks a move list that is already generated and sorted (root, qsearch, default search).
+//
+// Staged mode (_FEATURE_STAGED_MOVEGEN): generates as late as possible, so when an early move cuts off,
+// the rest of the moves are never generated.
+//      1. TT move          checked with Engine::is_legal_move_fast(), nothing generated
+//      2. Unquiet moves    captures and promotions generated, ordered by order_unquiet_moves()
+//      3. Killer moves     checked with Engine::is_legal_move_fast(), nothing generated
+//      4. Quiet moves      generated, ordered by order_quiet_moves()
+// A move handed out in an earlier stage is skipped in the later ones.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class MovePicker {
+public:
+
+    explicit MovePicker(const ShumiChess::MoveList& sorted_moves);
+
+    // tt_move can be empty. Uses engine.all_unquiet_moves[nPlys] and engine.all_legal_moves[nPlys].
+    MovePicker(MinimaxAI& ai, ShumiChess::Engine& engine, int nPlys, const ShumiChess::Move& tt_move);
+
+    bool next(ShumiChess::Move& m_out);     // false when there are no more moves
+
+    int n_picked() const { return n_moves_picked; }
+    int n_known() const;                    // moves handed out, or waiting in a generated list
+    bool is_staged() const { return (stage != Stage::LIST); }
+    bool did_generate_unquiet() const { return b_generated_unquiet; }
+    bool did_generate_quiet() const { return b_generated_quiet; }
+
+private:
+
+    enum class Stage { LIST, TT_MOVE, UNQUIET_GEN, UNQUIET, KILLERS, QUIET_GEN, QUIET, DONE };
+
+    bool was_picked_early(const ShumiChess::Move& m) const;     // the TT move or a killer
+
+    Stage stage;
+
+    const ShumiChess::MoveList* p_list = nullptr;              // list mode
+    std::size_t i_next = 0;
+
+    MinimaxAI* p_ai = nullptr;                                  // staged mode
+    ShumiChess::Engine* p_engine = nullptr;
+    int nPlys = 0;
+    ShumiChess::MoveList* p_unquiet = nullptr;
+    ShumiChess::MoveList* p_quiet = nullptr;
+
+    ShumiChess::Move tt_move;
+    bool b_tt_move_picked = false;
+    ShumiChess::Move killers_picked[2];
+    int n_killers_picked = 0;
+    int i_killer = 0;
+
+    int n_moves_picked = 0;
+    bool b_generated_unquiet = false;
+    bool b_generated_quiet = false;
+};
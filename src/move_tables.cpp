@@ -1,47 +1,59 @@
 #include "move_tables.hpp"
 
-namespace tables::movegen {
+#if SHUMI_PEXT_AVAILABLE
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
 
-std::array<StraightMagicEntry, 64> straight_magic_entries = {};
-std::array<ull, straight_magic_attack_table_size> straight_magic_attack_table = {};
-std::array<DiagonalMagicEntry, 64> diagonal_magic_entries = {};
-std::array<ull, diagonal_magic_attack_table_size> diagonal_magic_attack_table = {};
+namespace tables::movegen {
 
 namespace {
 
-std::array<bool, 64> straight_magic_initialized = {};
-std::array<bool, 64> diagonal_magic_initialized = {};
-
-ull straight_magic_random_state = 0x9E3779B97F4A7C15ULL;
-ull diagonal_magic_random_state = 0xD1B54A32D192ED03ULL;
-
-ull next_straight_magic_random() {
-    straight_magic_random_state ^= straight_magic_random_state >> 12;
-    straight_magic_random_state ^= straight_magic_random_state << 25;
-    straight_magic_random_state ^= straight_magic_random_state >> 27;
-    return straight_magic_random_state * 2685821657736338717ULL;
-}
-
-ull next_straight_magic_candidate() {
-    return next_straight_magic_random()
-        & next_straight_magic_random()
-        & next_straight_magic_random();
-}
-
-ull next_diagonal_magic_random() {
-    diagonal_magic_random_state ^= diagonal_magic_random_state >> 12;
-    diagonal_magic_random_state ^= diagonal_magic_random_state << 25;
-    diagonal_magic_random_state ^= diagonal_magic_random_state >> 27;
-    return diagonal_magic_random_state * 2685821657736338717ULL;
-}
+// Found once, by a search over xorshift64* candidates (AND of three draws) with the seeds
+// 0x9E3779B97F4A7C15 (straight) and 0xD1B54A32D192ED03 (diagonal). Each one maps every blocker
+// pattern of its square's mask to an index with no destructive collisions.
+constexpr std::array<ull, 64> straight_magics = {
+    0x1080004008801020ULL, 0x0840092002C03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000A001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021D00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000A0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000A00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040A00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xC100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000A0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040A00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04C1002414824001ULL, 0x020020000B001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084C0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
 
-ull next_diagonal_magic_candidate() {
-    return next_diagonal_magic_random()
-        & next_diagonal_magic_random()
-        & next_diagonal_magic_random();
-}
+constexpr std::array<ull, 64> diagonal_magics = {
+    0x2048017020910100ULL, 0x0044410424008008ULL, 0x040828A400900000ULL, 0x8002209200022000ULL,
+    0x0002021000540002ULL, 0x0021018840000000ULL, 0x00009E8420204002ULL, 0x00A0920110084480ULL,
+    0x4003062018010110ULL, 0x0221046812004E09ULL, 0x01E11002958912A0ULL, 0x0000044410804000ULL,
+    0x0000821210000080ULL, 0x080201102210A800ULL, 0x0080040411045004ULL, 0x00704A1842021000ULL,
+    0x1005061070322800ULL, 0x0018001010410444ULL, 0x0010000800401420ULL, 0x2204002844000800ULL,
+    0x2052020412022280ULL, 0x000A020101008208ULL, 0x0040400201042000ULL, 0x03E1082040480410ULL,
+    0x1004200004208414ULL, 0x08700400984808C8ULL, 0x0088080004004410ULL, 0x008C0240140100A2ULL,
+    0x0008840001822000ULL, 0x0050088001080100ULL, 0x98140840040A2200ULL, 0x3002020900210110ULL,
+    0x1004040640206000ULL, 0x1090909000840400ULL, 0x9002444810100020ULL, 0x4000020080080080ULL,
+    0x0028020400011010ULL, 0x0290808300020100ULL, 0x8010020882004410ULL, 0x0604010040082C20ULL,
+    0x20040104C0801008ULL, 0x6004208424001050ULL, 0x1002840041000800ULL, 0x0200042018000102ULL,
+    0xA8002000A0821C00ULL, 0x0040080802201910ULL, 0x0222620444000100ULL, 0x0002080041020088ULL,
+    0x1500820110401050ULL, 0x0000492090100080ULL, 0x0900410041100000ULL, 0x0302000420880000ULL,
+    0x0010501202020020ULL, 0x0008200490049040ULL, 0x0462080214A40120ULL, 0x2421310102008100ULL,
+    0x2400420080884060ULL, 0x0800804406184208ULL, 0x0B0080124A084400ULL, 0x082E082300840412ULL,
+    0x6051049040082200ULL, 0xC610211002102101ULL, 0x0000048808010433ULL, 0x0010200804405440ULL
+};
 
-int popcount64(ull value) {
+constexpr int popcount64(ull value) {
     int count = 0;
     while (value) {
         value &= value - 1;
@@ -50,7 +62,7 @@ int popcount64(ull value) {
     return count;
 }
 
-ull straight_relevant_occupancy_mask(int square) {
+constexpr ull straight_relevant_occupancy_mask(int square) {
     ull mask = 0ULL;
     const int square_x = square % 8;
     const int square_y = square / 8;
@@ -71,7 +83,7 @@ ull straight_relevant_occupancy_mask(int square) {
     return mask;
 }
 
-ull diagonal_relevant_occupancy_mask(int square) {
+constexpr ull diagonal_relevant_occupancy_mask(int square) {
     ull mask = 0ULL;
     const int square_x = square % 8;
     const int square_y = square / 8;
@@ -92,7 +104,7 @@ ull diagonal_relevant_occupancy_mask(int square) {
     return mask;
 }
 
-ull straight_attacks_on_the_fly(int square, ull blockers) {
+constexpr ull straight_attacks_on_the_fly(int square, ull blockers) {
     ull attacks = 0ULL;
     const int square_x = square % 8;
     const int square_y = square / 8;
@@ -129,7 +141,7 @@ ull straight_attacks_on_the_fly(int square, ull blockers) {
     return attacks;
 }
 
-ull diagonal_attacks_on_the_fly(int square, ull blockers) {
+constexpr ull diagonal_attacks_on_the_fly(int square, ull blockers) {
     ull attacks = 0ULL;
     const int square_x = square % 8;
     const int square_y = square / 8;
@@ -166,167 +178,137 @@ ull diagonal_attacks_on_the_fly(int square, ull blockers) {
     return attacks;
 }
 
-ull occupancy_from_index(int index, ull mask) {
-    ull occupancy = 0ULL;
-    int bit_index = 0;
-
-    while (mask) {
-        const ull bit = mask & (0ULL - mask);
-        mask &= mask - 1;
+//
+// The subsets of a mask, walked with the carry-rippler ((occupancy - mask) & mask), come out in
+// increasing order. That is the order of a PDEP of 0, 1, 2... into the mask, so the n'th subset is
+// the one PEXT maps back to n. Both tables below are filled in that order.
+//
 
-        if (index & (1 << bit_index)) {
-            occupancy |= bit;
-        }
-        ++bit_index;
+template <typename Entry>
+constexpr std::array<Entry, 64> init_magic_entries(ull (*relevant_mask)(int), const std::array<ull, 64>& magics) {
+    std::array<Entry, 64> entries = {};
+    std::size_t offset = 0;
+    for (int square = 0; square < 64; ++square) {
+        Entry& entry = entries[square];
+        entry.mask = relevant_mask(square);
+        entry.magic = magics[square];
+        entry.shift = 64 - popcount64(entry.mask);
+        entry.offset = offset;
+        offset += 1ULL << popcount64(entry.mask);
     }
-
-    return occupancy;
+    return entries;
 }
 
-void initialize_straight_magic_square(int square, std::size_t offset) {
-    StraightMagicEntry& entry = straight_magic_entries[square];
-    entry.mask = straight_relevant_occupancy_mask(square);
-    const int relevant_bits = popcount64(entry.mask);
-    const int occupancy_count = 1 << relevant_bits;
-    entry.shift = 64 - relevant_bits;
-    entry.offset = offset;
-
-    std::array<ull, 4096> occupancies = {};
-    std::array<ull, 4096> attacks = {};
-    for (int index = 0; index < occupancy_count; ++index) {
-        occupancies[index] = occupancy_from_index(index, entry.mask);
-        attacks[index] = straight_attacks_on_the_fly(square, occupancies[index]);
-    }
-
-    std::array<ull, 4096> used_attacks = {};
-    bool found_magic = false;
-    while (!found_magic) {
-        const ull magic = next_straight_magic_candidate();
-        if (popcount64((entry.mask * magic) & 0xFF00000000000000ULL) < 6) {
-            continue;
-        }
-
-        used_attacks.fill(0ULL);
-        found_magic = true;
-        for (int index = 0; index < occupancy_count; ++index) {
-            const std::size_t magic_index = (occupancies[index] * magic) >> entry.shift;
-            if (used_attacks[magic_index] == 0ULL) {
-                used_attacks[magic_index] = attacks[index];
-            } else if (used_attacks[magic_index] != attacks[index]) {
-                found_magic = false;
-                break;
-            }
-        }
-
-        if (found_magic) {
-            entry.magic = magic;
-        }
-    }
-
-    for (int index = 0; index < occupancy_count; ++index) {
-        const std::size_t magic_index = (occupancies[index] * entry.magic) >> entry.shift;
-        straight_magic_attack_table[entry.offset + magic_index] = attacks[index];
+template <typename Entry, std::size_t table_size>
+constexpr std::array<ull, table_size> init_pext_attack_table(const std::array<Entry, 64>& entries, ull (*attacks_on_the_fly)(int, ull)) {
+    std::array<ull, table_size> table = {};
+    for (int square = 0; square < 64; ++square) {
+        const Entry& entry = entries[square];
+        std::size_t index = 0;
+        ull occupancy = 0ULL;
+        do {
+            table[entry.offset + index] = attacks_on_the_fly(square, occupancy);
+            occupancy = (occupancy - entry.mask) & entry.mask;
+            ++index;
+        } while (occupancy);
     }
+    return table;
 }
 
-void initialize_diagonal_magic_square(int square, std::size_t offset) {
-    DiagonalMagicEntry& entry = diagonal_magic_entries[square];
-    entry.mask = diagonal_relevant_occupancy_mask(square);
-    const int relevant_bits = popcount64(entry.mask);
-    const int occupancy_count = 1 << relevant_bits;
-    entry.shift = 64 - relevant_bits;
-    entry.offset = offset;
-
-    std::array<ull, 512> occupancies = {};
-    std::array<ull, 512> attacks = {};
-    for (int index = 0; index < occupancy_count; ++index) {
-        occupancies[index] = occupancy_from_index(index, entry.mask);
-        attacks[index] = diagonal_attacks_on_the_fly(square, occupancies[index]);
-    }
-
-    std::array<ull, 512> used_attacks = {};
-    bool found_magic = false;
-    while (!found_magic) {
-        const ull magic = next_diagonal_magic_candidate();
-        if (popcount64((entry.mask * magic) & 0xFF00000000000000ULL) < 6) {
-            continue;
-        }
-
-        used_attacks.fill(0ULL);
-        found_magic = true;
-        for (int index = 0; index < occupancy_count; ++index) {
-            const std::size_t magic_index = (occupancies[index] * magic) >> entry.shift;
-            if (used_attacks[magic_index] == 0ULL) {
-                used_attacks[magic_index] = attacks[index];
-            } else if (used_attacks[magic_index] != attacks[index]) {
-                found_magic = false;
-                break;
-            }
-        }
-
-        if (found_magic) {
-            entry.magic = magic;
-        }
-    }
-
-    for (int index = 0; index < occupancy_count; ++index) {
-        const std::size_t magic_index = (occupancies[index] * entry.magic) >> entry.shift;
-        diagonal_magic_attack_table[entry.offset + magic_index] = attacks[index];
+// Same attack sets as the PEXT table, moved to where the magic multiply sends each subset.
+template <typename Entry, std::size_t table_size>
+constexpr std::array<ull, table_size> init_magic_attack_table(const std::array<Entry, 64>& entries, const std::array<ull, table_size>& pext_table) {
+    std::array<ull, table_size> table = {};
+    for (int square = 0; square < 64; ++square) {
+        const Entry& entry = entries[square];
+        std::size_t index = 0;
+        ull occupancy = 0ULL;
+        do {
+            const std::size_t magic_index = (occupancy * entry.magic) >> entry.shift;
+            table[entry.offset + magic_index] = pext_table[entry.offset + index];
+            occupancy = (occupancy - entry.mask) & entry.mask;
+            ++index;
+        } while (occupancy);
     }
+    return table;
 }
 
-struct StraightMagicInitializer {
-    StraightMagicInitializer() {
-        initialize_straight_magic_tables();
-    }
-};
-
-StraightMagicInitializer straight_magic_initializer;
-
-struct DiagonalMagicInitializer {
-    DiagonalMagicInitializer() {
-        initialize_diagonal_magic_tables();
+struct PextSelector {
+    PextSelector() {
+        set_use_pext(cpu_has_fast_pext());
     }
 };
 
-DiagonalMagicInitializer diagonal_magic_initializer;
+PextSelector pext_selector;
 
 } // namespace
 
-void initialize_straight_magic_tables() {
-    std::size_t offset = 0;
-    for (int square = 0; square < 64; ++square) {
-        if (!straight_magic_initialized[square]) {
-            initialize_straight_magic_square(square, offset);
-            straight_magic_initialized[square] = true;
-        }
-        offset += 1ULL << popcount64(straight_magic_entries[square].mask);
+constexpr std::array<StraightMagicEntry, 64> straight_magic_entries =
+    init_magic_entries<StraightMagicEntry>(straight_relevant_occupancy_mask, straight_magics);
+constexpr std::array<DiagonalMagicEntry, 64> diagonal_magic_entries =
+    init_magic_entries<DiagonalMagicEntry>(diagonal_relevant_occupancy_mask, diagonal_magics);
+
+// The last square's section ends the shared table
+static_assert(straight_magic_entries[63].offset + (1ULL << (64 - straight_magic_entries[63].shift)) == straight_magic_attack_table_size);
+static_assert(diagonal_magic_entries[63].offset + (1ULL << (64 - diagonal_magic_entries[63].shift)) == diagonal_magic_attack_table_size);
+
+constexpr std::array<ull, straight_magic_attack_table_size> straight_pext_attack_table =
+    init_pext_attack_table<StraightMagicEntry, straight_magic_attack_table_size>(straight_magic_entries, straight_attacks_on_the_fly);
+constexpr std::array<ull, diagonal_magic_attack_table_size> diagonal_pext_attack_table =
+    init_pext_attack_table<DiagonalMagicEntry, diagonal_magic_attack_table_size>(diagonal_magic_entries, diagonal_attacks_on_the_fly);
+
+constexpr std::array<ull, straight_magic_attack_table_size> straight_magic_attack_table =
+    init_magic_attack_table(straight_magic_entries, straight_pext_attack_table);
+constexpr std::array<ull, diagonal_magic_attack_table_size> diagonal_magic_attack_table =
+    init_magic_attack_table(diagonal_magic_entries, diagonal_pext_attack_table);
+
+bool use_pext = false;
+
+
+bool cpu_has_fast_pext() {
+#if SHUMI_PEXT_AVAILABLE
+    unsigned int regs[4] = {};      // eax, ebx, ecx, edx
+
+    auto cpuid = [&regs](unsigned int leaf) {
+        #if defined(_MSC_VER)
+            int r[4];
+            __cpuidex(r, (int)leaf, 0);
+            for (int i = 0; i < 4; i++) regs[i] = (unsigned int)r[i];
+        #else
+            __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+        #endif
+    };
+
+    cpuid(0);
+    const unsigned int max_leaf = regs[0];
+    const bool is_amd = (regs[1] == 0x68747541) && (regs[3] == 0x69746E65) && (regs[2] == 0x444D4163);    // "AuthenticAMD"
+    if (max_leaf < 7) return false;
+
+    cpuid(7);
+    const bool has_bmi2 = (regs[1] >> 8) & 1;
+    if (!has_bmi2) return false;
+
+    if (is_amd) {
+        cpuid(1);
+        unsigned int family = (regs[0] >> 8) & 0xF;
+        if (family == 0xF) family += (regs[0] >> 20) & 0xFF;
+        if (family < 0x19) return false;        // Zen 1 and 2 (family 0x17) run PEXT in microcode
     }
-
-    assert(offset == straight_magic_attack_table_size);
+    return true;
+#else
+    return false;
+#endif
 }
 
-void initialize_diagonal_magic_tables() {
-    std::size_t offset = 0;
-    for (int square = 0; square < 64; ++square) {
-        if (!diagonal_magic_initialized[square]) {
-            initialize_diagonal_magic_square(square, offset);
-            diagonal_magic_initialized[square] = true;
-        }
-        offset += 1ULL << popcount64(diagonal_magic_entries[square].mask);
-    }
-
-    assert(offset == diagonal_magic_attack_table_size);
+bool set_use_pext(bool b_pext) {
+    use_pext = b_pext && cpu_has_fast_pext();
+    return use_pext;
 }
 
 ull get_straight_magic_attack(ull all_pieces_but_self, int square) {
     assert(square >= 0);
     assert(square < 64);
 
-    if (!straight_magic_initialized[square]) {
-        initialize_straight_magic_tables();
-    }
-
     const StraightMagicEntry& entry = straight_magic_entries[square];
     const ull blockers = all_pieces_but_self & entry.mask;
     const std::size_t magic_index = (blockers * entry.magic) >> entry.shift;
@@ -337,10 +319,6 @@ ull get_diagonal_magic_attack(ull all_pieces_but_self, int square) {
     assert(square >= 0);
     assert(square < 64);
 
-    if (!diagonal_magic_initialized[square]) {
-        initialize_diagonal_magic_tables();
-    }
-
     const DiagonalMagicEntry& entry = diagonal_magic_entries[square];
     const ull blockers = all_pieces_but_self & entry.mask;
     const std::size_t magic_index = (blockers * entry.magic) >> entry.shift;
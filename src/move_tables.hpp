@@ -9,8 +9,6 @@
 
 namespace tables::movegen
 {
-    void initialize_straight_magic_tables();
-    void initialize_diagonal_magic_tables();
     ull get_straight_magic_attack(ull all_pieces_but_self, int square);
     ull get_diagonal_magic_attack(ull all_pieces_but_self, int square);
     
@@ -128,6 +126,54 @@ namespace tables::movegen
     }
 
 
+    //
+    // For two squares on one rank, file or diagonal:
+    //    between_bb[a][b]  the squares strictly between them
+    //    line_bb[a][b]     the whole line through both, edge to edge, a and b included
+    // Both are 0 if the squares are not aligned (and for a == b).
+    //
+    using SquarePairTable = std::array<std::array<ull, 64>, 64>;
+
+    // Direction rays in opposite pairs: ray i and ray i^1 point opposite ways.
+    constexpr std::array<const std::array<ull, 65>*, 8> paired_square_rays = {
+        &ShumiChess::north_square_ray,      &ShumiChess::south_square_ray,
+        &ShumiChess::east_square_ray,       &ShumiChess::west_square_ray,
+        &ShumiChess::north_east_square_ray, &ShumiChess::south_west_square_ray,
+        &ShumiChess::north_west_square_ray, &ShumiChess::south_east_square_ray,
+    };
+
+    constexpr SquarePairTable init_between_table() {
+        SquarePairTable between = {};
+
+        for (int a = 0; a < 64; ++a) {
+            for (int b = 0; b < 64; ++b) {
+                const ull b_bb = 1ULL << b;
+                for (const std::array<ull, 65>* ray : paired_square_rays) {
+                    if ((*ray)[a] & b_bb) {
+                        between[a][b] = (*ray)[a] & ~((*ray)[b] | b_bb);
+                    }
+                }
+            }
+        }
+        return between;
+    }
+
+    constexpr SquarePairTable init_line_table() {
+        SquarePairTable line = {};
+
+        for (int a = 0; a < 64; ++a) {
+            for (int b = 0; b < 64; ++b) {
+                const ull b_bb = 1ULL << b;
+                for (int i = 0; i < 8; ++i) {
+                    if ((*paired_square_rays[i])[a] & b_bb) {
+                        line[a][b] = (*paired_square_rays[i])[a] | (*paired_square_rays[i ^ 1])[a] | (1ULL << a);
+                    }
+                }
+            }
+        }
+        return line;
+    }
+
     inline constexpr std::array<ull,64> king_attack_table   = init_king_attack_table();
     inline constexpr std::array<ull,64> knight_attack_table = init_knight_attack_table();
     inline constexpr std::array<ull,64> white_pawn_attack_table = init_white_pawn_capture_table();
@@ -137,6 +183,14 @@ namespace tables::movegen
     inline constexpr std::array<ull,64> white_pawn_double_adv_table = init_white_pawn_double_advance_table();
     inline constexpr std::array<ull,64> black_pawn_double_adv_table = init_black_pawn_double_advance_table();
 
+    inline constexpr SquarePairTable between_bb = init_between_table();
+    inline constexpr SquarePairTable line_bb = init_line_table();
+
+    // True if the three squares are on one rank, file or diagonal
+    inline bool aligned(int a, int b, int c) {
+        return (line_bb[a][b] >> c) & 1ULL;
+    }
+
 
 
 
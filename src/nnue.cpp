@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "nnue.hpp"
+#include "utility.hpp"
+
+// The SIMD kernels are x86-64 only. They are built with target attributes (no -mavx2 needed), and only run if
+// the CPU has them.
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SHUMI_NNUE_SIMD 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+    #if defined(__GNUC__) || defined(__clang__)
+        #define SHUMI_TARGET_AVX2  __attribute__((target("avx2")))
+        #define SHUMI_TARGET_SSE41 __attribute__((target("sse4.1")))
+    #else
+        #define SHUMI_TARGET_AVX2
+        #define SHUMI_TARGET_SSE41
+    #endif
+#else
+    #define SHUMI_NNUE_SIMD 0
+#endif
+
+namespace ShumiChess::nnue {
+
+namespace {
+
+// As in the file. The affine layers are row major: weights[output][input].
+struct Network {
+    std::vector<int16_t> ft_biases;         // HALF_DIMS
+    std::vector<int16_t> ft_weights;        // N_FEATURES x HALF_DIMS
+    int32_t l1_biases[32];
+    int8_t  l1_weights[32 * L1_INPUTS];
+    int32_t l2_biases[32];
+    int8_t  l2_weights[32 * L2_INPUTS];
+    int32_t l3_bias;
+    int8_t  l3_weights[L3_INPUTS];
+};
+
+std::unique_ptr<Network> net;
+
+SimdLevel level = SCALAR;
+
+constexpr int WEIGHT_SHIFT = 6;         // Hidden layer outputs are scaled down by 64 before the clip
+constexpr int OUTPUT_SCALE = 16;        // Output layer units per Stockfish internal unit
+constexpr int SF_PAWN_VALUE = 208;      // Stockfish 12 PawnValueEg, the network's idea of a pawn
+
+
+///////////////////////////////// Scalar kernels ///////////////////////////////////////////////////
+
+void update_scalar(const int16_t* in, int16_t* out, const int* added, int n_added, const int* removed, int n_removed) {
+    for (int i = 0; i < HALF_DIMS; i++) {
+        int16_t sum = in[i];
+        for (int a = 0; a < n_added; a++)   sum = (int16_t)(sum + net->ft_weights[added[a] * HALF_DIMS + i]);
+        for (int r = 0; r < n_removed; r++) sum = (int16_t)(sum - net->ft_weights[removed[r] * HALF_DIMS + i]);
+        out[i] = sum;
+    }
+}
+
+void clip_scalar(const int16_t* in, uint8_t* out) {
+    for (int i = 0; i < HALF_DIMS; i++) out[i] = (uint8_t)std::clamp<int>(in[i], 0, 127);
+}
+
+int32_t dot_scalar(const uint8_t* in, const int8_t* w, int n) {
+    int32_t sum = 0;
+    for (int i = 0; i < n; i++) sum += (int32_t)in[i] * w[i];
+    return sum;
+}
+
+void affine_scalar(const uint8_t* in, int n_in, const int32_t* biases, const int8_t* weights, int32_t* out) {
+    for (int o = 0; o < 32; o++) out[o] = biases[o] + dot_scalar(in, weights + o * n_in, n_in);
+}
+
+
+#if SHUMI_NNUE_SIMD
+///////////////////////////////// AVX2 kernels /////////////////////////////////////////////////////
+
+SHUMI_TARGET_AVX2 void update_avx2(const int16_t* in, int16_t* out, const int* added, int n_added, const int* removed, int n_removed) {
+    const int16_t* w = net->ft_weights.data();
+    for (int c = 0; c < HALF_DIMS; c += 16) {
+        __m256i sum = _mm256_loadu_si256((const __m256i*)(in + c));
+        for (int a = 0; a < n_added; a++) {
+            sum = _mm256_add_epi16(sum, _mm256_loadu_si256((const __m256i*)(w + added[a] * HALF_DIMS + c)));
+        }
+        for (int r = 0; r < n_removed; r++) {
+            sum = _mm256_sub_epi16(sum, _mm256_loadu_si256((const __m256i*)(w + removed[r] * HALF_DIMS + c)));
+        }
+        _mm256_storeu_si256((__m256i*)(out + c), sum);
+    }
+}
+
+SHUMI_TARGET_AVX2 void clip_avx2(const int16_t* in, uint8_t* out) {
+    const __m256i zero = _mm256_setzero_si256();
+    for (int c = 0; c < HALF_DIMS; c += 32) {
+        const __m256i a = _mm256_loadu_si256((const __m256i*)(in + c));
+        const __m256i b = _mm256_loadu_si256((const __m256i*)(in + c + 16));
+        // packs works per 128 bit lane. The permute puts the four 64 bit quarters back in order.
+        const __m256i packed = _mm256_max_epi8(_mm256_packs_epi16(a, b), zero);
+        _mm256_storeu_si256((__m256i*)(out + c), _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+}
+
+// n is a multiple of 32. The inputs are at most 127, so maddubs never saturates.
+SHUMI_TARGET_AVX2 int32_t dot_avx2(const uint8_t* in, const int8_t* w, int n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < n; i += 32) {
+        __m256i product = _mm256_maddubs_epi16(_mm256_loadu_si256((const __m256i*)(in + i)),
+                                               _mm256_loadu_si256((const __m256i*)(w + i)));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(product, ones));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+    return _mm_cvtsi128_si32(s);
+}
+
+// 32 outputs, four rows at a time, so each input load is used four times. n_in is a multiple of 32.
+SHUMI_TARGET_AVX2 void affine_avx2(const uint8_t* in, int n_in, const int32_t* biases, const int8_t* weights, int32_t* out) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int o = 0; o < 32; o += 4) {
+        const int8_t* w = weights + o * n_in;
+        __m256i sum0 = _mm256_setzero_si256(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+        for (int i = 0; i < n_in; i += 32) {
+            const __m256i x = _mm256_loadu_si256((const __m256i*)(in + i));
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_maddubs_epi16(x, _mm256_loadu_si256((const __m256i*)(w + i))), ones));
+            sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_maddubs_epi16(x, _mm256_loadu_si256((const __m256i*)(w + n_in + i))), ones));
+            sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(_mm256_maddubs_epi16(x, _mm256_loadu_si256((const __m256i*)(w + 2 * n_in + i))), ones));
+            sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(_mm256_maddubs_epi16(x, _mm256_loadu_si256((const __m256i*)(w + 3 * n_in + i))), ones));
+        }
+        // Each hadd halves the lanes per row. What is left is each row's sum in two halves, one per 128 bit lane.
+        const __m256i s = _mm256_hadd_epi32(_mm256_hadd_epi32(sum0, sum1), _mm256_hadd_epi32(sum2, sum3));
+        const __m128i r = _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+        _mm_storeu_si128((__m128i*)(out + o), _mm_add_epi32(r, _mm_loadu_si128((const __m128i*)(biases + o))));
+    }
+}
+
+
+///////////////////////////////// SSE4.1 kernels ///////////////////////////////////////////////////
+
+SHUMI_TARGET_SSE41 void update_sse41(const int16_t* in, int16_t* out, const int* added, int n_added, const int* removed, int n_removed) {
+    const int16_t* w = net->ft_weights.data();
+    for (int c = 0; c < HALF_DIMS; c += 8) {
+        __m128i sum = _mm_loadu_si128((const __m128i*)(in + c));
+        for (int a = 0; a < n_added; a++) {
+            sum = _mm_add_epi16(sum, _mm_loadu_si128((const __m128i*)(w + added[a] * HALF_DIMS + c)));
+        }
+        for (int r = 0; r < n_removed; r++) {
+            sum = _mm_sub_epi16(sum, _mm_loadu_si128((const __m128i*)(w + removed[r] * HALF_DIMS + c)));
+        }
+        _mm_storeu_si128((__m128i*)(out + c), sum);
+    }
+}
+
+SHUMI_TARGET_SSE41 void clip_sse41(const int16_t* in, uint8_t* out) {
+    const __m128i zero = _mm_setzero_si128();
+    for (int c = 0; c < HALF_DIMS; c += 16) {
+        const __m128i a = _mm_loadu_si128((const __m128i*)(in + c));
+        const __m128i b = _mm_loadu_si128((const __m128i*)(in + c + 8));
+        _mm_storeu_si128((__m128i*)(out + c), _mm_max_epi8(_mm_packs_epi16(a, b), zero));
+    }
+}
+
+// n is a multiple of 16
+SHUMI_TARGET_SSE41 int32_t dot_sse41(const uint8_t* in, const int8_t* w, int n) {
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < n; i += 16) {
+        __m128i product = _mm_maddubs_epi16(_mm_loadu_si128((const __m128i*)(in + i)),
+                                            _mm_loadu_si128((const __m128i*)(w + i)));
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(product, ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+
+// As affine_avx2(), 16 inputs at a time
+SHUMI_TARGET_SSE41 void affine_sse41(const uint8_t* in, int n_in, const int32_t* biases, const int8_t* weights, int32_t* out) {
+    const __m128i ones = _mm_set1_epi16(1);
+    for (int o = 0; o < 32; o += 4) {
+        const int8_t* w = weights + o * n_in;
+        __m128i sum0 = _mm_setzero_si128(), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+        for (int i = 0; i < n_in; i += 16) {
+            const __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+            sum0 = _mm_add_epi32(sum0, _mm_madd_epi16(_mm_maddubs_epi16(x, _mm_loadu_si128((const __m128i*)(w + i))), ones));
+            sum1 = _mm_add_epi32(sum1, _mm_madd_epi16(_mm_maddubs_epi16(x, _mm_loadu_si128((const __m128i*)(w + n_in + i))), ones));
+            sum2 = _mm_add_epi32(sum2, _mm_madd_epi16(_mm_maddubs_epi16(x, _mm_loadu_si128((const __m128i*)(w + 2 * n_in + i))), ones));
+            sum3 = _mm_add_epi32(sum3, _mm_madd_epi16(_mm_maddubs_epi16(x, _mm_loadu_si128((const __m128i*)(w + 3 * n_in + i))), ones));
+        }
+        const __m128i r = _mm_hadd_epi32(_mm_hadd_epi32(sum0, sum1), _mm_hadd_epi32(sum2, sum3));
+        _mm_storeu_si128((__m128i*)(out + o), _mm_add_epi32(r, _mm_loadu_si128((const __m128i*)(biases + o))));
+    }
+}
+#endif
+
+
+void clip(const int16_t* in, uint8_t* out) {
+    #if SHUMI_NNUE_SIMD
+        if (level == AVX2)  { clip_avx2(in, out); return; }
+        if (level == SSE41) { clip_sse41(in, out); return; }
+    #endif
+    clip_scalar(in, out);
+}
+
+int32_t dot(const uint8_t* in, const int8_t* w, int n) {
+    #if SHUMI_NNUE_SIMD
+        if (level == AVX2)  return dot_avx2(in, w, n);
+        if (level == SSE41) return dot_sse41(in, w, n);
+    #endif
+    return dot_scalar(in, w, n);
+}
+
+// One hidden layer: out = clip((b + W.in) >> 6)
+void hidden_layer(const uint8_t* in, int n_in, const int32_t* biases, const int8_t* weights, uint8_t* out) {
+    int32_t sums[32];
+    #if SHUMI_NNUE_SIMD
+        if (level == AVX2)       affine_avx2(in, n_in, biases, weights, sums);
+        else if (level == SSE41) affine_sse41(in, n_in, biases, weights, sums);
+        else                     affine_scalar(in, n_in, biases, weights, sums);
+    #else
+        affine_scalar(in, n_in, biases, weights, sums);
+    #endif
+    for (int o = 0; o < 32; o++) out[o] = (uint8_t)std::clamp(sums[o] >> WEIGHT_SHIFT, 0, 127);
+}
+
+
+struct SimdSelector {
+    SimdSelector() {
+        set_simd_level(best_simd_level());
+    }
+};
+
+SimdSelector simd_selector;
+
+}   // namespace
+
+
+SimdLevel best_simd_level() {
+#if SHUMI_NNUE_SIMD
+    #if defined(_MSC_VER)
+        int r[4];
+        __cpuid(r, 1);
+        const bool has_sse41 = (r[2] >> 19) & 1;
+        const bool os_saves_ymm = ((r[2] >> 27) & 1) && ((r[2] >> 28) & 1) && ((_xgetbv(0) & 6) == 6);
+        __cpuidex(r, 7, 0);
+        const bool has_avx2 = os_saves_ymm && ((r[1] >> 5) & 1);
+    #else
+        const bool has_sse41 = __builtin_cpu_supports("sse4.1");
+        const bool has_avx2  = __builtin_cpu_supports("avx2");
+    #endif
+    if (has_avx2) return AVX2;
+    if (has_sse41) return SSE41;
+#endif
+    return SCALAR;
+}
+
+SimdLevel simd_level() {
+    return level;
+}
+
+SimdLevel set_simd_level(SimdLevel requested) {
+    level = std::min(requested, best_simd_level());
+    return level;
+}
+
+
+//
+// Reads a Stockfish 12 halfkp_256x2-32-32 network. The layer hashes are not checked: the exact file size is,
+// and no other architecture has this size. Values are little endian, as on every machine this runs on.
+bool load(const std::string& path) {
+
+    net.reset();
+
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (fp == NULL) return false;
+
+    auto read = [fp](void* p, std::size_t bytes) { return fread(p, 1, bytes, fp) == bytes; };
+
+    std::unique_ptr<Network> n(new Network);
+    n->ft_biases.resize(HALF_DIMS);
+    n->ft_weights.resize((std::size_t)N_FEATURES * HALF_DIMS);
+
+    uint32_t version = 0, hash = 0, desc_size = 0;
+    bool ok = read(&version, 4) && read(&hash, 4) && read(&desc_size, 4) && (version == FILE_VERSION);
+    if (ok) {
+        std::vector<char> desc(desc_size);
+        ok = read(desc.data(), desc_size)
+            && read(&hash, 4)
+            && read(n->ft_biases.data(), HALF_DIMS * sizeof(int16_t))
+            && read(n->ft_weights.data(), n->ft_weights.size() * sizeof(int16_t))
+            && read(&hash, 4)
+            && read(n->l1_biases, sizeof(n->l1_biases)) && read(n->l1_weights, sizeof(n->l1_weights))
+            && read(n->l2_biases, sizeof(n->l2_biases)) && read(n->l2_weights, sizeof(n->l2_weights))
+            && read(&n->l3_bias, sizeof(n->l3_bias))    && read(n->l3_weights, sizeof(n->l3_weights))
+            && (fgetc(fp) == EOF);
+    }
+    fclose(fp);
+
+    if (!ok) return false;
+    net = std::move(n);
+    return true;
+}
+
+bool is_loaded() {
+    return net != nullptr;
+}
+
+void unload() {
+    net.reset();
+}
+
+
+void update(const int16_t* in, int16_t* out, const int* added, int n_added, const int* removed, int n_removed) {
+    assert(net);
+    #if SHUMI_NNUE_SIMD
+        if (level == AVX2)  { update_avx2(in, out, added, n_added, removed, n_removed); return; }
+        if (level == SSE41) { update_sse41(in, out, added, n_added, removed, n_removed); return; }
+    #endif
+    update_scalar(in, out, added, n_added, removed, n_removed);
+}
+
+//
+// Builds one half of the accumulator from scratch: the biases plus every piece but the kings.
+void refresh(const GameBoard& board, Color perspective, int king_sq, int16_t* out) {
+
+    int active[MAX_ACTIVE_FEATURES + 2];
+    int n_active = 0;
+
+    for (const Color pc : {Color::WHITE, Color::BLACK}) {
+        for (const Piece p : {Piece::PAWN, Piece::ROOK, Piece::KNIGHT, Piece::BISHOP, Piece::QUEEN}) {
+            ull bb = board.get_pieces(pc, p);
+            while (bb) {
+                const int sq = utility::bit::lsb_and_pop_to_square(bb);
+                if (n_active < MAX_ACTIVE_FEATURES + 2) active[n_active++] = feature_index(perspective, p, pc, sq, king_sq);
+            }
+        }
+    }
+
+    update(net->ft_biases.data(), out, active, n_active, nullptr, 0);
+}
+
+int output(const Accumulator& acc, Color side_to_move) {
+    assert(net);
+
+    alignas(32) uint8_t l1_in[L1_INPUTS];
+    alignas(32) uint8_t l2_in[L2_INPUTS];
+    alignas(32) uint8_t l3_in[L3_INPUTS];
+
+    clip(acc.v[side_to_move], l1_in);
+    clip(acc.v[utility::representation::opposite_color(side_to_move)], l1_in + HALF_DIMS);
+
+    hidden_layer(l1_in, L1_INPUTS, net->l1_biases, net->l1_weights, l2_in);
+    hidden_layer(l2_in, L2_INPUTS, net->l2_biases, net->l2_weights, l3_in);
+
+    const int32_t out = net->l3_bias + dot(l3_in, net->l3_weights, L3_INPUTS);
+
+    return (out / OUTPUT_SCALE) * 100 / SF_PAWN_VALUE;
+}
+
+}
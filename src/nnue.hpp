@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "globals.hpp"
+#include "gameboard.hpp"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// NNUE evaluator (EvalPersons::NNUE). Optional: it is used only after load() has read a network file.
+//
+// The network file is the Stockfish 12 "halfkp_256x2-32-32" .nnue format:
+//      HalfKP features (41024 per side: own king square x piece x square) -> 256 int16 per side,
+//      both sides (side to move first) clipped to 0..127 -> 32 -> 32 -> 1 (int8 weights, int32 biases).
+//
+// The feature transformer output (the "accumulator") is kept per ply in Engine::nnue_stack, and
+// brought up to date from the moves on the undo stack (Engine::nnue_evaluate()). Only a move of the
+// perspective's own king needs a full refresh() from the board.
+//
+// The kernels are AVX2 or SSE4.1, picked at startup from CPUID, with a scalar fallback. All three give
+// exactly the same numbers. One network for the whole program. Search threads only read it.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace ShumiChess::nnue {
+
+constexpr int HALF_DIMS = 256;                  // Accumulator size, per side
+constexpr int N_FEATURES = 64 * 641;            // HalfKP: 64 king squares, 641 = 1 + 10 pieces x 64 squares
+constexpr int L1_INPUTS = 2 * HALF_DIMS;
+constexpr int L2_INPUTS = 32;
+constexpr int L3_INPUTS = 32;
+
+constexpr uint32_t FILE_VERSION = 0x7AF32F16;
+constexpr int MAX_ACTIVE_FEATURES = 30;         // 32 pieces, less the kings
+
+// Feature transformer output for one position. key[] is the zobrist key the side's half was computed
+// for (0 if not yet computed).
+struct Accumulator {
+    alignas(32) int16_t v[2][HALF_DIMS];
+    ull key[2] = {0, 0};
+};
+
+bool load(const std::string& path);     // false (and no network) if the file is missing or the wrong format
+bool is_loaded();
+void unload();
+
+enum SimdLevel { SCALAR = 0, SSE41, AVX2 };
+SimdLevel simd_level();
+SimdLevel best_simd_level();            // What this CPU can run
+SimdLevel set_simd_level(SimdLevel);    // Clamped to best_simd_level(). For tests and benchmarks.
+
+// HalfKP index of piece p (of color pc) on square sq, seen from perspective's side with its king on king_sq.
+// Kings are not features.
+inline int feature_index(Color perspective, Piece p, Color pc, int sq, int king_sq) {
+    static constexpr int piece_base[NUM_PIECES] = {1, 385, 129, 257, 513, 0, 0};  // PAWN ROOK KNIGHT BISHOP QUEEN
+    const int flip = (perspective == Color::WHITE) ? 7 : 56;                       // h1=0 to a1=0, and rotated for black
+    return (sq ^ flip) + piece_base[p] + ((pc != perspective) ? 64 : 0) + 641 * (king_sq ^ flip);
+}
+
+void refresh(const GameBoard& board, Color perspective, int king_sq, int16_t* out);
+
+// out = in + the added features - the removed ones (out may be in)
+void update(const int16_t* in, int16_t* out, const int* added, int n_added, const int* removed, int n_removed);
+
+// Centipawns, for the side to move, from an accumulator with both halves up to date.
+int output(const Accumulator& acc, Color side_to_move);
+
+}
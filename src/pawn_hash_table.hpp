@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+#include "gameboard.hpp"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Pawn/file hash. Caches the pawn summary (build_pawn_summaries()) of a pawn structure.
+//
+// Direct mapped: a power-of-two array of entries, indexed by the low bits of
+// GameBoard::pawn_zobrist_key. A new pawn structure always replaces the old one in its slot.
+// Each search thread owns its own table (entries are much too big to share without a lock).
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class PawnHashTable {
+public:
+
+    static constexpr std::size_t DEFAULT_SIZE_KB = 4096;
+    static constexpr std::size_t MAX_SIZE_KB = 1024 * 1024;
+
+    PawnHashTable() = default;          // Empty. Call resize() before use.
+    PawnHashTable(const PawnHashTable&) = delete;
+    PawnHashTable& operator=(const PawnHashTable&) = delete;
+
+    void resize(std::size_t size_kb);   // Rounds down to a power of two number of entries. Clears.
+    void clear();                       // New game
+
+    // Returns NULL on a miss.
+    const ShumiChess::PawnFileInfo* probe(std::uint64_t pawn_key) const {
+        const Entry& e = entries[pawn_key & index_mask];
+        return (e.used && e.key == pawn_key) ? &e.info : nullptr;
+    }
+
+    // Returns the stored copy.
+    const ShumiChess::PawnFileInfo& store(std::uint64_t pawn_key, const ShumiChess::PawnFileInfo& info) {
+        Entry& e = entries[pawn_key & index_mask];
+        e.key  = pawn_key;
+        e.used = true;
+        e.info = info;
+        return e.info;
+    }
+
+    // Start loading the slot early. Call it as soon as the pawn key is known.
+    void prefetch(std::uint64_t pawn_key) const {
+        #if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(&entries[pawn_key & index_mask]);
+        #endif
+    }
+
+    std::size_t size_kb() const { return size_in_kb; }
+    std::size_t capacity() const { return n_entries; }
+
+private:
+
+    struct Entry {
+        std::uint64_t key;
+        bool used;              // pawn_zobrist_key can be zero (no pawns), so zero is not "empty"
+        ShumiChess::PawnFileInfo info;
+    };
+
+    std::unique_ptr<Entry[]> entries;
+    std::size_t n_entries = 0;
+    std::uint64_t index_mask = 0;
+    std::size_t size_in_kb = 0;
+};
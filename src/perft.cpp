@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "engine.hpp"
+#include "perft.hpp"
+
+#ifdef SHUMI_FORCE_ASSERTS  // Operated by the -asserts" and "-no-asserts" args to run_gui.py. By default on.
+#undef NDEBUG
+#endif
+#include <assert.h>
+
+using namespace ShumiChess;
+
+
+//
+// Sizes the table to the largest power of two number of entries that fits in size_mb megabytes.
+void PerftHashTable::resize(std::size_t size_mb) {
+
+    size_mb = std::clamp<std::size_t>(size_mb, 1, MAX_SIZE_MB);
+
+    const std::size_t max_entries = (size_mb * 1024 * 1024) / sizeof(Slot);
+    std::size_t n_new = 1;
+    while ((n_new * 2) <= max_entries) n_new *= 2;
+
+    slots.reset();
+    slots.reset(new Slot[n_new]);
+    n_entries = n_new;
+    index_mask = n_entries - 1;
+    size_in_mb = size_mb;
+
+    clear();
+}
+
+void PerftHashTable::clear() {
+    for (std::size_t i = 0; i < n_entries; i++) {
+        slots[i].key.store(0ULL, std::memory_order_relaxed);
+        slots[i].data.store(0ULL, std::memory_order_relaxed);
+    }
+}
+
+
+namespace {
+
+template<Color c>
+std::uint64_t perft_t(Engine& engine, int depth, PerftHashTable* p_hash) {
+
+    constexpr Color enemy = utility::representation::opposite_color_t<c>;
+
+    if (depth == 0) return 1;
+
+    MoveList moves;
+    engine.get_legal_moves_fast_t<c, false>(false, moves);
+
+    // Bulk count the last ply
+    if (depth == 1) return moves.size();
+
+    const std::uint64_t key = engine.game_board.zobrist_key;
+    std::uint64_t nodes = 0;
+    if (p_hash && p_hash->probe(key, depth, nodes)) return nodes;
+
+    for (const Move& m : moves) {
+        engine.pushMove_t<c>(m);
+        nodes += perft_t<enemy>(engine, depth - 1, p_hash);
+        engine.popMove_t<c>();
+    }
+
+    if (p_hash) p_hash->store(key, depth, nodes);
+    return nodes;
+}
+
+std::uint64_t perft_after_move(Engine& engine, const Move& m, int depth, PerftHashTable* p_hash) {
+    std::uint64_t nodes;
+    if (m.color == Color::WHITE) {
+        engine.pushMove_t<Color::WHITE>(m);
+        nodes = perft_t<Color::BLACK>(engine, depth, p_hash);
+        engine.popMove_t<Color::WHITE>();
+    } else {
+        engine.pushMove_t<Color::BLACK>(m);
+        nodes = perft_t<Color::WHITE>(engine, depth, p_hash);
+        engine.popMove_t<Color::BLACK>();
+    }
+    return nodes;
+}
+
+} // end anonymous namespace
+
+
+namespace ShumiChess {
+
+std::uint64_t perft(Engine& engine, int depth, PerftHashTable* p_hash) {
+    assert(depth >= 0);
+    if (engine.game_board.turn == Color::WHITE) return perft_t<Color::WHITE>(engine, depth, p_hash);
+    else                                        return perft_t<Color::BLACK>(engine, depth, p_hash);
+}
+
+
+std::uint64_t perft_divide(Engine& engine, int depth, std::vector<PerftDivideEntry>& divide,
+                           int n_threads, PerftHashTable* p_hash) {
+
+    assert(depth >= 1);
+    divide.clear();
+
+    MoveList root_moves;
+    engine.get_legal_moves_fast(engine.game_board.turn, false, false, root_moves);
+    for (const Move& m : root_moves) divide.push_back({m, 0});
+
+    n_threads = std::clamp(n_threads, 1, std::max(1, (int)divide.size()));
+
+    if (n_threads == 1) {
+        for (PerftDivideEntry& e : divide) e.nodes = perft_after_move(engine, e.move, depth - 1, p_hash);
+    } else {
+        // Each thread takes the next root move not yet taken, on its own copy of the Engine.
+        std::atomic<int> i_next{0};
+        std::vector<std::unique_ptr<Engine>> engines;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < n_threads; t++) {
+            engines.emplace_back(std::make_unique<Engine>(engine));
+            engines.back()->reserve_storage_buffers();
+        }
+        for (int t = 0; t < n_threads; t++) {
+            threads.emplace_back([&, t]() {
+                for (int i = i_next++; i < (int)divide.size(); i = i_next++) {
+                    divide[i].nodes = perft_after_move(*engines[t], divide[i].move, depth - 1, p_hash);
+                }
+            });
+        }
+        for (std::thread& th : threads) th.join();
+    }
+
+    std::uint64_t total = 0;
+    for (const PerftDivideEntry& e : divide) total += e.nodes;
+    return total;
+}
+
+} // end namespace ShumiChess
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "globals.hpp"
+
+namespace ShumiChess { class Engine; }
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Perft. Counts the leaf nodes of the legal move tree to a fixed depth. Checks the move generator
+// (the counts of the standard positions are known), and measures its speed.
+//
+// Built on get_legal_moves_fast_t() and pushMove_t()/popMove_t(), as the search is. The last ply is
+// bulk counted (the size of the legal move list, no make/unmake).
+//
+// perft_divide() gives the count under each root move, and can split the root moves across threads
+// (each thread works on its own copy of the Engine).
+//
+// An optional PerftHashTable caches (position, depth) -> count, for deep counts.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+//
+// Direct mapped, lockless (the XOR trick, as in transposition_table.hpp), so the perft threads can share it.
+class PerftHashTable {
+public:
+
+    static constexpr std::size_t DEFAULT_SIZE_MB = 64;
+    static constexpr std::size_t MAX_SIZE_MB = 65536;
+
+    PerftHashTable() = default;         // Empty. Call resize() before use.
+    PerftHashTable(const PerftHashTable&) = delete;
+    PerftHashTable& operator=(const PerftHashTable&) = delete;
+
+    void resize(std::size_t size_mb);   // Rounds down to a power of two number of entries. Clears.
+    void clear();
+
+    bool probe(std::uint64_t key, int depth, std::uint64_t& nodes) const {
+        if (n_entries == 0) return false;
+        const Slot& slot = slots[key & index_mask];
+        const std::uint64_t d = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t k = slot.key.load(std::memory_order_relaxed);
+        if (((k ^ d) != key) || (d == 0ULL) || ((int)(d & 0xFF) != depth)) return false;
+        nodes = d >> 8;
+        return true;
+    }
+
+    void store(std::uint64_t key, int depth, std::uint64_t nodes) {
+        if (n_entries == 0) return;
+        Slot& slot = slots[key & index_mask];
+        const std::uint64_t d = (nodes << 8) | (std::uint64_t)(depth & 0xFF);
+        slot.key.store(key ^ d, std::memory_order_relaxed);
+        slot.data.store(d, std::memory_order_relaxed);
+    }
+
+    std::size_t size_mb() const { return size_in_mb; }
+
+private:
+
+    struct Slot {
+        std::atomic<std::uint64_t> key;     // zobrist key ^ data
+        std::atomic<std::uint64_t> data;    // nodes (56 bits) | depth (8 bits)
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t n_entries = 0;
+    std::uint64_t index_mask = 0;
+    std::size_t size_in_mb = 0;
+};
+
+
+namespace ShumiChess {
+
+struct PerftDivideEntry {
+    Move move;
+    std::uint64_t nodes;
+};
+
+// Leaf nodes at depth (depth 0 is 1). p_hash can be NULL.
+std::uint64_t perft(Engine& engine, int depth, PerftHashTable* p_hash = nullptr);
+
+// As perft(), but also fills in the count under each root move (in move generator order).
+// n_threads > 1 splits the root moves across threads. The engine is left as it was.
+std::uint64_t perft_divide(Engine& engine, int depth, std::vector<PerftDivideEntry>& divide,
+                           int n_threads = 1, PerftHashTable* p_hash = nullptr);
+
+} // end namespace ShumiChess
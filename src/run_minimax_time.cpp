@@ -102,13 +102,21 @@ int main(int argc, char** argv) {
     if (argc >= 4) {
         max_ply_to_play = atoi(argv[3]);
     }
+    int n_threads = 1;          // Lazy SMP search threads
+    if (argc >= 5) {
+        n_threads = std::max(1, atoi(argv[4]));
+    }
 
     int flags = _FEATURE_TT2 | _FEATURE_KILLER | _FEATURE_UNQUIET_SORT;
+    if (argc >= 6) {
+        flags = (int)strtol(argv[5], NULL, 0);    // Features mask, ie. "0x4e" (see features.hpp)
+    }
 
     sout << "uzing level= " << depth_to_use
          << "  msec = " << time_to_use
          << "  max ply = " << max_ply_to_play 
          << "  play id = " << player_id
+         << "  threads = " << n_threads
          << "  FEAT = 0x" << hex << flags << dec
          << endl;
 
@@ -118,6 +126,10 @@ int main(int argc, char** argv) {
 
     GameState state;
 
+    // Effective branching factor, averaged over all moves played (see MinimaxAI::effective_branching_factor)
+    double ebf_sum = 0.0;
+    int n_ebf = 0;
+
     for (int iPositions=0; iPositions<NPositions; iPositions++) {
 
         // Make engine
@@ -127,6 +139,7 @@ int main(int argc, char** argv) {
         //std::this_thread::sleep_for(std::chrono::seconds(3));   // debug only
 
         MinimaxAI minimax_ai(engine);
+        minimax_ai.n_threads = n_threads;
 
         // Show board
         string out = utility::representation::gameboard_to_string(engine.game_board);
@@ -149,6 +162,11 @@ int main(int argc, char** argv) {
                 break;
             }
 
+            if (minimax_ai.effective_branching_factor > 0.0) {
+                ebf_sum += minimax_ai.effective_branching_factor;
+                n_ebf++;
+            }
+
 
             make_engine_move(engine, move);
 
@@ -168,6 +186,12 @@ int main(int argc, char** argv) {
 
  
 
+    if (n_ebf > 0) {
+        char szEBF[64];
+        snprintf(szEBF, sizeof(szEBF), "Mean EBF: %.2f  (%d moves)", ebf_sum / n_ebf, n_ebf);
+        sout << szEBF << endl;
+    }
+
     sout << "Press any key to exit..." << endl;
     _getch();
 
@@ -208,7 +232,7 @@ static void make_engine_move(Engine& engine, Move move)
 
     engine.gamePGN.addMe(move, engine);
 
-    engine.move_history = stack<Move>();
+    engine.clear_move_history();
 
     if (move.piece_type == Piece::NONE) {
         sout << "\x1b[1;31mNo move to make\x1b[0m" << endl;
@@ -0,0 +1,54 @@
+#include <algorithm>
+
+#include "transposition_table.hpp"
+
+
+//
+// Sizes the table to the largest power of two number of buckets that fits in size_mb megabytes.
+void TranspositionTable::resize(std::size_t size_mb) {
+
+    size_mb = std::clamp<std::size_t>(size_mb, 1, MAX_SIZE_MB);
+
+    const std::size_t max_buckets = (size_mb * 1024 * 1024) / sizeof(Bucket);
+    std::size_t n_new = 1;
+    while ((n_new * 2) <= max_buckets) n_new *= 2;
+
+    // Release the old table first, so the peak memory is not both tables.
+    buckets.reset();
+    buckets.reset(new Bucket[n_new]);      // Bucket is alignas(64), C++17 new honors that
+    n_buckets = n_new;
+    bucket_mask = n_buckets - 1;
+    size_in_mb = size_mb;
+
+    clear();
+}
+
+
+void TranspositionTable::clear() {
+    for (std::size_t i = 0; i < n_buckets; i++) {
+        for (Slot& slot : buckets[i].slots) {
+            slot.key.store(0ULL, std::memory_order_relaxed);
+            slot.data.store(0ULL, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+
+//
+// Samples the first 1000 buckets (or fewer), counting entries written by the current search.
+int TranspositionTable::hashfull() const {
+
+    const std::size_t n_sample = std::min<std::size_t>(1000, n_buckets);
+    if (n_sample == 0) return 0;
+
+    std::size_t n_used = 0;
+    for (std::size_t i = 0; i < n_sample; i++) {
+        for (const Slot& slot : buckets[i].slots) {
+            const std::uint64_t d = slot.data.load(std::memory_order_relaxed);
+            if ((d != 0ULL) && (age_distance(d) == 0)) n_used++;
+        }
+    }
+
+    return (int)((n_used * 1000) / (n_sample * ENTRIES_PER_BUCKET));
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+
+#include "globals.hpp"
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Transposition table #2 (TT2). Protects the node (recursive_negamax()).
+//
+// A preallocated, power-of-two array of 64-byte (one cache line) buckets. Each bucket holds
+// ENTRIES_PER_BUCKET entries of two 64-bit words:
+//      key     the full zobrist key of the position, XORed with data
+//      data    score (32 bits) | move (16 bits) | depth (7 bits) | used (1 bit) | bound (2 bits) | age (6 bits)
+// The low bits of the zobrist key pick the bucket, so a probe touches exactly one cache line.
+//
+// Lockless (Hyatt's XOR trick). The search threads probe and store with no lock. Each word is a
+// relaxed 64-bit atomic, so a word is never torn, but two threads can interleave the two words of
+// one entry. Storing (key ^ data) in the key word catches that: a probe accepts an entry only if
+// key_word ^ data == key, which a mixed pair from two different writes fails.
+//
+// Replacement is depth- and age-preferred: an entry for the same position is replaced only by an
+// equal or deeper search (or when it is left over from an older search). Otherwise the entry with
+// the least (depth - age penalty) in the bucket is the victim.
+//
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TranspositionTable {
+public:
+
+    enum class Flag : std::uint8_t {
+        EXACT,       // exact alpha–beta result
+        LOWER_BOUND, // fail-high node
+        UPPER_BOUND  // fail-low node
+    };
+
+    // Unpacked entry, as returned by probe()
+    struct Entry {
+        int           score_cp;   // search score in centipawns (mate scores are "to TT" adjusted)
+        std::uint16_t move16;     // see pack_move()
+        int           depth;      // depth this node was searched to
+        Flag          flag;
+        std::uint8_t  age;
+    };
+
+    static constexpr int ENTRIES_PER_BUCKET = 4;
+    static constexpr std::size_t DEFAULT_SIZE_MB = 16;
+    static constexpr std::size_t MAX_SIZE_MB = 65536;
+
+    TranspositionTable() = default;     // Empty. Call resize() before use.
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    void resize(std::size_t size_mb);   // Rounds down to a power of two number of buckets. Clears.
+    void clear();                       // New game. Not while threads are searching.
+    void new_search() { generation = (generation + 1) & AGE_MASK; }      // Once per root search
+
+    // Thread safe, no locking.
+    bool probe(std::uint64_t key, Entry& out) const;
+    bool store(std::uint64_t key, int score_cp, std::uint16_t move16, int depth, Flag flag);
+
+    int hashfull() const;               // Permille of the table used by the current search (UCI "hashfull")
+    std::size_t size_mb() const { return size_in_mb; }
+    std::size_t capacity() const { return n_buckets * ENTRIES_PER_BUCKET; }
+
+    // Moves are kept as from (6 bits) | to (6 bits) | promotion (3 bits). Zero means no move.
+    static std::uint16_t pack_move(const ShumiChess::Move& m) {
+        if (m.fromSQ >= 64 || m.toSQ >= 64) return 0;
+        return (std::uint16_t)(m.fromSQ | (m.toSQ << 6) | ((unsigned)m.promotion << 12));
+    }
+    // Only fromSQ, toSQ and promotion come back, which is all that Move::operator== compares.
+    static ShumiChess::Move unpack_move(std::uint16_t move16) {
+        ShumiChess::Move m = {};
+        if (move16 == 0) return m;
+        m.fromSQ = (Square)(move16 & 0x3F);
+        m.toSQ = (Square)((move16 >> 6) & 0x3F);
+        m.promotion = (ShumiChess::Piece)((move16 >> 12) & 0x7);
+        return m;
+    }
+
+private:
+
+    static constexpr unsigned AGE_MASK = 0x3F;
+    static constexpr std::uint64_t USED_BIT = (1ULL << 55);     // so a written entry is never all zero
+
+    struct Slot {
+        std::atomic<std::uint64_t> key;     // zobrist key ^ data
+        std::atomic<std::uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[ENTRIES_PER_BUCKET];
+    };
+    static_assert(sizeof(Bucket) == 64, "TT2 bucket must be one cache line");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "TT2 needs lock free 64 bit atomics");
+
+    std::unique_ptr<Bucket[]> buckets;
+    std::size_t n_buckets = 0;
+    std::uint64_t bucket_mask = 0;
+    std::size_t size_in_mb = 0;
+    unsigned generation = 0;
+
+    static std::uint64_t pack_data(int score_cp, std::uint16_t move16, int depth, Flag flag, unsigned age) {
+        return  (std::uint64_t)(std::uint32_t)score_cp
+             | ((std::uint64_t)move16 << 32)
+             | ((std::uint64_t)(depth & 0x7F) << 48)
+             | USED_BIT
+             | ((std::uint64_t)((unsigned)flag & 0x3) << 56)
+             | ((std::uint64_t)(age & AGE_MASK) << 58);
+    }
+    static int  data_score(std::uint64_t d)  { return (int)(std::int32_t)(std::uint32_t)(d & 0xFFFFFFFFULL); }
+    static std::uint16_t data_move(std::uint64_t d) { return (std::uint16_t)(d >> 32); }
+    static int  data_depth(std::uint64_t d)  { return (int)((d >> 48) & 0x7F); }
+    static Flag data_flag(std::uint64_t d)   { return (Flag)((d >> 56) & 0x3); }
+    static unsigned data_age(std::uint64_t d) { return (unsigned)(d >> 58) & AGE_MASK; }
+
+    // How many searches ago this entry was written
+    unsigned age_distance(std::uint64_t d) const { return (generation - data_age(d)) & AGE_MASK; }
+
+    const Bucket& bucket_for(std::uint64_t key) const { return buckets[key & bucket_mask]; }
+    Bucket& bucket_for(std::uint64_t key) { return buckets[key & bucket_mask]; }
+};
+
+
+inline bool TranspositionTable::probe(std::uint64_t key, Entry& out) const {
+
+    if (n_buckets == 0) return false;
+
+    const Bucket& bucket = bucket_for(key);
+    for (const Slot& slot : bucket.slots) {
+        const std::uint64_t d = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t k = slot.key.load(std::memory_order_relaxed);
+        if (((k ^ d) == key) && (d != 0ULL)) {      // a torn entry fails this
+            out.score_cp = data_score(d);
+            out.move16   = data_move(d);
+            out.depth    = data_depth(d);
+            out.flag     = data_flag(d);
+            out.age      = (std::uint8_t)data_age(d);
+            return true;
+        }
+    }
+    return false;
+}
+
+//
+// Returns true if the entry was written.
+// The choice of victim reads the bucket without a lock. If another thread changes it in between,
+// we just replace a less than ideal slot. The entry itself is always consistent (see top of file).
+inline bool TranspositionTable::store(std::uint64_t key, int score_cp, std::uint16_t move16, int depth, Flag flag) {
+
+    if (n_buckets == 0) return false;
+
+    assert(depth >= 0 && depth < 128);
+
+    Bucket& bucket = bucket_for(key);
+    Slot* victim = nullptr;
+    bool victim_empty = false;
+    int victim_value = 0;
+
+    for (Slot& slot : bucket.slots) {
+
+        const std::uint64_t d = slot.data.load(std::memory_order_relaxed);
+        const std::uint64_t k = slot.key.load(std::memory_order_relaxed);
+
+        if (d == 0ULL) {                    // empty slot. Use it, unless this position is further on.
+            if (!victim_empty) {
+                victim = &slot;
+                victim_empty = true;
+            }
+            continue;
+        }
+
+        if ((k ^ d) == key) {
+            // Same position: keep the more valuable (deeper) result from this search.
+            if ((depth < data_depth(d)) && (age_distance(d) == 0)) return false;
+            victim = &slot;
+            break;
+        }
+
+        // Prefer to replace shallow entries, and entries from older searches.
+        const int value = data_depth(d) - 8 * (int)age_distance(d);
+        if (!victim_empty && (victim == nullptr || value < victim_value)) {
+            victim = &slot;
+            victim_value = value;
+        }
+    }
+
+    assert(victim != nullptr);
+    const std::uint64_t data = pack_data(score_cp, move16, depth, flag, generation);
+    victim->key.store(key ^ data, std::memory_order_relaxed);
+    victim->data.store(data, std::memory_order_relaxed);
+    return true;
+}
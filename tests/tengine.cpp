@@ -1,12 +1,19 @@
 ﻿#include <gtest/gtest.h>
 
+#include <cstdio>
+#include <cstring>
+#include <random>
 #include <stack>
+#include <thread>
 
+#include "endgame.hpp"
+#include "endgameTables.hpp"
 #include "engine.hpp"
 #include "gameboard.hpp"
 #include "globals.hpp"
 #include "minimax.hpp"
 #include "test_helper_fcns.hpp"
+#include "tbprobe.h"
 
 TEST(Setup, WhiteGoesFirst) {
     ShumiChess::Engine test_engine;
@@ -225,6 +232,328 @@ TEST(EngineMoveStorage, EngineZobristConsistancy) {
     EXPECT_EQ(starting_zobrist, ending_zobrist);
 }
 
+//
+// Each test walks the positions reached from every perft FEN, checking what the push and pop keep incrementally.
+class PositionWalk : public testing::TestWithParam<const char*> {};
+
+INSTANTIATE_TEST_SUITE_P(PositionWalk, PositionWalk, testing::ValuesIn(perft_fens));
+
+// The kept material and piece-square values, against a from scratch count
+TEST_P(PositionWalk, MaterialAndPsqFollowPushPop) {
+    ShumiChess::Engine test_engine(GetParam());
+    ASSERT_TRUE(test_engine.game_board.material_and_psq_are_valid());
+    walk_all_moves(test_engine, 3, [](ShumiChess::Engine& e) {
+        ASSERT_TRUE(e.game_board.material_and_psq_are_valid()) << e.game_board.to_fen();
+    });
+}
+
+//
+// A network of random weights, in the Stockfish 12 file layout. Enough to check the arithmetic.
+static std::string write_random_nnue() {
+    using namespace ShumiChess::nnue;
+    const std::string path = testing::TempDir() + "shumi_random.nnue";
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (fp == NULL) return "";
+
+    std::mt19937 rng(12345);
+    auto put = [fp, &rng](int n, int bytes, int lo, int hi) {     // little endian, as the loader reads it
+        std::uniform_int_distribution<int> dist(lo, hi);
+        for (int i = 0; i < n; i++) {
+            const int32_t v = dist(rng);
+            fwrite(&v, bytes, 1, fp);
+        }
+    };
+    const uint32_t header[3] = {FILE_VERSION, 0, 0};    // version, hash, no description
+    const uint32_t hash = 0;
+    fwrite(header, 4, 3, fp);
+    fwrite(&hash, 4, 1, fp);
+    put(HALF_DIMS, 2, 0, 64);
+    put(N_FEATURES * HALF_DIMS, 2, -16, 16);
+    fwrite(&hash, 4, 1, fp);
+    put(32, 4, -2000, 2000);
+    put(32 * L1_INPUTS, 1, -64, 64);
+    put(32, 4, -500, 500);
+    put(32 * L2_INPUTS, 1, -64, 64);
+    put(1, 4, -100, 100);
+    put(L3_INPUTS, 1, -127, 127);
+    fclose(fp);
+    return path;
+}
+
+//
+// The incrementally kept accumulator must equal a scalar refresh from the board, and every kernel set must
+// give the same output.
+TEST_P(PositionWalk, NnueIncrementalMatchesRefreshOnEveryKernel) {
+    using namespace ShumiChess;
+    const std::string path = write_random_nnue();
+    ASSERT_TRUE(nnue::load(path));
+
+    Engine test_engine(GetParam());
+    walk_all_moves(test_engine, 2, [](Engine& e) {
+        const nnue::SimdLevel best = nnue::best_simd_level();
+        const int cp = e.nnue_evaluate();
+        const nnue::Accumulator& acc = e.nnue_stack[e.move_history_size()];
+
+        nnue::set_simd_level(nnue::SCALAR);
+        nnue::Accumulator fresh;
+        nnue::refresh(e.game_board, WHITE, e.white_king_square, fresh.v[WHITE]);
+        nnue::refresh(e.game_board, BLACK, e.black_king_square, fresh.v[BLACK]);
+        ASSERT_EQ(memcmp(acc.v, fresh.v, sizeof(fresh.v)), 0) << e.game_board.to_fen();
+
+        for (int level = nnue::SCALAR; level <= best; level++) {
+            nnue::set_simd_level((nnue::SimdLevel)level);
+            ASSERT_EQ(nnue::output(acc, e.game_board.turn), cp) << e.game_board.to_fen();
+        }
+        nnue::set_simd_level(best);
+    });
+
+    // A null move changes no features, only whose half goes first
+    const Color us = test_engine.game_board.turn;
+    test_engine.nnue_evaluate();
+    const nnue::Accumulator before = test_engine.nnue_stack[0];
+    if (us == WHITE) test_engine.pushNullMove_t<WHITE>();
+    else             test_engine.pushNullMove_t<BLACK>();
+    EXPECT_EQ(test_engine.nnue_evaluate(), nnue::output(before, (us == WHITE) ? BLACK : WHITE));
+    EXPECT_EQ(memcmp(test_engine.nnue_stack[1].v, before.v, sizeof(before.v)), 0);
+    if (us == WHITE) test_engine.popNullMove_t<WHITE>();
+    else             test_engine.popNullMove_t<BLACK>();
+
+    nnue::unload();
+    std::remove(path.c_str());
+}
+
+TEST(Nnue, RejectsWrongFile) {
+    EXPECT_FALSE(ShumiChess::nnue::load("no_such_file.nnue"));
+    EXPECT_FALSE(ShumiChess::nnue::is_loaded());
+}
+
+//
+// An eval given a window may return early, but only on the side of the window the full eval is on, and a
+// window the full eval is inside must get the full eval back. The playouts reach the endgames, where a lazy
+// exit with too small a margin shows up.
+TEST_P(PositionWalk, LazyEvalExitsOnlyOnTheSideOfTheFullEval) {
+    using namespace ShumiChess;
+    Engine test_engine(GetParam());
+    MinimaxAI ai(test_engine);
+
+    const position_check check = [&ai](Engine& e) {
+        auto eval = [&ai, &e](int alpha_cp, int beta_cp) {
+            return (e.game_board.turn == WHITE) ? ai.evaluate_board_t<WHITE>(UNCLE_SHUMI, alpha_cp, beta_cp)
+                                                : ai.evaluate_board_t<BLACK>(UNCLE_SHUMI, alpha_cp, beta_cp);
+        };
+        const int full_cp = eval(-MinimaxAI::EVAL_NO_WINDOW_CP, MinimaxAI::EVAL_NO_WINDOW_CP);
+        for (int d : {1, 50, 150, 400, 1000, 2500}) {
+            ASSERT_EQ(eval(full_cp - d, full_cp + d), full_cp) << e.game_board.to_fen();
+            ASSERT_LE(eval(full_cp + d, full_cp + d + 50), full_cp + d) << e.game_board.to_fen();
+            ASSERT_GE(eval(full_cp - d - 50, full_cp - d), full_cp - d) << e.game_board.to_fen();
+        }
+    };
+    walk_all_moves(test_engine, 2, check);
+    walk_playouts(test_engine, 20, 60, 20240, check);
+    EXPECT_GT(ai.evals_lazy_exits, 0u);
+}
+
+// Pyrrhic's squares are A1 = 0, ours H1 = 0. The attacks we hand it must be in its squares.
+TEST(Syzygy, AttacksInPyrrhicSquares) {
+    EXPECT_EQ(shumi_tb_knight_attacks(0), (1ULL << 10) | (1ULL << 17));                    // a1: c2, b3
+    EXPECT_EQ(shumi_tb_king_attacks(7), (1ULL << 6) | (1ULL << 14) | (1ULL << 15));         // h1: g1, g2, h2
+    EXPECT_EQ(shumi_tb_pawn_attacks(12, PYRRHIC_WHITE), (1ULL << 19) | (1ULL << 21));      // e2: d3, f3
+    EXPECT_EQ(shumi_tb_pawn_attacks(52, PYRRHIC_BLACK), (1ULL << 43) | (1ULL << 45));      // e7: d6, f6
+    EXPECT_EQ(shumi_tb_bishop_attacks(0, 0), 0x8040201008040200ULL);
+    EXPECT_EQ(shumi_tb_rook_attacks(0, 0), 0x01010101010101FEULL);
+    EXPECT_EQ(shumi_tb_rook_attacks(0, (1ULL << 2) | (1ULL << 16)), (1ULL << 1) | (1ULL << 2) | (1ULL << 8) | (1ULL << 16));
+}
+
+TEST(Syzygy, NoTablesNoProbes) {
+    EXPECT_FALSE(ShumiChess::syzygy::init("/nonexistent/syzygy"));
+    EXPECT_EQ(ShumiChess::syzygy::largest(), 0);
+
+    ShumiChess::Engine test_engine("8/8/8/4k3/8/8/3PK3/8 w - - 0 1");
+    EXPECT_FALSE(ShumiChess::syzygy::can_probe(test_engine.game_board));
+
+    MinimaxAI ai(test_engine);
+    ai.tb_filter_root_moves();
+    EXPECT_TRUE(ai.excluded_root_moves.empty());
+    EXPECT_EQ(ai.n_tb_hits, 0u);
+}
+
+TEST(Kpk, TextbookPositions) {
+    struct Case { const char* fen; int winner; };       // +1 White wins, -1 Black wins, 0 draw
+    for (const Case& t : {Case{"8/8/8/8/8/8/4P3/4K2k w - - 0 1", +1},       // outside the square
+                          Case{"4k3/8/4K3/4P3/8/8/8/8 w - - 0 1", +1},        // king on the 6th, in front
+                          Case{"8/4k3/8/4K3/4P3/8/8/8 w - - 0 1", 0},         // Black has the opposition
+                          Case{"8/4k3/8/4K3/4P3/8/8/8 b - - 0 1", +1},        // White has it
+                          Case{"4k3/4P3/4K3/8/8/8/8/8 b - - 0 1", 0},         // stalemate
+                          Case{"k7/8/8/8/8/8/P7/7K w - - 0 1", 0},            // rook pawn, king in the corner
+                          Case{"4k2K/4p3/8/8/8/8/8/8 b - - 0 1", -1}}) {      // Black has the pawn
+        ShumiChess::Engine test_engine(t.fen);
+        MinimaxAI ai(test_engine);
+        const ShumiChess::MaterialInfo& mi = ai.get_material_info_for_position();
+        ASSERT_TRUE(mi.endgame_is_exact) << t.fen;
+        const int cp = ai.evaluate_board_t<ShumiChess::WHITE>(ShumiChess::UNCLE_SHUMI);
+        EXPECT_EQ((cp > 0) - (cp < 0), t.winner) << t.fen;
+    }
+
+    ShumiChess::Engine test_engine("8/8/8/8/8/8/3NP3/4K2k w - - 0 1");
+    MinimaxAI ai(test_engine);
+    EXPECT_EQ(ai.get_material_info_for_position().endgame, nullptr);
+}
+
+// The material key depends only on the piece counts. (MaterialAndPsqFollowPushPop checks make/unmake.)
+TEST(MaterialHash, KeyAndEntries) {
+    ShumiChess::Engine test_engine("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1");
+    ShumiChess::Engine moved("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1R1K b kq - 0 1");
+    EXPECT_EQ(moved.game_board.material_key, test_engine.game_board.material_key);
+    ShumiChess::Engine one_less("r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q2K1 w kq - 0 1");
+    EXPECT_NE(one_less.game_board.material_key, test_engine.game_board.material_key);
+
+    // KR vs KB is drawish, so the rook side is scaled down. KR vs K is not.
+    ShumiChess::Engine rook_bishop("8/8/3k4/8/3b4/8/3R4/3K4 w - - 0 1");
+    MinimaxAI ai(rook_bishop);
+    const ShumiChess::MaterialInfo& mi = ai.get_material_info_for_position();
+    EXPECT_EQ(mi.scale[ShumiChess::WHITE], 4);
+    EXPECT_EQ(mi.phase, MinimaxAI::material_phase(415, true));
+    const int cp = ai.evaluate_board_t<ShumiChess::WHITE>(ShumiChess::UNCLE_SHUMI);
+    EXPECT_GT(cp, 0);
+    EXPECT_LT(cp, 100);
+
+    ShumiChess::Engine rook("8/8/3k4/8/8/8/3R4/3K4 w - - 0 1");
+    MinimaxAI ai2(rook);
+    EXPECT_EQ(ai2.get_material_info_for_position().scale[ShumiChess::WHITE], ShumiChess::MaterialInfo::SCALE_NORMAL);
+}
+
+TEST(Endgame, RegistryBySignature) {
+    using namespace ShumiChess;
+    endgame::init();
+
+    struct Case { const char* fen; const char* signature; Color strong; };
+    for (const Case& t : {Case{"8/8/8/4k3/8/8/8/3QK3 w - - 0 1", "KQK", WHITE},
+                          Case{"8/8/8/4k3/8/8/8/3rK3 b - - 0 1", "KRK", BLACK},
+                          Case{"8/8/8/4k3/8/8/8/2BNK3 w - - 0 1", "KBNK", WHITE},
+                          Case{"8/8/8/4k3/3p4/8/8/3RK3 w - - 0 1", "KRKP", WHITE}}) {
+        Engine test_engine(t.fen);
+        EXPECT_EQ(endgame::material_key_of(t.signature, t.strong), test_engine.game_board.material_key) << t.fen;
+        const endgame::Entry* e = endgame::find(test_engine.game_board.material_key);
+        ASSERT_NE(e, nullptr) << t.fen;
+        EXPECT_EQ(e->strong_side, t.strong) << t.fen;
+    }
+
+    Engine test_engine("8/8/8/4k3/8/8/8/3QKQ2 w - - 0 1");
+    EXPECT_EQ(endgame::find(test_engine.game_board.material_key), nullptr);
+}
+
+// The evaluators say the right things about the position, not just the material.
+TEST(Endgame, EvaluatorsDriveTheKing) {
+    using namespace ShumiChess;
+
+    auto eval_white = [](const char* fen) {
+        Engine test_engine(fen);
+        MinimaxAI ai(test_engine);
+        return ai.evaluate_board_t<WHITE>(UNCLE_SHUMI);
+    };
+
+    // KQK: a known win, better with the black king on the edge
+    EXPECT_GT(eval_white("8/8/8/4k3/8/8/8/3QK3 w - - 0 1"), endgame::KNOWN_WIN_CP);
+    EXPECT_GT(eval_white("4k3/8/4K3/8/8/8/8/3Q4 w - - 0 1"), eval_white("8/8/8/4k3/8/8/8/3QK3 w - - 0 1"));
+
+    // KBNK: a light squared bishop (f1) mates in h1 or a8, not a1 or h8
+    EXPECT_GT(eval_white("k7/8/2K5/8/8/8/8/5BN1 w - - 0 1"), eval_white("7k/8/5K2/8/8/8/8/5BN1 w - - 0 1"));
+
+    // KRKP: the rook wins with its king in front of the pawn, not against a pawn on the 2nd with its king
+    EXPECT_GT(eval_white("8/8/8/8/3k4/8/3p4/3K1R2 w - - 0 1"), 400);
+    EXPECT_LT(eval_white("8/K7/8/8/8/8/2kp4/7R w - - 0 1"), 200);
+}
+
+// A ponder search ignores its budget and depth until the ponder hit, then stops on the clock.
+// A stop without the hit (a ponder miss) still gives a move.
+TEST(Ponder, SearchesUntilThePonderHitOrStop) {
+    using namespace ShumiChess;
+    using namespace std::chrono;
+
+    for (const bool is_hit : {true, false}) {
+        Engine test_engine("r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+        MinimaxAI ai(test_engine);
+
+        std::atomic<bool> done{false};
+        Move move = {};
+        ai.ponder_start();
+        const auto thread_start = steady_clock::now();      // The search starts a little later
+        std::thread search([&] {
+            move = ai.get_move_iterative_deepening(20, 2, UNCLE_SHUMI, 0, _DEFAULT_FEATURES_MASK);
+            done = true;
+        });
+
+        std::this_thread::sleep_for(milliseconds(300));
+        EXPECT_FALSE(done);
+
+        if (is_hit) {
+            ai.ponder_hit();
+        } else {
+            ai.pondering = false;
+            ai.stop_calculation = true;
+        }
+        const ull since_thread_start_ms = (ull)duration_cast<milliseconds>(steady_clock::now() - thread_start).count();
+        search.join();
+
+        EXPECT_NE(move.piece_type, Piece::NONE);
+        EXPECT_GT(ai.max_attained_depth, 2);
+        EXPECT_EQ(ai.ponder_was_hit(), is_hit);
+        if (is_hit) {
+            EXPECT_GE(ai.ponder_free_ms(), 250u);
+            EXPECT_LE(ai.ponder_free_ms(), since_thread_start_ms + 2);     // Both round to the millisecond
+        } else {
+            EXPECT_EQ(ai.ponder_free_ms(), 0u);
+        }
+    }
+}
+
+// A ponder search that ends by itself (here a mate in one) still counts as hit, for only the time it searched.
+TEST(Ponder, EndsBeforeThePonderHit) {
+    using namespace ShumiChess;
+
+    Engine test_engine("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+    MinimaxAI ai(test_engine);
+
+    ai.ponder_start();
+    Move move = {};
+    std::thread search([&] { move = ai.get_move_iterative_deepening(20, 2, UNCLE_SHUMI, 0, _DEFAULT_FEATURES_MASK); });
+    search.join();
+    EXPECT_TRUE(ai.pondering);          // The UCI holds the move until the hit
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    ai.ponder_hit();
+
+    EXPECT_EQ(utility::representation::move_to_string(move), "a1a8");
+    EXPECT_TRUE(ai.ponder_was_hit());
+    EXPECT_LT(ai.ponder_free_ms(), 250u);
+}
+
+TEST(EngineMoveStorage, NullMoveOnTheUndoStack) {
+    using namespace ShumiChess;
+    Engine test_engine;
+    EXPECT_EQ(test_engine.last_move(), nullptr);
+
+    Move e4 = MoveSet(WHITE, PAWN, 1ULL <<11, 1ULL <<27);
+    e4.en_passant_landingSQ = 19;
+    test_pushMove(test_engine, e4);
+    const GameBoard after_e4 = test_engine.game_board;
+
+    // The pass clears the en passant square. last_move() skips it.
+    test_engine.pushNullMove_t<BLACK>();
+    EXPECT_EQ(test_engine.game_board.en_passant_landing_bb, 0ULL);
+    EXPECT_EQ(test_engine.move_history_size(), 2);
+    ASSERT_NE(test_engine.last_move(), nullptr);
+    EXPECT_EQ(test_engine.last_move()->toSQ, e4.toSQ);
+    EXPECT_EQ(test_engine.move_history_to_vector().size(), 1u);
+
+    test_engine.popNullMove_t<BLACK>();
+    EXPECT_EQ(after_e4, test_engine.game_board);
+    EXPECT_EQ(after_e4.zobrist_key, test_engine.game_board.zobrist_key);
+
+    test_popMove(test_engine);
+    EXPECT_EQ(test_engine.move_history_size(), 0);
+}
+
 //TODO use a different game to test pop (this one is same game as pushMove), more variety
 //? ^ Test different castling rook
 //? Maybe just more mini tests
@@ -342,3 +671,165 @@ TEST(EngineMoveStorage, PoppingMoves) {
         expected_game_history.pop();
     }
 }
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Single move checks (is_pseudo_legal, complete_move, is_legal_move_fast) against the generators.
+// The "foreign" moves are the same side's moves from two plies up, like killers and hash moves.
+//
+
+namespace {
+
+using ShumiChess::Move;
+using ShumiChess::Color;
+using ShumiChess::MoveList;
+
+bool same_fields(const Move& a, const Move& b) {
+    return (a.fromSQ == b.fromSQ) && (a.toSQ == b.toSQ) && (a.color == b.color)
+        && (a.piece_type == b.piece_type) && (a.capture == b.capture) && (a.promotion == b.promotion)
+        && (a.flags == b.flags) && (a.en_passant_landingSQ == b.en_passant_landingSQ);
+}
+
+bool contains_exactly(const MoveList& moves, const Move& m) {
+    for (const Move& x : moves) if (same_fields(x, m)) return true;
+    return false;
+}
+
+template<Color c>
+void check_single_move_fcns(ShumiChess::Engine& engine, const MoveList& foreign, int depth) {
+
+    constexpr Color enemy = (c == Color::WHITE) ? Color::BLACK : Color::WHITE;
+
+    MoveList psuedo;
+    engine.get_psuedo_legal_moves_t<c, false>(psuedo);
+
+    MoveList legal, caps, quiets;
+    engine.get_legal_moves_fast_t<c, false>(false, legal);
+    engine.get_legal_moves_fast_t<c, true>(false, caps);
+    engine.get_legal_moves_fast_t<c, false, true>(false, quiets);
+
+    // Unquiet plus quiet is all of them
+    EXPECT_EQ(caps.size() + quiets.size(), legal.size());
+    for (const Move& m : caps)   EXPECT_TRUE(contains_exactly(legal, m));
+    for (const Move& m : quiets) EXPECT_TRUE(contains_exactly(legal, m));
+
+    for (const Move& m : psuedo) {
+        EXPECT_TRUE(engine.is_pseudo_legal(m));
+        EXPECT_TRUE(same_fields(engine.complete_move(m.fromSQ, m.toSQ, m.promotion), m))
+            << engine.game_board.to_fen() << " " << (int)m.fromSQ << "-" << (int)m.toSQ;
+    }
+
+    // The gives-check test answers plain moves without making them
+    for (const Move& m : legal) {
+        const bool gives_check = engine.in_check_after_move_fast_t<c, false>(m);
+        engine.pushMove_t<c>(m);
+        EXPECT_EQ(gives_check, engine.is_king_in_check_t<enemy>())
+            << engine.game_board.to_fen() << " " << (int)m.fromSQ << "-" << (int)m.toSQ;
+        engine.popMove_t<c>();
+    }
+
+    for (const Move& m : foreign) {
+        EXPECT_EQ(engine.is_pseudo_legal(m), contains_exactly(psuedo, m))
+            << engine.game_board.to_fen() << " " << (int)m.fromSQ << "-" << (int)m.toSQ;
+        EXPECT_EQ(engine.is_legal_move_fast(m), contains_exactly(legal, m))
+            << engine.game_board.to_fen() << " " << (int)m.fromSQ << "-" << (int)m.toSQ;
+    }
+
+    if (depth == 0) return;
+
+    for (const Move& m : legal) {
+        engine.pushMove_t<c>(m);
+
+        MoveList replies;
+        engine.get_legal_moves_fast_t<enemy, false>(false, replies);
+        for (const Move& r : replies) {
+            engine.pushMove_t<enemy>(r);
+            check_single_move_fcns<c>(engine, legal, depth - 1);
+            engine.popMove_t<enemy>();
+        }
+
+        engine.popMove_t<c>();
+    }
+}
+
+}   // namespace
+
+class SingleMoveChecks : public testing::TestWithParam<string> {};
+
+TEST_P(SingleMoveChecks, MatchTheGenerators) {
+    ShumiChess::Engine test_engine(GetParam());
+    if (test_engine.game_board.turn == Color::WHITE) check_single_move_fcns<Color::WHITE>(test_engine, MoveList{}, 1);
+    else                                             check_single_move_fcns<Color::BLACK>(test_engine, MoveList{}, 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(SingleMoveChecks, SingleMoveChecks, testing::Values(
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R b KQkq - 0 1"));
+
+
+typedef tuple<string, string, int> see_test_type;
+class SeeCaptures : public testing::TestWithParam<see_test_type> {};
+
+TEST_P(SeeCaptures, SeeAndSeeGeAgree) {
+    ShumiChess::Engine test_engine(get<0>(GetParam()));
+    const int expected = get<2>(GetParam());
+
+    vector<ShumiChess::Move> moves;
+    test_engine.get_legal_moves_fast(test_engine.game_board.turn, false, false, moves);
+    for (const ShumiChess::Move& m : moves) {
+        if (utility::representation::move_to_string(m) != get<1>(GetParam())) continue;
+        EXPECT_EQ(test_engine.game_board.see(m), expected);
+        EXPECT_TRUE(test_engine.game_board.see_ge(m, expected));
+        EXPECT_FALSE(test_engine.game_board.see_ge(m, expected + 1));
+        return;
+    }
+    FAIL() << "no move " << get<1>(GetParam());
+}
+
+INSTANTIATE_TEST_SUITE_P(SeeCaptures, SeeCaptures, testing::Values(
+        make_tuple("1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", 100),                 // undefended
+        make_tuple("rn1qkb1r/1pp1pp1p/3p3n/p4bp1/P3PP2/R2P4/1PP3PP/1NBQKBNR w Kkq - 0 6", "e4f5", 230),
+        make_tuple("1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", -220),      // x-rays both sides
+        make_tuple("rnb1kb1r/pppp1ppp/4pq2/8/2B1n3/PPP5/3P1PPP/RNBQK1NR b KQkq - 0 5", "e4f2", 100), // king can't retake
+        make_tuple("4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", "e5d6", 0)));                              // en passant
+
+
+TEST(MoveList, InsertAndEraseMoveTheScores) {
+    using ShumiChess::Move;
+
+    ShumiChess::MoveList moves;
+    EXPECT_TRUE(moves.empty());
+
+    Move a, b, c;
+    a.fromSQ = 1;
+    b.fromSQ = 2;
+    c.fromSQ = 3;
+
+    moves.insert(moves.end(), a, 10);
+    moves.insert(moves.end(), c, 30);
+    moves.insert(moves.begin() + 1, b, 20);     // a b c
+
+    ASSERT_EQ(moves.size(), 3u);
+    EXPECT_EQ(moves[1].fromSQ, 2);
+    EXPECT_EQ(moves.score(0), 10);
+    EXPECT_EQ(moves.score(1), 20);
+    EXPECT_EQ(moves.score(2), 30);
+
+    moves.erase(moves.begin());                 // b c
+    ASSERT_EQ(moves.size(), 2u);
+    EXPECT_EQ(moves[0].fromSQ, 2);
+    EXPECT_EQ(moves.score(0), 20);
+    EXPECT_EQ(moves.score(1), 30);
+
+    const std::vector<Move> v = moves.to_vector();
+    ASSERT_EQ(v.size(), 2u);
+    EXPECT_EQ(v[1].fromSQ, 3);
+
+    moves.clear();
+    EXPECT_TRUE(moves.empty());
+}
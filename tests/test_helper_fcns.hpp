@@ -1,5 +1,9 @@
 ﻿#include <gtest/gtest.h>
 
+#include <functional>
+#include <random>
+#include <vector>
+
 #include "engine.hpp"
 #include "gameboard.hpp"
 #include "globals.hpp"
@@ -14,6 +18,59 @@ inline void test_popMove(ShumiChess::Engine& e) {
     else                                               e.popMove_t<ShumiChess::Color::WHITE>();
 }
 
+// The standard perft positions (chessprogramming.org "Perft Results"), for the tests that walk positions
+inline const char* const perft_fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+using position_check = std::function<void(ShumiChess::Engine&)>;
+
+//
+// Every legal move to the given depth (castles, en passant, promotions with and without capture). The check
+// runs after each push, and again after each pop, on the position the pop restored.
+inline void walk_all_moves(ShumiChess::Engine& e, int depth, const position_check& check) {
+    std::vector<ShumiChess::Move> moves;
+    e.get_legal_moves_fast(e.game_board.turn, false, false, moves);
+    for (const ShumiChess::Move& m : moves) {
+        test_pushMove(e, m);
+        check(e);
+        if (!testing::Test::HasFatalFailure() && depth > 1) walk_all_moves(e, depth - 1, check);
+        test_popMove(e);
+        if (testing::Test::HasFatalFailure()) return;
+        check(e);
+        if (testing::Test::HasFatalFailure()) return;
+    }
+}
+
+//
+// Random games from the position, deeper than walk_all_moves() can go. The same checks, after each push
+// and after each pop on the way back.
+inline void walk_playouts(ShumiChess::Engine& e, int n_games, int max_plies, unsigned seed, const position_check& check) {
+    std::mt19937 rng(seed);
+    for (int game = 0; game < n_games; game++) {
+        int n_pushed = 0;
+        while (n_pushed < max_plies) {
+            std::vector<ShumiChess::Move> moves;
+            e.get_legal_moves_fast(e.game_board.turn, false, false, moves);
+            if (moves.empty()) break;
+            test_pushMove(e, moves[rng() % moves.size()]);
+            n_pushed++;
+            check(e);
+            if (testing::Test::HasFatalFailure()) break;
+        }
+        while (n_pushed-- > 0) {
+            test_popMove(e);
+            if (!testing::Test::HasFatalFailure()) check(e);
+        }
+        if (testing::Test::HasFatalFailure()) return;
+    }
+}
+
 namespace ShumiChess {
 bool operator==(const ShumiChess::GameBoard& a, const ShumiChess::GameBoard& b) {
     return (a.black_pawns == b.black_pawns &&
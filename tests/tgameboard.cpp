@@ -5,6 +5,7 @@
 #include <utility>
 
 #include "gameboard.hpp"
+#include "move_tables.hpp"
 
 using namespace std;
 
@@ -112,3 +113,41 @@ INSTANTIATE_TEST_SUITE_P(tGameboardToFenNotationParams,
                                             )
                                         )
                         );
+
+
+//
+// The attack maps against a square by square count: attacked, attacked twice, and the king zone total.
+template<ShumiChess::Color c>
+static void check_attack_info(ShumiChess::GameBoard& board, const ShumiChess::AttackInfo& info) {
+    using namespace ShumiChess;
+    constexpr Color e = (c == WHITE) ? BLACK : WHITE;
+    const ull king = (c == WHITE) ? board.white_king : board.black_king;
+
+    int zone_hits = 0;
+    for (int sq = 0; sq < 64; sq++) {
+        const ull bb = 1ULL << sq;
+        const int pawns = board.pawns_attacking_square_t<c>(sq);
+        const int pieces = board.sliders_and_knights_attacking_square2_t<c>(sq);
+        const int kings = (tables::movegen::king_attack_table[sq] & king) ? 1 : 0;
+        const int n = pawns + pieces + kings;
+
+        EXPECT_EQ((info.by_piece[c][PAWN] & bb) != 0, pawns > 0) << board.to_fen() << " " << sq;
+        EXPECT_EQ((info.all[c] & bb) != 0, n > 0) << board.to_fen() << " " << sq;
+        EXPECT_EQ((info.double_attacks[c] & bb) != 0, n > 1) << board.to_fen() << " " << sq;
+        if (info.king_zone[e] & bb) zone_hits += pawns + pieces;
+    }
+    EXPECT_EQ(info.king_zone_hits[c], zone_hits) << board.to_fen();
+}
+
+TEST(AttackInfo, MatchesSquareBySquareCounts) {
+    for (const char* fen : {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                            "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+                            "2r3k1/5ppp/8/3N4/2Q1n3/8/5PPP/3R2K1 b - - 0 1"}) {
+        ShumiChess::GameBoard board(fen);
+        ShumiChess::AttackInfo info;
+        board.build_attack_info(info);
+        check_attack_info<ShumiChess::WHITE>(board, info);
+        check_attack_info<ShumiChess::BLACK>(board, info);
+    }
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "perft.hpp"
+
+using namespace std;
+
+namespace {
+
+struct PerftCase {
+    string fen;
+    int depth;
+    uint64_t nodes;
+    bool hashed;        // The deep ones use the hash table (and two threads), to keep the suite fast
+};
+
+// The standard perft positions (chessprogramming.org "Perft Results")
+const PerftCase perft_cases[] = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",                  5,   4865609, false},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",      5, 193690690, true},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",                                 6,  11030083, false},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",          5,  15833292, false},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",                 5,  89941194, true},
+    {"r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 5, 164075551, true},
+};
+
+}
+
+class PerftPositions : public testing::TestWithParam<PerftCase> {};
+
+TEST_P(PerftPositions, KnownNodeCounts) {
+    const PerftCase& pc = GetParam();
+    ShumiChess::Engine engine(pc.fen);
+
+    if (pc.hashed) {
+        PerftHashTable hash;
+        hash.resize(64);
+        vector<ShumiChess::PerftDivideEntry> divide;
+        EXPECT_EQ(ShumiChess::perft_divide(engine, pc.depth, divide, 2, &hash), pc.nodes);
+    } else {
+        EXPECT_EQ(ShumiChess::perft(engine, pc.depth), pc.nodes);
+    }
+
+    // The engine is left as it was
+    ShumiChess::Engine fresh(pc.fen);
+    EXPECT_EQ(engine.game_board.to_fen(), fresh.game_board.to_fen());
+    EXPECT_EQ(engine.game_board.zobrist_key, fresh.game_board.zobrist_key);
+}
+
+INSTANTIATE_TEST_SUITE_P(PerftPositions, PerftPositions, testing::ValuesIn(perft_cases));
+
+
+TEST(Perft, DivideMatchesPerft) {
+    ShumiChess::Engine engine("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+
+    vector<ShumiChess::PerftDivideEntry> divide_1, divide_3;
+    const uint64_t nodes_1 = ShumiChess::perft_divide(engine, 3, divide_1, 1);
+    const uint64_t nodes_3 = ShumiChess::perft_divide(engine, 3, divide_3, 3);
+
+    EXPECT_EQ(nodes_1, 97862u);
+    EXPECT_EQ(nodes_3, nodes_1);
+    ASSERT_EQ(divide_1.size(), 48u);
+    ASSERT_EQ(divide_3.size(), divide_1.size());
+    for (size_t i = 0; i < divide_1.size(); i++) {
+        EXPECT_EQ(divide_3[i].nodes, divide_1[i].nodes);
+    }
+
+    EXPECT_EQ(ShumiChess::perft(engine, 0), 1u);
+    EXPECT_EQ(ShumiChess::perft(engine, 1), 48u);
+}
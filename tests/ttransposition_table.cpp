@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "transposition_table.hpp"
+
+using namespace std;
+
+namespace {
+
+// Everything stored for a key is a function of the key, so any hit can be checked.
+uint64_t mix(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+int expected_score(uint64_t key)          { return (int)(int32_t)(uint32_t)mix(key); }
+uint16_t expected_move(uint64_t key)      { return (uint16_t)((mix(key) >> 32) | 1); }
+int expected_depth(uint64_t key)          { return (int)((mix(key) >> 48) & 0x7F); }
+TranspositionTable::Flag expected_flag(uint64_t key) { return (TranspositionTable::Flag)((mix(key) >> 56) % 3); }
+
+}
+
+
+TEST(TranspositionTable, StoreThenProbe) {
+    TranspositionTable tt;
+    tt.resize(1);
+
+    const uint64_t key = 0x123456789ABCDEF0ULL;
+    TranspositionTable::Entry entry;
+    ASSERT_FALSE(tt.probe(key, entry));
+
+    ASSERT_TRUE(tt.store(key, -1'000'123, 0x1234, 9, TranspositionTable::Flag::LOWER_BOUND));
+    ASSERT_TRUE(tt.probe(key, entry));
+    EXPECT_EQ(entry.score_cp, -1'000'123);
+    EXPECT_EQ(entry.move16, 0x1234);
+    EXPECT_EQ(entry.depth, 9);
+    EXPECT_EQ(entry.flag, TranspositionTable::Flag::LOWER_BOUND);
+
+    // Same search: a shallower result does not replace a deeper one
+    EXPECT_FALSE(tt.store(key, 5, 0x0042, 3, TranspositionTable::Flag::EXACT));
+    ASSERT_TRUE(tt.probe(key, entry));
+    EXPECT_EQ(entry.depth, 9);
+
+    // Next search: it does
+    tt.new_search();
+    EXPECT_TRUE(tt.store(key, 5, 0x0042, 3, TranspositionTable::Flag::EXACT));
+    ASSERT_TRUE(tt.probe(key, entry));
+    EXPECT_EQ(entry.depth, 3);
+    EXPECT_EQ(entry.score_cp, 5);
+
+    tt.clear();
+    EXPECT_FALSE(tt.probe(key, entry));
+}
+
+TEST(TranspositionTable, PackMove) {
+    ShumiChess::Move m = {};
+    m.fromSQ = 12;
+    m.toSQ = 63;
+    m.promotion = ShumiChess::Piece::KNIGHT;
+    const ShumiChess::Move back = TranspositionTable::unpack_move(TranspositionTable::pack_move(m));
+    EXPECT_TRUE(back == m);
+
+    EXPECT_EQ(TranspositionTable::pack_move(ShumiChess::Move{}), 0);
+}
+
+//
+// Many threads store and probe keys that all land in a few buckets. Every hit must return
+// exactly what was stored for that key. A torn entry (key of one write, data of another) would not.
+TEST(TranspositionTable, ConcurrentStoreProbeNeverTorn) {
+    TranspositionTable tt;
+    tt.resize(1);
+
+    constexpr int N_THREADS = 8;
+    constexpr int N_OPS = 200'000;
+    constexpr uint64_t N_KEYS = 4096;
+
+    std::atomic<ull> n_bad{0};
+    std::atomic<ull> n_hits{0};
+
+    auto worker = [&](int id) {
+        uint64_t r = mix((uint64_t)id + 1);
+        for (int i = 0; i < N_OPS; i++) {
+            r = mix(r);
+            // Only the low 3 bits of the key vary in the bucket index, so just 8 buckets (32 slots)
+            // are fought over.
+            const uint64_t key = (mix(r % N_KEYS) & ~(uint64_t)0xFFFFF) | (r % 8);
+
+            if (r >> 63) {
+                tt.store(key, expected_score(key), expected_move(key), expected_depth(key), expected_flag(key));
+            } else {
+                TranspositionTable::Entry entry;
+                if (tt.probe(key, entry)) {
+                    n_hits++;
+                    if ((entry.score_cp != expected_score(key)) ||
+                        (entry.move16 != expected_move(key)) ||
+                        (entry.depth != expected_depth(key)) ||
+                        (entry.flag != expected_flag(key))) {
+                        n_bad++;
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < N_THREADS; i++) threads.emplace_back(worker, i);
+    for (std::thread& t : threads) t.join();
+
+    EXPECT_GT(n_hits.load(), 0ULL);
+    ASSERT_EQ(n_bad.load(), 0ULL);
+}
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "globals.hpp"
+#include "move_tables.hpp"
 #include "utility.hpp"
 
 using namespace std;
@@ -40,6 +41,44 @@ TEST(BitTests, LsbAndPop) {
     ASSERT_EQ(expected_board, test_board);
 }
 
+TEST(BitTests, PextAttacksMatchMagic) {
+    if (!tables::movegen::cpu_has_fast_pext()) GTEST_SKIP() << "no fast PEXT on this CPU";
+
+    const bool was_pext = tables::movegen::use_pext;
+    ull state = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < 500; i++) {
+        state ^= state >> 12; state ^= state << 25; state ^= state >> 27;
+        const ull occ = (state * 2685821657736338717ULL) & (state * 0x94D049BB133111EBULL);
+        for (int square = 0; square < 64; square++) {
+            tables::movegen::set_use_pext(false);
+            const ull straight = ShumiChess::get_straight_attacks_mbb(occ, square);
+            const ull diagonal = ShumiChess::get_diagonal_attacks_mbb(occ, square);
+            tables::movegen::set_use_pext(true);
+            ASSERT_EQ(ShumiChess::get_straight_attacks_mbb(occ, square), straight);
+            ASSERT_EQ(ShumiChess::get_diagonal_attacks_mbb(occ, square), diagonal);
+        }
+    }
+    tables::movegen::set_use_pext(was_pext);
+}
+
+TEST(BitTests, BetweenAndLineTables) {
+    auto bb = [](const string& acn) { return utility::representation::acn_to_bitboard_conversion(acn); };
+    auto sq = [&bb](const string& acn) { return utility::bit::bitboard_to_lowest_square_fast(bb(acn)); };
+
+    EXPECT_EQ(tables::movegen::between_bb[sq("a1")][sq("d4")], bb("b2") | bb("c3"));
+    EXPECT_EQ(tables::movegen::between_bb[sq("d4")][sq("a1")], bb("b2") | bb("c3"));
+    EXPECT_EQ(tables::movegen::between_bb[sq("e1")][sq("e2")], 0ULL);
+    EXPECT_EQ(tables::movegen::between_bb[sq("e1")][sq("f3")], 0ULL);
+
+    EXPECT_EQ(tables::movegen::line_bb[sq("e2")][sq("e5")], ShumiChess::col_masks[ShumiChess::COL_E]);
+    EXPECT_EQ(tables::movegen::line_bb[sq("c4")][sq("h4")], ShumiChess::row_masks[ShumiChess::ROW_4]);
+    EXPECT_EQ(tables::movegen::line_bb[sq("b1")][sq("c2")], bb("b1") | bb("c2") | bb("d3") | bb("e4") | bb("f5") | bb("g6") | bb("h7"));
+    EXPECT_EQ(tables::movegen::line_bb[sq("e1")][sq("f3")], 0ULL);
+
+    EXPECT_TRUE(tables::movegen::aligned(sq("a1"), sq("c3"), sq("h8")));
+    EXPECT_FALSE(tables::movegen::aligned(sq("a1"), sq("c3"), sq("h7")));
+}
+
 
 
 typedef pair<string, ull> acn_to_bitboard_test_type;